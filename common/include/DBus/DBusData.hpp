@@ -4,6 +4,7 @@
 #include <any>
 #include <array>
 #include <string>
+#include "Define.hpp"
 
 enum DBusDataType{
     DBUS_DATA_MESSAGE = 0,
@@ -42,6 +43,18 @@ enum DBusDataType{
     // Record
     DBUS_DATA_WAV_FILE_PATH,
     DBUS_DATA_WAV_FILE_DURATION_SEC,
+    DBUS_DATA_AUDIO_CODEC,      // "wav", "flac", "opus"
+    DBUS_DATA_AUDIO_BITRATE,    // bits per second
+    DBUS_DATA_PEAKS_THUMBNAIL,  // hex, (min, max) int8 pairs
+    DBUS_DATA_LEVEL_RMS_DBFS,
+    DBUS_DATA_LEVEL_PEAK_DBFS,
+    DBUS_DATA_LEVEL_WAVEFORM,   // hex, one byte (peak / 128) per point
+    DBUS_DATA_STOP_REASON,      // "user", "max_duration", "silence"
+    DBUS_DATA_RECORD_FILE_COUNT,    // > 1 when silence splitting cut the recording
+    DBUS_DATA_FILTER_JOB_ID,    // "0" in CANCEL_FILTER = every job
+    DBUS_DATA_FILTER_PROGRESS,  // percent, -1 while queued
+    DBUS_DATA_RECORD_SESSION_ID,    // capture session (microphone) of START/STOP/CANCEL_RECORD and their notis
+    DBUS_DATA_RECORD_CALL_AUDIO,    // "1" in START_RECORD: a call is active, record its far end with the microphone
 
 
     DBUS_DATA_MAX
@@ -82,6 +95,18 @@ struct DBusDataInfo {
 
         data[DBUS_DATA_WAV_FILE_PATH] = "";
         data[DBUS_DATA_WAV_FILE_DURATION_SEC] = "0";
+        data[DBUS_DATA_AUDIO_CODEC] = "wav";
+        data[DBUS_DATA_AUDIO_BITRATE] = "0";
+        data[DBUS_DATA_PEAKS_THUMBNAIL] = "";
+        data[DBUS_DATA_LEVEL_RMS_DBFS] = "-120.0";
+        data[DBUS_DATA_LEVEL_PEAK_DBFS] = "-120.0";
+        data[DBUS_DATA_LEVEL_WAVEFORM] = "";
+        data[DBUS_DATA_STOP_REASON] = "user";
+        data[DBUS_DATA_RECORD_FILE_COUNT] = "0";
+        data[DBUS_DATA_FILTER_JOB_ID] = "0";
+        data[DBUS_DATA_FILTER_PROGRESS] = "0";
+        data[DBUS_DATA_RECORD_SESSION_ID] = DEFAULT_RECORD_SESSION_ID;
+        data[DBUS_DATA_RECORD_CALL_AUDIO] = "0";
 
     }
 
@@ -0,0 +1,16 @@
+#ifndef DBUS_HEX_HPP_
+#define DBUS_HEX_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Byte arrays (waveforms, peak thumbnails) travel in DBusDataInfo as lowercase hex strings,
+// two characters per byte
+class DBusHex {
+    public:
+        static void appendByte(std::string &hex, uint8_t byte);
+        static std::vector<uint8_t> toBytes(const std::string &hex);
+};
+
+#endif // DBUS_HEX_HPP_
@@ -1,6 +1,9 @@
 #ifndef DEFINE_HPP_
 #define DEFINE_HPP_
 
+// recordmgr capture session used when a record command names none
+#define DEFAULT_RECORD_SESSION_ID "default"
+
 enum class DBusCommand {
     NONE = 0,
 
@@ -55,11 +58,14 @@ enum class DBusCommand {
     START_RECORD,
     STOP_RECORD,
     CANCEL_RECORD,
+    CANCEL_FILTER,
 
     START_RECORD_NOTI,
     STOP_RECORD_NOTI,
     CANCEL_RECORD_NOTI,
     FILTER_WAV_FILE_NOTI,
+    RECORD_LEVEL_NOTI,
+    FILTER_PROGRESS_NOTI,
 
     MAX
 };
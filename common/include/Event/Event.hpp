@@ -3,6 +3,10 @@
 
 #include <memory>
 #include <string>
+#include <optional>
+#include <vector>
+#include <cstdint>
+#include "Define.hpp"
 
 enum class EventTypeID;
 
@@ -145,16 +149,96 @@ class BluetoothDevicePasskeyPayload : public Payload {
 };
 
 // Record
+class RecordSessionPayload : public Payload {
+    public:
+        explicit RecordSessionPayload(const std::string &sessionId = DEFAULT_RECORD_SESSION_ID) : sessionId_(sessionId) {}
+
+        std::string getSessionId() const { return sessionId_; }
+
+    private:
+        std::string sessionId_;
+};
+
+class RecordStartPayload : public RecordSessionPayload {
+    public:
+        explicit RecordStartPayload(const std::string &sessionId, bool withCallAudio)
+            : RecordSessionPayload(sessionId), withCallAudio_(withCallAudio) {}
+
+        bool isWithCallAudio() const { return withCallAudio_; }
+
+    private:
+        bool withCallAudio_;
+};
+
+class RecordNotiPayload : public NotiPayload {
+    public:
+        explicit RecordNotiPayload(bool isSuccess, const std::string &msgInfo, const std::string &sessionId)
+            : NotiPayload(isSuccess, msgInfo), sessionId_(sessionId) {}
+
+        std::string getSessionId() const { return sessionId_; }
+
+    private:
+        std::string sessionId_;
+};
+
+class RecordStopPayload : public RecordNotiPayload {
+    public:
+        explicit RecordStopPayload(bool isSuccess, const std::string &msgInfo, const std::string &sessionId,
+                                   const std::string &reason, int durationSec, int fileCount)
+            : RecordNotiPayload(isSuccess, msgInfo, sessionId), reason_(reason), durationSec_(durationSec), fileCount_(fileCount) {}
+
+        std::string getReason() const { return reason_; }
+        int getDurationSec() const { return durationSec_; }     // after silence trimming
+        int getFileCount() const { return fileCount_; }
+
+    private:
+        std::string reason_;
+        int durationSec_;
+        int fileCount_;
+};
+
 class WavPayload : public Payload {
     public:
-        explicit WavPayload(const std::string &filePath, int durationSec = 0) : filePath_(filePath), durationSec_(durationSec) {}
+        explicit WavPayload(const std::string &filePath, int durationSec = 0, bool isFiltered = false,
+                            const std::string &codec = "wav", int bitrate = 0, std::vector<uint8_t> peaks = {},
+                            const std::string &sessionId = DEFAULT_RECORD_SESSION_ID)
+            : filePath_(filePath), durationSec_(durationSec), isFiltered_(isFiltered), codec_(codec), bitrate_(bitrate),
+              peaks_(std::move(peaks)), sessionId_(sessionId) {}
 
         std::string getFilePath() const { return filePath_; }
         int getDurationSec() const { return durationSec_; }
+        bool isFiltered() const { return isFiltered_; }     // filter already ran during capture
+        std::string getCodec() const { return codec_; }
+        int getBitrate() const { return bitrate_; }         // bits per second
+        const std::vector<uint8_t> &getPeaks() const { return peaks_; }    // waveform thumbnail, (min, max) int8 pairs
+        std::string getSessionId() const { return sessionId_; }     // capture session that recorded it
 
     private:
         std::string filePath_;
         int durationSec_;
+        bool isFiltered_;
+        std::string codec_;
+        int bitrate_;
+        std::vector<uint8_t> peaks_;
+        std::string sessionId_;
+};
+
+class RecordLevelPayload : public Payload {
+    public:
+        explicit RecordLevelPayload(const std::string &sessionId, float rmsDbfs, float peakDbfs, std::vector<uint8_t> waveform)
+            : sessionId_(sessionId), rmsDbfs_(rmsDbfs), peakDbfs_(peakDbfs), waveform_(std::move(waveform)) {}
+
+        std::string getSessionId() const { return sessionId_; }
+
+        float getRmsDbfs() const { return rmsDbfs_; }
+        float getPeakDbfs() const { return peakDbfs_; }
+        const std::vector<uint8_t> &getWaveform() const { return waveform_; }  // peak / 128 per point
+
+    private:
+        std::string sessionId_;
+        float rmsDbfs_;
+        float peakDbfs_;
+        std::vector<uint8_t> waveform_;
 };
 
 class RemoveRecordPayload : public Payload {
@@ -167,6 +251,86 @@ class RemoveRecordPayload : public Payload {
         int recordId_;
 };
 
+class RecordPeaksPayload : public Payload {
+    public:
+        explicit RecordPeaksPayload(int recordId, int points) : recordId_(recordId), points_(points) {}
+
+        int getRecordId() const { return recordId_; }
+        int getPoints() const { return points_; }   // resolution the client wants to draw
+
+    private:
+        int recordId_;
+        int points_;
+};
+
+class FilterJobPayload : public Payload {
+    public:
+        explicit FilterJobPayload(int jobId) : jobId_(jobId) {}
+
+        int getJobId() const { return jobId_; }    // 0 = every job
+
+    private:
+        int jobId_;
+};
+
+class FilterProgressPayload : public Payload {
+    public:
+        explicit FilterProgressPayload(int jobId, const std::string &filePath, int progress)
+            : jobId_(jobId), filePath_(filePath), progress_(progress) {}
+
+        int getJobId() const { return jobId_; }
+        std::string getFilePath() const { return filePath_; }
+        int getProgress() const { return progress_; }   // percent, -1 while queued
+
+    private:
+        int jobId_;
+        std::string filePath_;
+        int progress_;
+};
+
+class RecordInfoPayload : public Payload {
+    public:
+        explicit RecordInfoPayload(int recordId, std::optional<std::string> title, std::optional<std::string> tags)
+            : recordId_(recordId), title_(std::move(title)), tags_(std::move(tags)) {}
+
+        int getRecordId() const { return recordId_; }
+        const std::optional<std::string> &getTitle() const { return title_; }
+        const std::optional<std::string> &getTags() const { return tags_; }
+
+    private:
+        int recordId_;
+        std::optional<std::string> title_;      // nullopt = leave unchanged
+        std::optional<std::string> tags_;
+};
+
+// Database
+class PagePayload : public Payload {
+    public:
+        explicit PagePayload(int offset, int limit) : offset_(offset), limit_(limit) {}
+
+        int getOffset() const { return offset_; }
+        int getLimit() const { return limit_; }
+
+    private:
+        int offset_;
+        int limit_;
+};
+
+class SearchPayload : public Payload {
+    public:
+        explicit SearchPayload(const std::string &query, const std::string &scope, int limit)
+            : query_(query), scope_(scope), limit_(limit) {}
+
+        std::string getQuery() const { return query_; }
+        std::string getScope() const { return scope_; }     // "all" | "records" | "contacts"
+        int getLimit() const { return limit_; }
+
+    private:
+        std::string query_;
+        std::string scope_;
+        int limit_;
+};
+
 class Event {
     public:
         explicit Event() : eventTypeId_(static_cast<EventTypeID>(0)), payload_(nullptr) {}
@@ -4,11 +4,31 @@
 #include <thread>
 #include <atomic>
 #include <string>
+#include <cstddef>
+#include <sched.h>
+
+// Applied by the thread itself before threadFunction() runs. Failures (no
+// CAP_SYS_NICE / RLIMIT_RTPRIO / RLIMIT_MEMLOCK) are logged and the thread
+// keeps running with what it got.
+struct ThreadSchedParams {
+    int policy = SCHED_OTHER;       // SCHED_FIFO / SCHED_RR for real-time threads
+    int priority = 0;               // 1..99 for the real-time policies
+    int cpu = -1;                   // pin to this core, -1 = any
+    // Off by default. Once per process: mlockall(MCL_CURRENT | MCL_ONFAULT), which locks pages
+    // already touched and those faulted in later within current mappings (plain MCL_CURRENT
+    // where MCL_ONFAULT is missing). Mappings created afterwards are not locked
+    bool lockMemory = false;
+    size_t prefaultStackBytes = 0;  // touch this much stack up front so it never page-faults later
+};
 
 class ThreadBase {
     private:
         std::thread threadObj_;
         std::string threadName_;
+        ThreadSchedParams schedParams_;
+
+        void threadEntry();
+        void applySchedParams();
 
     protected:
         std::atomic<bool> runningFlag_;
@@ -22,6 +42,8 @@ class ThreadBase {
         bool isRunning() const {
             return runningFlag_;
         }
+        // Call before run()
+        void setSchedParams(const ThreadSchedParams &params) { schedParams_ = params; }
         void run();
         void join();
         virtual void stop();
@@ -0,0 +1,16 @@
+#include "DBusHex.hpp"
+
+void DBusHex::appendByte(std::string &hex, uint8_t byte) {
+    static const char DIGITS[] = "0123456789abcdef";
+    hex += DIGITS[byte >> 4];
+    hex += DIGITS[byte & 0x0F];
+}
+
+std::vector<uint8_t> DBusHex::toBytes(const std::string &hex) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(hex.size() / 2);
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
@@ -1,5 +1,42 @@
 #include "ThreadBase.hpp"
 #include "Logger.hpp"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <alloca.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+namespace {
+    // Only what is mapped now, and with MCL_ONFAULT only the pages already touched: other
+    // threads' stacks and heap that grows later stay pageable. The capture path relies on
+    // its buffers being allocated before the thread starts and on the stack prefault
+    void lockProcessMemory() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            int err = -1;
+#ifdef MCL_ONFAULT
+            err = mlockall(MCL_CURRENT | MCL_ONFAULT);
+#endif
+            if (err != 0) {
+                err = mlockall(MCL_CURRENT);
+            }
+            if (err != 0) {
+                CMN_LOG(WARN, "mlockall failed: %s (check LimitMEMLOCK)", strerror(errno));
+                return;
+            }
+            CMN_LOG(INFO, "Process memory locked");
+        });
+    }
+
+    // noinline: the stack it touches is released on return, but stays mapped and locked
+    __attribute__((noinline)) void prefaultStack(size_t bytes) {
+        volatile char *stack = static_cast<volatile char *>(alloca(bytes));
+        for (size_t i = 0; i < bytes; i += 4096) {
+            stack[i] = 0;
+        }
+    }
+}
 
 ThreadBase::ThreadBase(std::string threadName) : threadName_(threadName), runningFlag_(false) {
     CMN_LOG(INFO, "%s thread is created", threadName_.c_str());
@@ -13,7 +50,7 @@ void ThreadBase::run() {
     if (!runningFlag_) {
         runningFlag_ = true;
         try {
-            threadObj_ = std::thread(&ThreadBase::threadFunction, this);
+            threadObj_ = std::thread(&ThreadBase::threadEntry, this);
             CMN_LOG(INFO, "%s thread start SUCCESS", threadName_.c_str());
         } catch (const std::exception& e) {
             CMN_LOG(ERROR, "%s thread start FAILED: %s", threadName_.c_str(), e.what());
@@ -24,6 +61,46 @@ void ThreadBase::run() {
     }
 }
 
+void ThreadBase::threadEntry() {
+    applySchedParams();
+    threadFunction();
+}
+
+void ThreadBase::applySchedParams() {
+    const ThreadSchedParams &params = schedParams_;
+    if (params.lockMemory) {
+        lockProcessMemory();
+    }
+    if (params.prefaultStackBytes > 0) {
+        prefaultStack(params.prefaultStackBytes);
+    }
+
+    if (params.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(params.cpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0) {
+            CMN_LOG(WARN, "%s: cannot pin to CPU %d: %s", threadName_.c_str(), params.cpu, strerror(err));
+        } else {
+            CMN_LOG(INFO, "%s pinned to CPU %d", threadName_.c_str(), params.cpu);
+        }
+    }
+
+    if (params.policy != SCHED_OTHER) {
+        sched_param sp{};
+        sp.sched_priority = params.priority;
+        int err = pthread_setschedparam(pthread_self(), params.policy, &sp);
+        if (err != 0) {
+            CMN_LOG(WARN, "%s: cannot set real-time priority %d: %s (check LimitRTPRIO)", threadName_.c_str(),
+                    params.priority, strerror(err));
+        } else {
+            CMN_LOG(INFO, "%s running with %s priority %d", threadName_.c_str(),
+                    params.policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR", params.priority);
+        }
+    }
+}
+
 void ThreadBase::join() {
     if (threadObj_.joinable()) {
         threadObj_.join();
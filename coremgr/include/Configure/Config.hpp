@@ -2,6 +2,7 @@
 #define CONFIG_HPP_
 
 #include "IConfig.hpp"
+#include "Define.hpp"
 
 #define CONFIG_INSTANCE() Config::getInstance()
 
@@ -25,6 +26,22 @@ class Config : public IConfig{
 
         const std::string &getSQLiteDBFilePath() const { return SQLiteDBFilePath; }
         unsigned int getSQLiteDBWorkerThreads() const { return SQLiteDBWorkerThreads; }
+        int getDBPageDefaultLimit() const { return DB_PAGE_DEFAULT_LIMIT; }
+        int getDBPageMaxLimit() const { return DB_PAGE_MAX_LIMIT; }
+        int getSearchDefaultLimit() const { return SEARCH_DEFAULT_LIMIT; }
+        int getPeaksDefaultPoints() const { return PEAKS_DEFAULT_POINTS; }
+        unsigned int getDBReadDeadlineMs() const { return DB_READ_DEADLINE_MS; }
+        unsigned int getDBBackgroundMaxWaitMs() const { return DB_BACKGROUND_MAX_WAIT_MS; }
+        unsigned int getDBSlowWaitWarnMs() const { return DB_SLOW_WAIT_WARN_MS; }
+        unsigned int getDBMaintenanceFirstDelayMs() const { return DB_MAINTENANCE_FIRST_DELAY_MS; }
+        unsigned int getDBMaintenanceIntervalMs() const { return DB_MAINTENANCE_INTERVAL_MS; }
+        unsigned int getDBMaintenanceRetryMs() const { return DB_MAINTENANCE_RETRY_MS; }
+        int getDBVacuumPagesPerStep() const { return DB_VACUUM_PAGES_PER_STEP; }
+        int getDBVacuumMaxSteps() const { return DB_VACUUM_MAX_STEPS; }
+        unsigned int getDBFullAnalyzeEveryRuns() const { return DB_FULL_ANALYZE_EVERY_RUNS; }
+
+        bool isCallRecordEnabled() const { return CALL_RECORD_ENABLED; }
+        const std::string &getCallRecordSessionId() const { return CALL_RECORD_SESSION_ID; }
 
     private:
         Config() = default;
@@ -42,6 +59,28 @@ class Config : public IConfig{
 
         inline static const std::string SQLiteDBFilePath = "/var/local/coremanager/coremanager.db";
         inline static const unsigned int SQLiteDBWorkerThreads = 5; // Number of worker threads for DB operations
+        inline static const int DB_PAGE_DEFAULT_LIMIT = 50;         // Rows per page when the client does not ask
+        inline static const int DB_PAGE_MAX_LIMIT = 200;
+        inline static const int SEARCH_DEFAULT_LIMIT = 20;           // Hits per category for the "search" command
+        inline static const int PEAKS_DEFAULT_POINTS = 800;          // Waveform width for "get_record_peaks"
+        inline static const unsigned int DB_READ_DEADLINE_MS = 3000;        // UI reads queued longer than this are dropped
+        inline static const unsigned int DB_BACKGROUND_MAX_WAIT_MS = 10000; // Background task runs ahead of UI work after this
+        inline static const unsigned int DB_SLOW_WAIT_WARN_MS = 500;
+
+        // Maintenance runs only while idle (no recording, no call); when busy it retries later
+        inline static const unsigned int DB_MAINTENANCE_FIRST_DELAY_MS = 10 * 60 * 1000;
+        inline static const unsigned int DB_MAINTENANCE_INTERVAL_MS = 6 * 60 * 60 * 1000;
+        inline static const unsigned int DB_MAINTENANCE_RETRY_MS = 5 * 60 * 1000;
+        inline static const int DB_VACUUM_PAGES_PER_STEP = 256;     // 1 MiB with 4 KiB pages
+        inline static const int DB_VACUUM_MAX_STEPS = 64;
+        inline static const unsigned int DB_FULL_ANALYZE_EVERY_RUNS = 28;  // ~weekly, PRAGMA optimize otherwise
+
+        // Record every call on this session: START_RECORD when a call becomes active, STOP_RECORD
+        // when it ends. Skipped if the session is already busy; recordmgr mixes in the far end
+        // from the session's callDevice. Off by default: recording a call may need the other
+        // party's consent
+        inline static const bool CALL_RECORD_ENABLED = false;
+        inline static const std::string CALL_RECORD_SESSION_ID = DEFAULT_RECORD_SESSION_ID;
 };
 
 #endif // CONFIG_HPP_
\ No newline at end of file
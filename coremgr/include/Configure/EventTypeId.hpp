@@ -59,13 +59,26 @@ enum class EventTypeID {
     CANCEL_RECORD,
     REMOVE_RECORD,
     GET_ALL_RECORD,
+    UPDATE_RECORD,
+    GET_RECORD_PEAKS,
+    CANCEL_FILTER,
 
     START_RECORD_NOTI,
     STOP_RECORD_NOTI,
     CANCEL_RECORD_NOTI,
     FILTER_WAV_FILE_NOTI,
+    RECORD_LEVEL_NOTI,
+    FILTER_PROGRESS_NOTI,
     INSERT_WAV_FILE,
 
+    // Database
+    GET_CONTACTS,
+    GET_CALL_HISTORY,
+    SEARCH,
+    CONTACTS_SYNCED_NOTI,
+    CALL_HISTORY_SYNCED_NOTI,
+    DB_MAINTENANCE,
+
     MAX
 };
 
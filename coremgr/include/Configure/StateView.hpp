@@ -2,6 +2,10 @@
 #define STATE_VIEW_HPP_
 
 #include "Define.hpp"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #define STATE_VIEW_INSTANCE() StateView::getInstance()
 
@@ -40,8 +44,34 @@ class StateView {
         StateView(const StateView &) = delete;
         StateView &operator=(const StateView &) = delete;
 
+        // Record state of each recordmgr capture session, STOPPED when never seen.
+        // Read by the WebSocket thread too, hence the lock
+        static RecordState getRecordState(const std::string &sessionId) {
+            std::lock_guard<std::mutex> lock(recordStateMutex_);
+            auto it = recordStates_.find(sessionId);
+            return it != recordStates_.end() ? it->second : RecordState::STOPPED;
+        }
+        static void setRecordState(const std::string &sessionId, RecordState state) {
+            std::lock_guard<std::mutex> lock(recordStateMutex_);
+            recordStates_[sessionId] = state;
+        }
+        static std::vector<std::string> getRecordSessionsIn(RecordState state) {
+            std::lock_guard<std::mutex> lock(recordStateMutex_);
+            std::vector<std::string> ids;
+            for (const auto &entry : recordStates_) {
+                if (entry.second == state) ids.push_back(entry.first);
+            }
+            return ids;
+        }
+        static bool isRecordIdle() {
+            std::lock_guard<std::mutex> lock(recordStateMutex_);
+            for (const auto &entry : recordStates_) {
+                if (entry.second != RecordState::STOPPED) return false;
+            }
+            return true;
+        }
+
         // View Properties
-        inline static RecordState RECORD_STATE = RecordState::STOPPED;
         inline static int CURRENT_TEMPERATURE = 0;
         inline static ScanningBTDeviceState SCANNING_BTDEVICE_STATE = ScanningBTDeviceState::IDLE;
         inline static BluetoothPowerState BLUETOOTH_POWER_STATE = BluetoothPowerState::OFF;
@@ -50,6 +80,9 @@ class StateView {
     private:
         StateView() = default;
         ~StateView() = default;
+
+        inline static std::mutex recordStateMutex_;
+        inline static std::map<std::string, RecordState> recordStates_;
 };
 
 #endif // STATE_VIEW_HPP_
\ No newline at end of file
@@ -15,18 +15,26 @@ class RecordHandler {
         void setWebSocket(std::shared_ptr<WebSocket> ws){ webSocket_ = ws; };
         void setDBThreadPool(std::shared_ptr<DBThreadPool> dbThreadPool){ dbThreadPool_ = dbThreadPool; };
 
-        void startRecord();
-        void stopRecord();
-        void cancelRecord();
+        void startRecord(std::shared_ptr<Payload>);
+        void stopRecord(std::shared_ptr<Payload>);
+        void cancelRecord(std::shared_ptr<Payload>);
+        void cancelFilter(std::shared_ptr<Payload>);
+        // After every call state change: starts or stops the call recording to match CALL_STATE
+        void followCallState();
 
         void startRecordNOTI(std::shared_ptr<Payload>);
         void stopRecordNOTI(std::shared_ptr<Payload>);
         void cancelRecordNOTI(std::shared_ptr<Payload>);
         void filterWavFileNOTI(std::shared_ptr<Payload>);
+        void recordLevelNOTI(std::shared_ptr<Payload>);
+        void filterProgressNOTI(std::shared_ptr<Payload>);
     
     private:
         std::shared_ptr<WebSocket> webSocket_;
         std::shared_ptr<DBThreadPool> dbThreadPool_;
+
+        bool callHandled_ = false;      // the current call was recorded or skipped
+        bool callRecording_ = false;    // we started the recording and still own it
 };
 
 #endif // RECORD_HANDLER_HPP_
\ No newline at end of file
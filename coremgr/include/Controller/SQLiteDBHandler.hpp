@@ -3,6 +3,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include <future>
+#include "Schema.hpp"
 
 class WebSocket;
 class DBThreadPool;
@@ -20,10 +23,40 @@ class SQLiteDBHandler {
         void insertAudioRecord(std::shared_ptr<Payload>);
         void removeAudioRecord(std::shared_ptr<Payload>);
         void getAllAudioRecords();
+        void updateAudioRecord(std::shared_ptr<Payload>);
+        void getRecordPeaks(std::shared_ptr<Payload>);
+        void search(std::shared_ptr<Payload>);
+
+        // Contacts / call history: entries are buffered between PULL_START and PULL_END,
+        // then written in one transaction
+        void beginContactSync(std::shared_ptr<Payload>);
+        void bufferContact(std::shared_ptr<Payload>);
+        void commitContactSync(std::shared_ptr<Payload>);
+        void beginCallHistorySync(std::shared_ptr<Payload>);
+        void bufferCallHistory(std::shared_ptr<Payload>);
+        void commitCallHistorySync(std::shared_ptr<Payload>);
+        void contactsSyncedNOTI(std::shared_ptr<Payload>);
+        void callHistorySyncedNOTI(std::shared_ptr<Payload>);
+        void getContacts(std::shared_ptr<Payload>);
+        void getCallHistory(std::shared_ptr<Payload>);
+
+        // Periodic DB maintenance, driven by Timer (DB_MAINTENANCE event)
+        void scheduleMaintenance(unsigned int delayMs);
+        void runMaintenanceIfIdle();
 
     private:
         std::shared_ptr<WebSocket> webSocket_;
         std::shared_ptr<DBThreadPool> dbThreadPool_;
+
+        std::vector<Contact> pendingContacts_;
+        std::vector<CallHistoryEntry> pendingCallHistory_;
+        bool contactSyncActive_ = false;
+        bool callHistorySyncActive_ = false;
+        unsigned int maintenanceRuns_ = 0;
+
+        bool parsePage(std::shared_ptr<Payload> payload, int &offset, int &limit);
+        template <typename T>
+        bool waitForRead(std::future<T> &future, T &result);
 };
 
 
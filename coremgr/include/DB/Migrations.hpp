@@ -0,0 +1,19 @@
+#ifndef MIGRATIONS_HPP_
+#define MIGRATIONS_HPP_
+
+#include <string>
+#include <vector>
+
+// One schema step. The database's PRAGMA user_version records the last applied version,
+// so steps must only ever be appended (never edited or reordered once shipped).
+struct SchemaMigration {
+    int version;
+    std::string description;
+    std::string sql;
+    bool transactional = true;  // false for statements SQLite refuses inside a transaction (VACUUM);
+                                // such steps must be safe to re-run
+};
+
+const std::vector<SchemaMigration> &getSchemaMigrations();
+
+#endif // MIGRATIONS_HPP_
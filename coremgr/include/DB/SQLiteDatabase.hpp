@@ -5,8 +5,15 @@
 #include <sqlite3.h>
 #include <vector>
 #include <mutex> // Thêm header mutex
+#include <optional>
 #include "Schema.hpp"
 
+struct DBPageStats {
+    long long pageCount = 0;
+    long long freelistCount = 0;    // unused pages that incremental_vacuum can give back to the filesystem
+    long long pageSize = 0;
+};
+
 class SQLiteDatabase {
     public:
         explicit SQLiteDatabase(const std::string &dbFilePath);
@@ -15,13 +22,35 @@ class SQLiteDatabase {
         bool open();
         void close();
 
-        // Schema initialization
-        bool initializeSchema();
+        // Applies pending steps from Migrations.cpp, each in its own transaction
+        bool migrateSchema();
+        int getSchemaVersion();
 
         // QUERY operations
         AudioRecord insertAudioRecord(const AudioRecord &record);
         std::vector<AudioRecord> getAllRecords();
+        AudioRecord getAudioRecord(int recordId);     // id -1 when not found
         std::string removeAudioRecord(int recordId);
+        AudioRecord updateAudioRecordInfo(int recordId, const std::optional<std::string> &title,
+            const std::optional<std::string> &tags);
+
+        // Full-text search (FTS5, see migration 4)
+        SearchResult search(const std::string &query, bool includeRecords, bool includeContacts, int limit);
+
+        // Contacts / call history (mirrors of the phone's PBAP data)
+        bool syncContacts(const std::vector<Contact> &contacts, bool pruneMissing);
+        ContactPage getContacts(int offset, int limit);
+        bool upsertCallHistory(const std::vector<CallHistoryEntry> &entries);
+        CallHistoryPage getCallHistory(int offset, int limit);
+
+        static std::string normalizeNumber(const std::string &number);
+
+        // Maintenance primitives, each short so the background lane can interleave them with UI requests
+        DBPageStats getPageStats();
+        bool checkpointWal(int &walFrames, int &checkpointedFrames);
+        bool incrementalVacuum(int maxPages);
+        bool optimizeFullText();
+        bool analyze(bool full);
 
     private:
         std::string dbFilePath_;
@@ -30,6 +59,7 @@ class SQLiteDatabase {
 
         bool executeSQL(const std::string& sql);
         sqlite3_stmt* prepareStatement(const std::string& sql);
+        int countRows(const std::string& table);
 };
 
 #endif // SQLITE_DATABASE_HPP_
\ No newline at end of file
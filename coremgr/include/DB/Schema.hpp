@@ -2,13 +2,59 @@
 #define SCHEMA_HPP_
 
 #include <string>
+#include <vector>
+#include <cstdint>
 
 // Schema representation
 struct AudioRecord {
-    int id;
+    int id = -1;
     std::string filePath;
-    int durationSec;
-    // std::string createdAt;
+    int durationSec = 0;
+    std::string createdAt;          // UTC, "YYYY-MM-DD HH:MM:SS"
+    long long fileSizeBytes = 0;    // 0 for records inserted before the size was tracked
+    std::string title;              // defaults to the file name, editable from the UI
+    std::string tags;               // free text, space separated
+    std::string codec = "wav";      // "wav", "flac" or "opus"
+    int bitrate = 0;                // bits per second as reported by recordmanager, 0 if unknown
+    std::vector<uint8_t> peaks;     // waveform thumbnail, (min, max) int8 pairs; full pyramid in <file_path>.peaks
+};
+
+struct Contact {
+    int id;
+    std::string name;
+    std::string number;
+    std::string normalizedNumber;   // digits only (keeps a leading '+'), used as the unique key
+};
+
+struct CallHistoryEntry {
+    int id;
+    std::string name;
+    std::string number;
+    std::string normalizedNumber;
+    std::string type;       // "dialed" | "received" | "missed"
+    std::string callTime;   // StartTime as reported by oFono
+};
+
+// One page of a paged query, plus the total row count so the UI can size its list
+struct ContactPage {
+    std::vector<Contact> contacts;
+    int total;
+};
+
+struct CallHistoryPage {
+    std::vector<CallHistoryEntry> entries;
+    int total;
+};
+
+struct RecordMatch {
+    AudioRecord record;
+    std::string snippet;    // matched context, hits wrapped in [ ]
+};
+
+// Ranked full-text search hits, best first
+struct SearchResult {
+    std::vector<RecordMatch> records;
+    std::vector<Contact> contacts;
 };
 
-#endif // SCHEMA_HPP_
\ No newline at end of file
+#endif // SCHEMA_HPP_
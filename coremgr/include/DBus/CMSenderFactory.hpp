@@ -23,9 +23,6 @@ class CMSenderFactory : public ISenderFactory {
         DBusMessage* makeMsg_HangupCall(DBusCommand cmd);
         DBusMessage* makeMsg_AnswerCall(DBusCommand cmd);
         
-        DBusMessage* makeMsg_StartRecord(DBusCommand cmd);
-        DBusMessage* makeMsg_StopRecord(DBusCommand cmd);
-        DBusMessage* makeMsg_CancelRecord(DBusCommand cmd);
         
         DBusMessage* makeMsgNoti_PairBTDevice(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
         DBusMessage* makeMsgNoti_UnpairBTDevice(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
@@ -34,6 +31,10 @@ class CMSenderFactory : public ISenderFactory {
         DBusMessage* makeMsgNoti_RejectBTDeviceRequestConfirmation(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
         DBusMessage* makeMsgNoti_AcceptBTDeviceRequestConfirmation(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
         DBusMessage* makeMsgNoti_DialCall(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
+        DBusMessage* makeMsgNoti_StartRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
+        DBusMessage* makeMsgNoti_StopRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
+        DBusMessage* makeMsgNoti_CancelRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
+        DBusMessage* makeMsgNoti_CancelFilter(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
 };
 
 #endif // CM_SENDER_FACTORY_HPP_
\ No newline at end of file
@@ -4,10 +4,14 @@
 #include "ThreadBase.hpp"
 #include "Schema.hpp"
 #include <vector>
-#include <queue>
+#include <deque>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
 #include <functional>
 #include <future>
 #include <memory>
+#include <optional>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -15,26 +19,105 @@
 class EventQueue;
 class SQLiteDatabase;
 
+// INTERACTIVE: requests a UI client is waiting on. BACKGROUND: bulk syncs and maintenance,
+// run only when no interactive work is queued and by at most one worker at a time.
+enum class DBTaskLane {
+    INTERACTIVE = 0,
+    BACKGROUND,
+    MAX
+};
+
+struct DBLaneStats {
+    size_t depth = 0;           // currently queued
+    size_t maxDepth = 0;
+    uint64_t executed = 0;
+    uint64_t expired = 0;       // dropped because their deadline passed while queued
+    uint64_t totalWaitMs = 0;   // queue wait of executed tasks
+    uint64_t maxWaitMs = 0;
+};
+
+struct DBMaintenanceReport {
+    long long pagesBefore = 0;
+    long long pagesAfter = 0;
+    long long freelistBefore = 0;
+    long long freelistAfter = 0;
+    long long pageSize = 0;
+    int walFrames = 0;
+    int walCheckpointedFrames = 0;
+    int vacuumSteps = 0;
+    bool fullAnalyze = false;
+    uint64_t busyMs = 0;        // time spent holding the database (what UI requests could have waited on)
+    uint64_t elapsedMs = 0;     // wall time, including waits behind interactive work
+};
+
 class DBThreadPool : public ThreadBase {
 public:
     DBThreadPool(std::shared_ptr<EventQueue> eventQueue, int numWorkers);
     ~DBThreadPool();
 
     void stop() override;
-    void enqueueTask(std::function<void()> task);
 
-    std::future<AudioRecord> insertAudioRecord(const std::string& filePath, int durationSec);
+    // A task still queued when its deadline passes is dropped without running; the caller's future
+    // then throws std::future_error (broken_promise). deadline 0 = wait as long as it takes.
+    void enqueueTask(std::function<void()> task, DBTaskLane lane = DBTaskLane::INTERACTIVE,
+        std::chrono::milliseconds deadline = std::chrono::milliseconds(0));
+
+    DBLaneStats getLaneStats(DBTaskLane lane);
+
+    // Checkpoint, incremental vacuum, ANALYZE/optimize; queued as a chain of short background tasks
+    void runMaintenance(bool fullAnalyze);
+    DBMaintenanceReport getLastMaintenanceReport();
+
+    std::future<AudioRecord> insertAudioRecord(const AudioRecord& record);
     std::future<std::vector<AudioRecord>> getAllAudioRecords();
+    std::future<AudioRecord> getAudioRecord(int recordId);
     std::future<std::string> removeAudioRecord(int recordId);
+    std::future<AudioRecord> updateAudioRecordInfo(int recordId, std::optional<std::string> title, std::optional<std::string> tags);
+    std::future<SearchResult> search(const std::string& query, bool includeRecords, bool includeContacts, int limit);
+
+    std::future<bool> syncContacts(std::vector<Contact> contacts);
+    std::future<ContactPage> getContacts(int offset, int limit);
+    std::future<bool> upsertCallHistory(std::vector<CallHistoryEntry> entries);
+    std::future<CallHistoryPage> getCallHistory(int offset, int limit);
 
 protected:
+    // Opens the database and migrates the schema, then runs the workers until stop()
     void threadFunction() override;
 
 private:
+    struct QueuedTask {
+        std::function<void()> run;
+        std::chrono::steady_clock::time_point enqueuedAt;
+        std::chrono::steady_clock::time_point deadline;     // time_point::max() = none
+    };
+
+    enum class MaintenanceStage {
+        CHECKPOINT,
+        VACUUM,
+        ANALYZE
+    };
+
+    struct MaintenanceRun {
+        MaintenanceStage stage = MaintenanceStage::CHECKPOINT;
+        DBMaintenanceReport report;
+        std::chrono::steady_clock::time_point startedAt;
+    };
+
+    void workerLoop();
+    void maintenanceStep(std::shared_ptr<MaintenanceRun> run);
+    bool hasRunnableTask() const;
+    bool popRunnableTask(QueuedTask &task, DBTaskLane &lane);
+    void recordExecuted(DBTaskLane lane, uint64_t waitMs);
+
     std::shared_ptr<EventQueue> eventQueue_;
     std::shared_ptr<SQLiteDatabase> database_;
+    int numWorkers_;
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasksQueue_;
+    std::deque<QueuedTask> lanes_[static_cast<int>(DBTaskLane::MAX)];
+    DBLaneStats laneStats_[static_cast<int>(DBTaskLane::MAX)];
+    int activeBackgroundTasks_ = 0;
+    std::atomic<bool> maintenanceRunning_{false};
+    DBMaintenanceReport lastMaintenanceReport_;
     std::mutex taskMutex_;
     std::mutex dbMutex_;
     std::condition_variable cv_;
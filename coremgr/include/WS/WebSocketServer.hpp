@@ -18,8 +18,16 @@ public:
     explicit WebSocketSession(boost::asio::ip::tcp::socket socket, WebSocketServer& server);
     void start();
     void send(const std::string& message);
+    // Binary frame; dropped when this client already has a backlog (live data, only the latest matters)
+    void sendBinary(const std::string& frame);
 
 private:
+    struct OutMessage {
+        std::string data;
+        bool binary;
+    };
+
+    void enqueue(OutMessage message);
     void doAccept();
     void doRead();
     void doWrite();
@@ -28,7 +36,7 @@ private:
     boost::beast::flat_buffer buffer_;
     WebSocketServer& server_;
     std::mutex queue_mutex_;
-    std::queue<std::string> message_queue_;
+    std::queue<OutMessage> message_queue_;
     bool writing_ = false;
 };
 
@@ -47,6 +55,8 @@ public:
     
     void updateStateAndBroadcast(const std::string& status, const std::string& msgInfo, 
         const std::string& component, const std::string& msgData, const nlohmann::json& data);
+    // Compact binary frames for high-rate live data (see RecordHandler::recordLevelNOTI)
+    void broadcastBinary(const std::string& frame);
     void handleMessageFromSession(const std::string& message);
     
 private:
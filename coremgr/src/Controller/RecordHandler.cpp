@@ -7,20 +7,50 @@
 #include "WebSocket.hpp"
 #include "Event.hpp"
 #include "DBThreadPool.hpp"
+#include "Config.hpp"
 #include "json.hpp"     // nlohmann::json
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 
-void RecordHandler::startRecord(){
-    RecordState currentState = STATE_VIEW_INSTANCE()->RECORD_STATE;
+namespace {
+    std::string sessionIdOf(const std::shared_ptr<Payload> &payload) {
+        std::shared_ptr<RecordSessionPayload> sessionPayload = std::dynamic_pointer_cast<RecordSessionPayload>(payload);
+        return sessionPayload ? sessionPayload->getSessionId() : DEFAULT_RECORD_SESSION_ID;
+    }
+
+    // withCallAudio: only the call recording itself (CALL_RECORD_ENABLED) gets the far end
+    void sendRecordCommand(DBusCommand cmd, const std::string &sessionId, bool withCallAudio = false) {
+        STATE_VIEW_INSTANCE()->setRecordState(sessionId, RecordState::PROCESSING);
+        DBusDataInfo data;
+        data[DBUS_DATA_RECORD_SESSION_ID] = sessionId;
+        if (cmd == DBusCommand::START_RECORD && withCallAudio) {
+            data[DBUS_DATA_RECORD_CALL_AUDIO] = "1";
+        }
+        DBUS_SENDER()->sendMessageNoti(cmd, true, data);
+    }
+
+    // Every record noti names the session it is about
+    nlohmann::json sessionData(const std::shared_ptr<Payload> &payload) {
+        nlohmann::json data = nlohmann::json::object();
+        std::shared_ptr<RecordNotiPayload> recordPayload = std::dynamic_pointer_cast<RecordNotiPayload>(payload);
+        data["session_id"] = recordPayload ? recordPayload->getSessionId() : DEFAULT_RECORD_SESSION_ID;
+        return data;
+    }
+}
+
+void RecordHandler::startRecord(std::shared_ptr<Payload> payload){
+    const std::string sessionId = sessionIdOf(payload);
+    RecordState currentState = STATE_VIEW_INSTANCE()->getRecordState(sessionId);
     switch (currentState) {
         case RecordState::STOPPED:
-            STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::PROCESSING;
-            DBUS_SENDER()->sendMessage(DBusCommand::START_RECORD);
+            sendRecordCommand(DBusCommand::START_RECORD, sessionId);
             break;
         case RecordState::RECORDING:
-            R_LOG(WARN, "Received START_RECORD event while already RECORDING. No Action taken.");
+            R_LOG(WARN, "Received START_RECORD event while %s is already RECORDING. No Action taken.", sessionId.c_str());
             break;
         case RecordState::PROCESSING:
-            R_LOG(WARN, "Received START_RECORD event while PROCESSING. No Action taken.");
+            R_LOG(WARN, "Received START_RECORD event while %s is PROCESSING. No Action taken.", sessionId.c_str());
             break;
         default:
             R_LOG(WARN, "Received START_RECORD event in invalid state");
@@ -28,18 +58,18 @@ void RecordHandler::startRecord(){
     }
 }
 
-void RecordHandler::stopRecord(){
-    RecordState currentState = STATE_VIEW_INSTANCE()->RECORD_STATE;
+void RecordHandler::stopRecord(std::shared_ptr<Payload> payload){
+    const std::string sessionId = sessionIdOf(payload);
+    RecordState currentState = STATE_VIEW_INSTANCE()->getRecordState(sessionId);
     switch (currentState) {
         case RecordState::RECORDING:
-            STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::PROCESSING;
-            DBUS_SENDER()->sendMessage(DBusCommand::STOP_RECORD);
+            sendRecordCommand(DBusCommand::STOP_RECORD, sessionId);
             break;
         case RecordState::STOPPED:
-            R_LOG(WARN, "Received STOP_RECORD event while already STOPPED. No Action taken.");
+            R_LOG(WARN, "Received STOP_RECORD event while %s is already STOPPED. No Action taken.", sessionId.c_str());
             break;
         case RecordState::PROCESSING:
-            R_LOG(WARN, "Received STOP_RECORD event while PROCESSING. No Action taken.");
+            R_LOG(WARN, "Received STOP_RECORD event while %s is PROCESSING. No Action taken.", sessionId.c_str());
             break;
         default:
             R_LOG(WARN, "Received STOP_RECORD event in invalid state");
@@ -47,18 +77,18 @@ void RecordHandler::stopRecord(){
     }
 }
 
-void RecordHandler::cancelRecord(){
-    RecordState currentState = STATE_VIEW_INSTANCE()->RECORD_STATE;
+void RecordHandler::cancelRecord(std::shared_ptr<Payload> payload){
+    const std::string sessionId = sessionIdOf(payload);
+    RecordState currentState = STATE_VIEW_INSTANCE()->getRecordState(sessionId);
     switch (currentState) {
         case RecordState::RECORDING:
-            STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::PROCESSING;
-            DBUS_SENDER()->sendMessage(DBusCommand::CANCEL_RECORD);
+            sendRecordCommand(DBusCommand::CANCEL_RECORD, sessionId);
             break;
         case RecordState::STOPPED:
-            R_LOG(WARN, "Received CANCEL_RECORD event while already STOPPED. No Action taken.");
+            R_LOG(WARN, "Received CANCEL_RECORD event while %s is already STOPPED. No Action taken.", sessionId.c_str());
             break;
         case RecordState::PROCESSING:
-            R_LOG(WARN, "Received CANCEL_RECORD event while PROCESSING. No Action taken.");
+            R_LOG(WARN, "Received CANCEL_RECORD event while %s is PROCESSING. No Action taken.", sessionId.c_str());
             break;
         default:
             R_LOG(WARN, "Received CANCEL_RECORD event in invalid state");
@@ -66,6 +96,45 @@ void RecordHandler::cancelRecord(){
     }
 }
 
+void RecordHandler::cancelFilter(std::shared_ptr<Payload> payload){
+    std::shared_ptr<FilterJobPayload> jobPayload = std::dynamic_pointer_cast<FilterJobPayload>(payload);
+    if (jobPayload == nullptr) {
+        R_LOG(ERROR, "CANCEL_FILTER payload is not of type FilterJobPayload");
+        return;
+    }
+    // The recording is still stored, only without the filter pass
+    R_LOG(INFO, "Canceling filter job %d", jobPayload->getJobId());
+    DBusDataInfo data;
+    data[DBUS_DATA_FILTER_JOB_ID] = std::to_string(jobPayload->getJobId());
+    DBUS_SENDER()->sendMessageNoti(DBusCommand::CANCEL_FILTER, true, data);
+}
+
+void RecordHandler::followCallState(){
+    if (!CONFIG_INSTANCE()->isCallRecordEnabled()) {
+        return;
+    }
+    const std::string &sessionId = CONFIG_INSTANCE()->getCallRecordSessionId();
+    const bool inCall = STATE_VIEW_INSTANCE()->CALL_STATE == CallState::CALLING;
+
+    if (inCall && !callHandled_) {
+        callHandled_ = true;
+        if (STATE_VIEW_INSTANCE()->getRecordState(sessionId) != RecordState::STOPPED) {
+            R_LOG(INFO, "Call is active but session %s is busy, not recording the call", sessionId.c_str());
+            return;
+        }
+        R_LOG(INFO, "Call is active, recording it on session %s", sessionId.c_str());
+        callRecording_ = true;
+        sendRecordCommand(DBusCommand::START_RECORD, sessionId, true);
+    } else if (!inCall && callHandled_) {
+        callHandled_ = false;
+        if (callRecording_) {
+            callRecording_ = false;
+            R_LOG(INFO, "Call ended, stopping the call recording on session %s", sessionId.c_str());
+            sendRecordCommand(DBusCommand::STOP_RECORD, sessionId);
+        }
+    }
+}
+
 void RecordHandler::startRecordNOTI(std::shared_ptr<Payload> payload){
     std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
     if (notiPayload == nullptr) {
@@ -73,12 +142,17 @@ void RecordHandler::startRecordNOTI(std::shared_ptr<Payload> payload){
         return;
     }
 
+    nlohmann::json data = sessionData(payload);
+    const std::string sessionId = data["session_id"];
     if (notiPayload->isSuccess() == false) {
-        STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::STOPPED;
-        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "start_record_noti", {});
+        STATE_VIEW_INSTANCE()->setRecordState(sessionId, RecordState::STOPPED);
+        if (sessionId == CONFIG_INSTANCE()->getCallRecordSessionId()) {
+            callRecording_ = false;
+        }
+        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "start_record_noti", data);
     } else {
-        STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::RECORDING;
-        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "start_record_noti", {});
+        STATE_VIEW_INSTANCE()->setRecordState(sessionId, RecordState::RECORDING);
+        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "start_record_noti", data);
     }
 }
 
@@ -89,12 +163,26 @@ void RecordHandler::stopRecordNOTI(std::shared_ptr<Payload> payload){
         return;
     }
 
+    // Tells the UI whether the user, the length limit or the silence timeout ended the recording
+    nlohmann::json data = sessionData(payload);
+    const std::string sessionId = data["session_id"];
+    std::shared_ptr<RecordStopPayload> stopPayload = std::dynamic_pointer_cast<RecordStopPayload>(payload);
+    if (stopPayload != nullptr) {
+        data["reason"] = stopPayload->getReason();
+        data["duration_sec"] = stopPayload->getDurationSec();
+        data["file_count"] = stopPayload->getFileCount();
+    }
+    // Whatever ended it (user, length limit, silence), there is nothing left to stop when the call ends
+    if (sessionId == CONFIG_INSTANCE()->getCallRecordSessionId()) {
+        callRecording_ = false;
+    }
+
     if (notiPayload->isSuccess() == false) {
-        STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::STOPPED;
-        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "stop_record_noti", {});
+        STATE_VIEW_INSTANCE()->setRecordState(sessionId, RecordState::STOPPED);
+        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "stop_record_noti", data);
     } else {
-        STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::STOPPED;
-        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "stop_record_noti", {});
+        STATE_VIEW_INSTANCE()->setRecordState(sessionId, RecordState::STOPPED);
+        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "stop_record_noti", data);
     }
 }
 
@@ -105,12 +193,15 @@ void RecordHandler::cancelRecordNOTI(std::shared_ptr<Payload> payload){
         return;
     }
 
+    nlohmann::json data = sessionData(payload);
+    STATE_VIEW_INSTANCE()->setRecordState(data["session_id"], RecordState::STOPPED);
+    if (data["session_id"] == CONFIG_INSTANCE()->getCallRecordSessionId()) {
+        callRecording_ = false;
+    }
     if (notiPayload->isSuccess() == false) {
-        STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::STOPPED;
-        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "cancel_record_noti", {});
+        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "cancel_record_noti", data);
     } else {
-        STATE_VIEW_INSTANCE()->RECORD_STATE = RecordState::STOPPED;
-        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "cancel_record_noti", {});
+        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "cancel_record_noti", data);
     }
 }
 
@@ -121,11 +212,72 @@ void RecordHandler::filterWavFileNOTI(std::shared_ptr<Payload> payload){
         return;
     }
 
+    nlohmann::json data = sessionData(payload);
     if (notiPayload->isSuccess() == false) {
         R_LOG(ERROR, "Audio filtering failed: %s", notiPayload->getMsgInfo().c_str());
-        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "filter_wav_file_noti", {});
+        webSocket_->getServer()->updateStateAndBroadcast("fail", notiPayload->getMsgInfo(), "Record", "filter_wav_file_noti", data);
     } else {
         R_LOG(INFO, "Audio save succeeded: %s", notiPayload->getMsgInfo().c_str());
-        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "filter_wav_file_noti", {});
+        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Record", "filter_wav_file_noti", data);
     }
-}
\ No newline at end of file
+}
+void RecordHandler::recordLevelNOTI(std::shared_ptr<Payload> payload){
+    std::shared_ptr<RecordLevelPayload> levelPayload = std::dynamic_pointer_cast<RecordLevelPayload>(payload);
+    if (levelPayload == nullptr) {
+        R_LOG(ERROR, "RECORD_LEVEL_NOTI payload is not of type RecordLevelPayload");
+        return;
+    }
+    const std::string &sessionId = levelPayload->getSessionId();
+    if (STATE_VIEW_INSTANCE()->getRecordState(sessionId) != RecordState::RECORDING) {
+        return;     // late tick after stop
+    }
+
+    // Binary frame, little-endian, sent ~10 times per second per recording session instead of a JSON message:
+    //   [0]    u8   frame type (1 = record level)
+    //   [1]    u8   version (2)
+    //   [2..3] i16  RMS in 0.01 dBFS
+    //   [4..5] i16  peak in 0.01 dBFS
+    //   [6..7] u16  waveform point count N
+    //   [8..]  u8 x N  waveform peaks, 0..255 = linear peak / 128
+    //   then   u8   session id length L, L bytes session id (added in version 2)
+    const std::vector<uint8_t> &waveform = levelPayload->getWaveform();
+    const uint16_t points = static_cast<uint16_t>(std::min<size_t>(waveform.size(), UINT16_MAX));
+    auto centiDb = [](float db) {
+        return static_cast<uint16_t>(static_cast<int16_t>(std::lround(std::max(db, -320.0f) * 100.0f)));
+    };
+    const uint16_t rms = centiDb(levelPayload->getRmsDbfs());
+    const uint16_t peak = centiDb(levelPayload->getPeakDbfs());
+
+    const uint8_t idLength = static_cast<uint8_t>(std::min<size_t>(sessionId.size(), UINT8_MAX));
+
+    std::string frame;
+    frame.reserve(9 + points + idLength);
+    frame += static_cast<char>(1);
+    frame += static_cast<char>(2);
+    frame += static_cast<char>(rms & 0xFF);
+    frame += static_cast<char>(rms >> 8);
+    frame += static_cast<char>(peak & 0xFF);
+    frame += static_cast<char>(peak >> 8);
+    frame += static_cast<char>(points & 0xFF);
+    frame += static_cast<char>(points >> 8);
+    frame.append(reinterpret_cast<const char*>(waveform.data()), points);
+    frame += static_cast<char>(idLength);
+    frame.append(sessionId, 0, idLength);
+
+    webSocket_->getServer()->broadcastBinary(frame);
+}
+
+void RecordHandler::filterProgressNOTI(std::shared_ptr<Payload> payload){
+    std::shared_ptr<FilterProgressPayload> progressPayload = std::dynamic_pointer_cast<FilterProgressPayload>(payload);
+    if (progressPayload == nullptr) {
+        R_LOG(ERROR, "FILTER_PROGRESS_NOTI payload is not of type FilterProgressPayload");
+        return;
+    }
+
+    // progress -1 = queued, 0..100 = filtering; the job ends with filter_wav_file_noti
+    nlohmann::json data = nlohmann::json::object();
+    data["job_id"] = progressPayload->getJobId();
+    data["file_path"] = progressPayload->getFilePath();
+    data["progress"] = progressPayload->getProgress();
+    webSocket_->getServer()->updateStateAndBroadcast("success", "", "Record", "filter_progress_noti", data);
+}
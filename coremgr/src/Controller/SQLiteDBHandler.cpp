@@ -9,6 +9,99 @@
 #include "json.hpp"     // nlohmann::json
 #include "Event.hpp"
 #include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include "Config.hpp"
+#include "StateView.hpp"
+#include "Timer.hpp"
+#include "EventTypeId.hpp"
+
+namespace {
+    nlohmann::json recordToJson(const AudioRecord& record) {
+        nlohmann::json recordJson;
+        recordJson["id"] = record.id;
+        recordJson["file_path"] = record.filePath;
+        recordJson["duration_sec"] = record.durationSec;
+        recordJson["created_at"] = record.createdAt;
+        recordJson["file_size_bytes"] = record.fileSizeBytes;
+        recordJson["title"] = record.title;
+        recordJson["tags"] = record.tags;
+        recordJson["codec"] = record.codec;
+        recordJson["bitrate"] = record.bitrate;
+        // Thumbnail as hex, (min, max) int8 pairs
+        static const char HEX[] = "0123456789abcdef";
+        std::string peaks;
+        peaks.reserve(record.peaks.size() * 2);
+        for (uint8_t b : record.peaks) {
+            peaks += HEX[b >> 4];
+            peaks += HEX[b & 0x0F];
+        }
+        recordJson["peaks"] = peaks;
+        return recordJson;
+    }
+
+    struct PeakLevel {
+        uint32_t sampleRate = 0;
+        uint32_t framesPerPoint = 0;
+        std::vector<int8_t> minMax;     // interleaved min, max
+    };
+
+    uint32_t readLE(const unsigned char *p, int bytes) {
+        uint32_t v = 0;
+        for (int i = bytes - 1; i >= 0; --i) {
+            v = (v << 8) | p[i];
+        }
+        return v;
+    }
+
+    // Reads the level of a recordmanager peak file ("PKS1", see recordmanager PeakPyramid.hpp)
+    // best suited for `points`: the coarsest one still having at least that many points
+    bool readPeakLevel(const std::string &peakPath, size_t points, PeakLevel &out) {
+        std::ifstream file(peakPath, std::ios::binary);
+        unsigned char header[16];
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || memcmp(header, "PKS1", 4) != 0) {
+            return false;
+        }
+        out.sampleRate = readLE(header + 4, 4);
+        const uint32_t baseFrames = readLE(header + 8, 4);
+        const uint32_t factor = readLE(header + 12, 2);
+        const uint32_t levelCount = readLE(header + 14, 2);
+
+        // Levels are stored finest first and each one is smaller, so keep the last that fits
+        uint32_t framesPerPoint = baseFrames;
+        bool found = false;
+        for (uint32_t i = 0; i < levelCount; ++i, framesPerPoint *= factor) {
+            unsigned char countBytes[4];
+            if (!file.read(reinterpret_cast<char*>(countBytes), sizeof(countBytes))) {
+                return found;
+            }
+            const uint32_t count = readLE(countBytes, 4);
+            if (found && count < points) {
+                break;
+            }
+            out.framesPerPoint = framesPerPoint;
+            out.minMax.resize(static_cast<size_t>(count) * 2);
+            if (!file.read(reinterpret_cast<char*>(out.minMax.data()), static_cast<std::streamsize>(out.minMax.size()))) {
+                return false;
+            }
+            found = true;
+        }
+        return found;
+    }
+}
+
+// Reads carry a queue deadline (DBThreadPool drops them when it passes), so get() may throw
+template <typename T>
+bool SQLiteDBHandler::waitForRead(std::future<T> &future, T &result) {
+    try {
+        result = future.get(); // Blocking call
+        return true;
+    } catch (const std::future_error &e) {
+        R_LOG(WARN, "SQLiteDBHandler: DB read dropped (deadline passed or pool stopping): %s", e.what());
+    }
+    return false;
+}
 
 void SQLiteDBHandler::setDBThreadPool(std::shared_ptr<DBThreadPool> dbThreadPool) {
     dbThreadPool_ = dbThreadPool;
@@ -22,17 +115,17 @@ void SQLiteDBHandler::getAllAudioRecords() {
 
     // Retrieve updated list of audio records
     auto future = dbThreadPool_->getAllAudioRecords();
-    std::vector<AudioRecord> vec = future.get(); // Blocking call
+    std::vector<AudioRecord> vec;
+    if (!waitForRead(future, vec)) {
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "Database busy, please retry", "Record", "get_all_record_noti", {});
+        return;
+    }
     R_LOG(INFO, "SQLiteDBHandler: Retrieved %zu audio records from database", vec.size());
 
     // Broadcast updated record list
     nlohmann::json jsonVec = nlohmann::json::array();
     for (const auto& record : vec) {
-        nlohmann::json recordJson;
-        recordJson["id"] = record.id;
-        recordJson["file_path"] = record.filePath;
-        recordJson["duration_sec"] = record.durationSec;
-        jsonVec.push_back(recordJson);
+        jsonVec.push_back(recordToJson(record));
     }
     webSocket_->getServer()->updateStateAndBroadcast("success", "Fetched audio records", "Record", "get_all_record_noti", {{"records", jsonVec}});
 }
@@ -44,24 +137,28 @@ void SQLiteDBHandler::insertAudioRecord(std::shared_ptr<Payload> payload){
         return;
     }
 
-    std::string filePath = insertPayload->getFilePath();
-    int durationSec = insertPayload->getDurationSec();
+    AudioRecord record;
+    record.filePath = insertPayload->getFilePath();
+    record.durationSec = insertPayload->getDurationSec();
+    record.codec = insertPayload->getCodec();
+    record.bitrate = insertPayload->getBitrate();
+    record.peaks = insertPayload->getPeaks();
 
     if (dbThreadPool_ == nullptr) {
         R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
         return;
     }
 
-    auto future = dbThreadPool_->insertAudioRecord(filePath, durationSec);
+    std::error_code ec;
+    auto fileSize = std::filesystem::file_size(record.filePath, ec);
+    record.fileSizeBytes = ec ? 0 : static_cast<long long>(fileSize);
+
+    auto future = dbThreadPool_->insertAudioRecord(record);
     AudioRecord newRecord = future.get(); // Blocking call
 
     if (newRecord.id != -1) {
         R_LOG(INFO, "Successfully inserted audio record with id %d.", newRecord.id);
-        nlohmann::json recordJson;
-        recordJson["id"] = newRecord.id;
-        recordJson["file_path"] = newRecord.filePath;
-        recordJson["duration_sec"] = newRecord.durationSec;
-        webSocket_->getServer()->updateStateAndBroadcast("success", "Record inserted successfully", "Record", "insert_record_noti", {{"record", recordJson}});
+        webSocket_->getServer()->updateStateAndBroadcast("success", "Record inserted successfully", "Record", "insert_record_noti", {{"record", recordToJson(newRecord)}});
     } else {
         R_LOG(ERROR, "Failed to insert audio record.");
         webSocket_->getServer()->updateStateAndBroadcast("fail", "Failed to insert record to DB", "Record", "insert_record_noti", {});
@@ -102,6 +199,8 @@ void SQLiteDBHandler::removeAudioRecord(std::shared_ptr<Payload> payload) {
         } catch (const std::filesystem::filesystem_error& e) {
             R_LOG(ERROR, "Filesystem error while deleting file %s: %s", filePath.c_str(), e.what());
         }
+        std::error_code ec;
+        std::filesystem::remove(filePath + ".peaks", ec);   // older recordings have none
 
         webSocket_->getServer()->updateStateAndBroadcast("success", "Record removed successfully", "Record", "remove_record_noti", {{"id", recordId}});
     } else {
@@ -109,4 +208,333 @@ void SQLiteDBHandler::removeAudioRecord(std::shared_ptr<Payload> payload) {
         // Optionally, notify client about the failure
         webSocket_->getServer()->updateStateAndBroadcast("fail", "Failed to remove record from DB", "Record", "remove_record_noti", {{"id", recordId}});
     }
-}
\ No newline at end of file
+}
+
+void SQLiteDBHandler::updateAudioRecord(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<RecordInfoPayload> infoPayload = std::dynamic_pointer_cast<RecordInfoPayload>(payload);
+    if (infoPayload == nullptr) {
+        R_LOG(ERROR, "No valid payload for updating audio record");
+        return;
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    int recordId = infoPayload->getRecordId();
+    auto future = dbThreadPool_->updateAudioRecordInfo(recordId, infoPayload->getTitle(), infoPayload->getTags());
+    AudioRecord record = future.get(); // Blocking call
+
+    if (record.id != -1) {
+        webSocket_->getServer()->updateStateAndBroadcast("success", "Record updated successfully", "Record", "update_record_noti", {{"record", recordToJson(record)}});
+    } else {
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "Failed to update record", "Record", "update_record_noti", {{"id", recordId}});
+    }
+}
+
+void SQLiteDBHandler::getRecordPeaks(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<RecordPeaksPayload> peaksPayload = std::dynamic_pointer_cast<RecordPeaksPayload>(payload);
+    if (peaksPayload == nullptr) {
+        R_LOG(ERROR, "No valid payload for getting record peaks");
+        return;
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    const int recordId = peaksPayload->getRecordId();
+    auto future = dbThreadPool_->getAudioRecord(recordId);
+    AudioRecord record;
+    if (!waitForRead(future, record)) {
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "Database busy, please retry", "Record", "get_record_peaks_noti", {{"id", recordId}});
+        return;
+    }
+
+    PeakLevel level;
+    const size_t points = static_cast<size_t>(std::max(peaksPayload->getPoints(), 1));
+    if (record.id == -1 || !readPeakLevel(record.filePath + ".peaks", points, level)) {
+        R_LOG(WARN, "No waveform peaks for record id %d", recordId);
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "No waveform available for this record", "Record", "get_record_peaks_noti", {{"id", recordId}});
+        return;
+    }
+
+    // Binary frame, little-endian (a long recording is tens of thousands of points):
+    //   [0]      u8   frame type (2 = record peaks)
+    //   [1]      u8   version (1)
+    //   [2..5]   u32  record id
+    //   [6..9]   u32  frames per point
+    //   [10..13] u32  sample rate
+    //   [14..17] u32  point count N
+    //   [18..]   N x (i8 min, i8 max), top 8 bits of the 16-bit samples
+    auto putU32 = [](std::string &out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) {
+            out += static_cast<char>((v >> (8 * i)) & 0xFF);
+        }
+    };
+    std::string frame;
+    frame.reserve(18 + level.minMax.size());
+    frame += static_cast<char>(2);
+    frame += static_cast<char>(1);
+    putU32(frame, static_cast<uint32_t>(recordId));
+    putU32(frame, level.framesPerPoint);
+    putU32(frame, level.sampleRate);
+    putU32(frame, static_cast<uint32_t>(level.minMax.size() / 2));
+    frame.append(reinterpret_cast<const char*>(level.minMax.data()), level.minMax.size());
+
+    webSocket_->getServer()->broadcastBinary(frame);
+}
+
+void SQLiteDBHandler::search(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<SearchPayload> searchPayload = std::dynamic_pointer_cast<SearchPayload>(payload);
+    if (searchPayload == nullptr) {
+        R_LOG(ERROR, "No valid payload for search");
+        return;
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    const std::string query = searchPayload->getQuery();
+    const std::string scope = searchPayload->getScope();
+    const bool includeRecords = (scope != "contacts");
+    const bool includeContacts = (scope != "records");
+    const int limit = std::clamp(searchPayload->getLimit(), 1, CONFIG_INSTANCE()->getDBPageMaxLimit());
+
+    auto future = dbThreadPool_->search(query, includeRecords, includeContacts, limit);
+    SearchResult result;
+    if (!waitForRead(future, result)) {
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "Database busy, please retry", "Search", "search_noti", {{"query", query}});
+        return;
+    }
+
+    nlohmann::json recordsJson = nlohmann::json::array();
+    for (const auto& match : result.records) {
+        nlohmann::json recordJson = recordToJson(match.record);
+        recordJson["snippet"] = match.snippet;
+        recordsJson.push_back(recordJson);
+    }
+    nlohmann::json contactsJson = nlohmann::json::array();
+    for (const auto& contact : result.contacts) {
+        contactsJson.push_back({
+            {"id", contact.id},
+            {"contact_name", contact.name},
+            {"contact_number", contact.number}
+        });
+    }
+    webSocket_->getServer()->updateStateAndBroadcast("success", "Search completed", "Search", "search_noti",
+        {{"query", query}, {"records", recordsJson}, {"contacts", contactsJson}});
+}
+
+void SQLiteDBHandler::beginContactSync(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
+    if (notiPayload == nullptr || !notiPayload->isSuccess()) {
+        return;
+    }
+    pendingContacts_.clear();
+    contactSyncActive_ = true;
+}
+
+void SQLiteDBHandler::bufferContact(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<ContactPayload> contactPayload = std::dynamic_pointer_cast<ContactPayload>(payload);
+    if (contactPayload == nullptr || !contactSyncActive_) {
+        return;
+    }
+    pendingContacts_.push_back({-1, contactPayload->getName(), contactPayload->getNumber(), ""});
+}
+
+void SQLiteDBHandler::commitContactSync(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
+    if (!contactSyncActive_) {
+        return;
+    }
+    contactSyncActive_ = false;
+
+    // A failed pull is partial: keep what is on disk rather than pruning contacts we did not see
+    if (notiPayload == nullptr || !notiPayload->isSuccess()) {
+        R_LOG(WARN, "Phonebook pull did not complete, discarding %zu buffered contacts", pendingContacts_.size());
+        pendingContacts_.clear();
+        return;
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    // Runs on the background lane; completion comes back as CONTACTS_SYNCED_NOTI
+    dbThreadPool_->syncContacts(std::move(pendingContacts_));
+    pendingContacts_.clear();
+}
+
+void SQLiteDBHandler::contactsSyncedNOTI(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
+    if (notiPayload == nullptr) {
+        R_LOG(ERROR, "CONTACTS_SYNCED_NOTI payload is not of type NotiPayload");
+        return;
+    }
+    if (notiPayload->isSuccess()) {
+        R_LOG(INFO, "Contacts persisted to DB");
+        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Call", "contacts_updated_noti", {});
+    } else {
+        R_LOG(ERROR, "Failed to persist contacts to DB");
+    }
+}
+
+void SQLiteDBHandler::beginCallHistorySync(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
+    if (notiPayload == nullptr || !notiPayload->isSuccess()) {
+        return;
+    }
+    pendingCallHistory_.clear();
+    callHistorySyncActive_ = true;
+}
+
+void SQLiteDBHandler::bufferCallHistory(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<CallHistoryPayload> historyPayload = std::dynamic_pointer_cast<CallHistoryPayload>(payload);
+    if (historyPayload == nullptr || !callHistorySyncActive_) {
+        return;
+    }
+    pendingCallHistory_.push_back({-1, historyPayload->getName(), historyPayload->getNumber(), "",
+        historyPayload->getType(), historyPayload->getDateTime()});
+}
+
+void SQLiteDBHandler::commitCallHistorySync(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
+    if (!callHistorySyncActive_) {
+        return;
+    }
+    callHistorySyncActive_ = false;
+
+    if (notiPayload == nullptr || !notiPayload->isSuccess()) {
+        R_LOG(WARN, "Call history pull did not complete, merging %zu entries received so far", pendingCallHistory_.size());
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    // History is merged (never pruned), so even a partial pull is safe to store
+    dbThreadPool_->upsertCallHistory(std::move(pendingCallHistory_));
+    pendingCallHistory_.clear();
+}
+
+void SQLiteDBHandler::callHistorySyncedNOTI(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<NotiPayload> notiPayload = std::dynamic_pointer_cast<NotiPayload>(payload);
+    if (notiPayload == nullptr) {
+        R_LOG(ERROR, "CALL_HISTORY_SYNCED_NOTI payload is not of type NotiPayload");
+        return;
+    }
+    if (notiPayload->isSuccess()) {
+        R_LOG(INFO, "Call history persisted to DB");
+        webSocket_->getServer()->updateStateAndBroadcast("success", notiPayload->getMsgInfo(), "Call", "call_history_updated_noti", {});
+    } else {
+        R_LOG(ERROR, "Failed to persist call history to DB");
+    }
+}
+
+bool SQLiteDBHandler::parsePage(std::shared_ptr<Payload> payload, int &offset, int &limit) {
+    std::shared_ptr<PagePayload> pagePayload = std::dynamic_pointer_cast<PagePayload>(payload);
+    if (pagePayload == nullptr) {
+        R_LOG(ERROR, "No valid payload for paged query");
+        return false;
+    }
+    offset = std::max(0, pagePayload->getOffset());
+    limit = std::clamp(pagePayload->getLimit(), 1, CONFIG_INSTANCE()->getDBPageMaxLimit());
+    return true;
+}
+
+void SQLiteDBHandler::getContacts(std::shared_ptr<Payload> payload) {
+    int offset = 0;
+    int limit = 0;
+    if (!parsePage(payload, offset, limit)) {
+        return;
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    auto future = dbThreadPool_->getContacts(offset, limit);
+    ContactPage page{{}, 0};
+    if (!waitForRead(future, page)) {
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "Database busy, please retry", "Call", "get_contacts_noti", {});
+        return;
+    }
+
+    nlohmann::json jsonVec = nlohmann::json::array();
+    for (const auto& contact : page.contacts) {
+        jsonVec.push_back({
+            {"id", contact.id},
+            {"contact_name", contact.name},
+            {"contact_number", contact.number}
+        });
+    }
+    webSocket_->getServer()->updateStateAndBroadcast("success", "Fetched contacts", "Call", "get_contacts_noti",
+        {{"contacts", jsonVec}, {"offset", offset}, {"total", page.total}});
+}
+
+void SQLiteDBHandler::getCallHistory(std::shared_ptr<Payload> payload) {
+    int offset = 0;
+    int limit = 0;
+    if (!parsePage(payload, offset, limit)) {
+        return;
+    }
+
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    auto future = dbThreadPool_->getCallHistory(offset, limit);
+    CallHistoryPage page{{}, 0};
+    if (!waitForRead(future, page)) {
+        webSocket_->getServer()->updateStateAndBroadcast("fail", "Database busy, please retry", "Call", "get_call_history_noti", {});
+        return;
+    }
+
+    nlohmann::json jsonVec = nlohmann::json::array();
+    for (const auto& entry : page.entries) {
+        jsonVec.push_back({
+            {"id", entry.id},
+            {"call_history_name", entry.name},
+            {"call_history_number", entry.number},
+            {"call_history_type", entry.type},
+            {"call_history_datetime", entry.callTime}
+        });
+    }
+    webSocket_->getServer()->updateStateAndBroadcast("success", "Fetched call history", "Call", "get_call_history_noti",
+        {{"call_history", jsonVec}, {"offset", offset}, {"total", page.total}});
+}
+
+void SQLiteDBHandler::scheduleMaintenance(unsigned int delayMs) {
+    TIMER_INSTANCE()->startTimer(delayMs, std::make_shared<Event>(EventTypeID::DB_MAINTENANCE));
+}
+
+void SQLiteDBHandler::runMaintenanceIfIdle() {
+    if (dbThreadPool_ == nullptr) {
+        R_LOG(ERROR, "DBThreadPool is not set in SQLiteDBHandler");
+        return;
+    }
+
+    // Vacuum/checkpoint I/O must not compete with the recorder or a call's audio path
+    bool idle = STATE_VIEW_INSTANCE()->isRecordIdle() &&
+                STATE_VIEW_INSTANCE()->CALL_STATE == CallState::IDLE;
+    if (!idle) {
+        R_LOG(INFO, "SQLiteDBHandler: System busy, postponing DB maintenance");
+        scheduleMaintenance(CONFIG_INSTANCE()->getDBMaintenanceRetryMs());
+        return;
+    }
+
+    bool fullAnalyze = (maintenanceRuns_ % CONFIG_INSTANCE()->getDBFullAnalyzeEveryRuns()) == 0;
+    maintenanceRuns_++;
+    R_LOG(INFO, "SQLiteDBHandler: Starting DB maintenance run #%u", maintenanceRuns_);
+    dbThreadPool_->runMaintenance(fullAnalyze);
+    scheduleMaintenance(CONFIG_INSTANCE()->getDBMaintenanceIntervalMs());
+}
@@ -0,0 +1,136 @@
+#include "Migrations.hpp"
+
+const std::vector<SchemaMigration> &getSchemaMigrations() {
+    static const std::vector<SchemaMigration> migrations = {
+        {
+            1, "Initial schema (audio records, contacts, call history)",
+            // IF NOT EXISTS: databases created before versioning already have these tables
+            R"(
+                CREATE TABLE IF NOT EXISTS audio_records (
+                    id INTEGER PRIMARY KEY AUTOINCREMENT,
+                    file_path TEXT NOT NULL UNIQUE,
+                    duration_sec INTEGER NOT NULL,
+                    created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+                );
+
+                CREATE TABLE IF NOT EXISTS contacts (
+                    id INTEGER PRIMARY KEY AUTOINCREMENT,
+                    name TEXT NOT NULL,
+                    number TEXT NOT NULL,
+                    normalized_number TEXT NOT NULL UNIQUE,
+                    synced_at INTEGER NOT NULL DEFAULT 0
+                );
+                CREATE INDEX IF NOT EXISTS idx_contacts_name ON contacts(name COLLATE NOCASE);
+
+                CREATE TABLE IF NOT EXISTS call_history (
+                    id INTEGER PRIMARY KEY AUTOINCREMENT,
+                    name TEXT NOT NULL DEFAULT '',
+                    number TEXT NOT NULL,
+                    normalized_number TEXT NOT NULL,
+                    call_type TEXT NOT NULL,
+                    call_time TEXT NOT NULL,
+                    UNIQUE(normalized_number, call_type, call_time)
+                );
+                CREATE INDEX IF NOT EXISTS idx_call_history_time ON call_history(call_time DESC);
+            )"
+        },
+        {
+            2, "Index audio records by creation time",
+            R"(
+                CREATE INDEX IF NOT EXISTS idx_audio_records_created_at ON audio_records(created_at DESC);
+            )"
+        },
+        {
+            3, "Store audio file size",
+            R"(
+                ALTER TABLE audio_records ADD COLUMN file_size_bytes INTEGER NOT NULL DEFAULT 0;
+            )"
+        },
+        {
+            4, "Full-text search over recordings and contacts",
+            // External-content FTS5 tables: the base tables stay the source of truth, triggers keep the
+            // indexes in sync. Recordings use word/prefix matching, contacts use trigrams so a
+            // fragment of a name or number matches anywhere.
+            R"(
+                ALTER TABLE audio_records ADD COLUMN title TEXT NOT NULL DEFAULT '';
+                ALTER TABLE audio_records ADD COLUMN tags TEXT NOT NULL DEFAULT '';
+                ALTER TABLE audio_records ADD COLUMN transcript TEXT NOT NULL DEFAULT '';
+
+                -- title defaults to the file name without directory and extension
+                UPDATE audio_records SET title = (
+                    SELECT CASE WHEN instr(base, '.') > 0 THEN substr(base, 1, instr(base, '.') - 1) ELSE base END
+                    FROM (SELECT replace(file_path, rtrim(file_path, replace(file_path, '/', '')), '') AS base)
+                );
+
+                CREATE VIRTUAL TABLE records_fts USING fts5(
+                    title, tags, transcript,
+                    content='audio_records', content_rowid='id',
+                    tokenize='unicode61 remove_diacritics 2', prefix='2 3'
+                );
+                CREATE TRIGGER audio_records_fts_ai AFTER INSERT ON audio_records BEGIN
+                    INSERT INTO records_fts(rowid, title, tags, transcript)
+                    VALUES (new.id, new.title, new.tags, new.transcript);
+                END;
+                CREATE TRIGGER audio_records_fts_ad AFTER DELETE ON audio_records BEGIN
+                    INSERT INTO records_fts(records_fts, rowid, title, tags, transcript)
+                    VALUES ('delete', old.id, old.title, old.tags, old.transcript);
+                END;
+                CREATE TRIGGER audio_records_fts_au AFTER UPDATE OF title, tags, transcript ON audio_records BEGIN
+                    INSERT INTO records_fts(records_fts, rowid, title, tags, transcript)
+                    VALUES ('delete', old.id, old.title, old.tags, old.transcript);
+                    INSERT INTO records_fts(rowid, title, tags, transcript)
+                    VALUES (new.id, new.title, new.tags, new.transcript);
+                END;
+                INSERT INTO records_fts(records_fts) VALUES ('rebuild');
+
+                CREATE VIRTUAL TABLE contacts_fts USING fts5(
+                    name, normalized_number,
+                    content='contacts', content_rowid='id',
+                    tokenize='trigram'
+                );
+                CREATE TRIGGER contacts_fts_ai AFTER INSERT ON contacts BEGIN
+                    INSERT INTO contacts_fts(rowid, name, normalized_number)
+                    VALUES (new.id, new.name, new.normalized_number);
+                END;
+                CREATE TRIGGER contacts_fts_ad AFTER DELETE ON contacts BEGIN
+                    INSERT INTO contacts_fts(contacts_fts, rowid, name, normalized_number)
+                    VALUES ('delete', old.id, old.name, old.normalized_number);
+                END;
+                CREATE TRIGGER contacts_fts_au AFTER UPDATE OF name, normalized_number ON contacts
+                WHEN old.name IS NOT new.name OR old.normalized_number IS NOT new.normalized_number BEGIN
+                    INSERT INTO contacts_fts(contacts_fts, rowid, name, normalized_number)
+                    VALUES ('delete', old.id, old.name, old.normalized_number);
+                    INSERT INTO contacts_fts(rowid, name, normalized_number)
+                    VALUES (new.id, new.name, new.normalized_number);
+                END;
+                INSERT INTO contacts_fts(contacts_fts) VALUES ('rebuild');
+            )"
+        },
+        {
+            5, "Switch to incremental auto-vacuum",
+            // Changing auto_vacuum on an existing file only takes effect after a full VACUUM (one-off);
+            // from then on the maintenance job reclaims free pages in small incremental steps
+            R"(
+                PRAGMA auto_vacuum = INCREMENTAL;
+                VACUUM;
+            )",
+            false
+        },
+        {
+            6, "Track the codec and bitrate of audio records",
+            // Rows from before compressed output are all 16-bit PCM WAV
+            R"(
+                ALTER TABLE audio_records ADD COLUMN codec TEXT NOT NULL DEFAULT 'wav';
+                ALTER TABLE audio_records ADD COLUMN bitrate INTEGER NOT NULL DEFAULT 0;
+            )"
+        },
+        {
+            7, "Store a waveform thumbnail per audio record",
+            // NULL for older recordings, they have no peak file either
+            R"(
+                ALTER TABLE audio_records ADD COLUMN peaks BLOB;
+            )"
+        },
+    };
+    return migrations;
+}
@@ -1,9 +1,88 @@
 #include "SQLiteDatabase.hpp"
 #include "RLogger.hpp"
+#include "Migrations.hpp"
 #include <filesystem>
+#include <cctype>
+#include <chrono>
 
 namespace fs = std::filesystem;
 
+namespace {
+    // Column order: id, file_path, duration_sec, created_at, file_size_bytes, title, tags, codec, bitrate, peaks
+    const char* AUDIO_RECORD_COLUMNS = "id, file_path, duration_sec, created_at, file_size_bytes, title, tags, codec, bitrate, peaks";
+
+    std::string columnText(sqlite3_stmt* stmt, int col) {
+        const unsigned char* text = sqlite3_column_text(stmt, col);
+        return text ? reinterpret_cast<const char*>(text) : "";
+    }
+
+    AudioRecord readAudioRecord(sqlite3_stmt* stmt) {
+        AudioRecord record;
+        record.id = sqlite3_column_int(stmt, 0);
+        record.filePath = columnText(stmt, 1);
+        record.durationSec = sqlite3_column_int(stmt, 2);
+        record.createdAt = columnText(stmt, 3);
+        record.fileSizeBytes = sqlite3_column_int64(stmt, 4);
+        record.title = columnText(stmt, 5);
+        record.tags = columnText(stmt, 6);
+        record.codec = columnText(stmt, 7);
+        record.bitrate = sqlite3_column_int(stmt, 8);
+        const auto* peaks = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 9));
+        record.peaks.assign(peaks, peaks + sqlite3_column_bytes(stmt, 9));
+        return record;
+    }
+
+    // "record_20240101_120000.wav" -> "record_20240101_120000" (same rule as migration 4's backfill)
+    std::string defaultTitle(const std::string& filePath) {
+        std::string base = fs::path(filePath).filename().string();
+        return base.substr(0, base.find('.'));
+    }
+
+    std::string quoteFtsTerm(const std::string& term) {
+        std::string quoted = "\"";
+        for (char c : term) {
+            quoted += c;
+            if (c == '"') {
+                quoted += '"';
+            }
+        }
+        return quoted + "\"";
+    }
+
+    // User text -> FTS5 query: every word must match as a prefix ("meet 2024" -> "meet"* "2024"*)
+    std::string buildPrefixQuery(const std::string& text) {
+        std::string query;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t start = text.find_first_not_of(" \t", pos);
+            if (start == std::string::npos) {
+                break;
+            }
+            size_t end = text.find_first_of(" \t", start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            if (!query.empty()) {
+                query += ' ';
+            }
+            query += quoteFtsTerm(text.substr(start, end - start)) + "*";
+            pos = end;
+        }
+        return query;
+    }
+
+    std::string escapeLike(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '%' || c == '_' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
 SQLiteDatabase::SQLiteDatabase(const std::string &dbFilePath) : dbFilePath_(dbFilePath), db_(nullptr) {}
 
 SQLiteDatabase::~SQLiteDatabase() {
@@ -28,8 +107,14 @@ bool SQLiteDatabase::open() {
         return false;
     }
 
+    // WAL lets checkpoints run without blocking readers; NORMAL sync is durable enough in WAL mode
+    // (a power cut may lose the last commits, never corrupts the file)
+    if (!executeSQL("PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;")) {
+        R_LOG(WARN, "SQLiteDatabase: Failed to enable WAL, continuing with the default journal");
+    }
+
     R_LOG(INFO, "SQLiteDatabase: Database opened successfully");
-    return initializeSchema();
+    return true;
 }
 
 void SQLiteDatabase::close() {
@@ -41,17 +126,68 @@ void SQLiteDatabase::close() {
     }
 }
 
-bool SQLiteDatabase::initializeSchema() {
-    const char* createTableSQL = R"(
-        CREATE TABLE IF NOT EXISTS audio_records (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            file_path TEXT NOT NULL UNIQUE,
-            duration_sec INTEGER NOT NULL,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        );
-    )";
+int SQLiteDatabase::getSchemaVersion() {
+    int version = -1;
+    sqlite3_stmt* stmt = prepareStatement("PRAGMA user_version;");
+    if (!stmt) {
+        return version;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+bool SQLiteDatabase::migrateSchema() {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    int currentVersion = getSchemaVersion();
+    if (currentVersion < 0) {
+        R_LOG(ERROR, "SQLiteDatabase: Failed to read schema version");
+        return false;
+    }
 
-    return executeSQL(createTableSQL);
+    const auto& migrations = getSchemaMigrations();
+    const int latestVersion = migrations.empty() ? 0 : migrations.back().version;
+    if (currentVersion > latestVersion) {
+        // Downgraded binary: newer columns/tables are left alone, older code paths still work
+        R_LOG(WARN, "SQLiteDatabase: Schema version %d is newer than this build (%d)", currentVersion, latestVersion);
+        return true;
+    }
+    if (currentVersion == latestVersion) {
+        R_LOG(INFO, "SQLiteDatabase: Schema is up to date (version %d)", currentVersion);
+        return true;
+    }
+
+    for (const auto& migration : migrations) {
+        if (migration.version <= currentVersion) {
+            continue;
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        R_LOG(INFO, "SQLiteDatabase: Applying migration %d: %s", migration.version, migration.description.c_str());
+
+        // The version bump commits together with the step, so a crash never leaves a half-applied version
+        const std::string versionSQL = "PRAGMA user_version = " + std::to_string(migration.version) + ";";
+        const std::string stepSQL = migration.transactional
+            ? "BEGIN IMMEDIATE;" + migration.sql + versionSQL + "COMMIT;"
+            : migration.sql + versionSQL;
+        if (!executeSQL(stepSQL)) {
+            if (migration.transactional) {
+                executeSQL("ROLLBACK;");
+            }
+            R_LOG(ERROR, "SQLiteDatabase: Migration %d failed, schema stays at version %d", migration.version, currentVersion);
+            return false;
+        }
+        currentVersion = migration.version;
+
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        R_LOG(INFO, "SQLiteDatabase: Migration %d applied in %lld ms", migration.version, static_cast<long long>(elapsedMs));
+    }
+
+    R_LOG(INFO, "SQLiteDatabase: Schema migrated to version %d", currentVersion);
+    return true;
 }
 
 bool SQLiteDatabase::executeSQL(const std::string& sql) {
@@ -84,32 +220,44 @@ AudioRecord SQLiteDatabase::insertAudioRecord(const AudioRecord &record) {
     std::lock_guard<std::mutex> lock(dbMutex_);
 
     const std::string insertSQL = R"(
-        INSERT INTO audio_records (file_path, duration_sec)
-        VALUES (?, ?);
+        INSERT INTO audio_records (file_path, duration_sec, file_size_bytes, title, codec, bitrate, peaks)
+        VALUES (?, ?, ?, ?, ?, ?, ?)
+        RETURNING id, created_at, title;
     )";
 
     sqlite3_stmt* stmt = prepareStatement(insertSQL);
     if (!stmt) {
-        return {-1, "", 0};
+        return AudioRecord{};
     }
 
     // Bind parameters
     sqlite3_bind_text(stmt, 1, record.filePath.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 2, record.durationSec);
+    sqlite3_bind_int64(stmt, 3, record.fileSizeBytes);
+    const std::string title = record.title.empty() ? defaultTitle(record.filePath) : record.title;
+    sqlite3_bind_text(stmt, 4, title.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 5, record.codec.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 6, record.bitrate);
+    if (record.peaks.empty()) {
+        sqlite3_bind_null(stmt, 7);
+    } else {
+        sqlite3_bind_blob(stmt, 7, record.peaks.data(), static_cast<int>(record.peaks.size()), SQLITE_STATIC);
+    }
 
     int rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
+    if (rc != SQLITE_ROW) {
         R_LOG(ERROR, "SQLiteDatabase: Failed to insert audio record: %s", sqlite3_errmsg(db_));
         sqlite3_finalize(stmt);
-        return {-1, "", 0};
+        return AudioRecord{};
     }
 
-    sqlite3_int64 lastId = sqlite3_last_insert_rowid(db_);
+    AudioRecord newRecord = record;
+    newRecord.id = sqlite3_column_int(stmt, 0);
+    newRecord.createdAt = columnText(stmt, 1);
+    newRecord.title = columnText(stmt, 2);
     R_LOG(INFO, "SQLiteDatabase: Audio record inserted successfully with file path: %s", record.filePath.c_str());
     sqlite3_finalize(stmt);
 
-    AudioRecord newRecord = record;
-    newRecord.id = static_cast<int>(lastId);
     return newRecord;
 }
 
@@ -117,9 +265,8 @@ std::vector<AudioRecord> SQLiteDatabase::getAllRecords() {
     std::lock_guard<std::mutex> lock(dbMutex_);
     
     std::vector<AudioRecord> records;
-    const std::string querySQL = R"(
-        SELECT id, file_path, duration_sec FROM audio_records ORDER BY created_at DESC LIMIT 100;
-    )";
+    const std::string querySQL = std::string("SELECT ") + AUDIO_RECORD_COLUMNS +
+        " FROM audio_records ORDER BY created_at DESC LIMIT 100;";
 
     sqlite3_stmt* stmt = prepareStatement(querySQL);
     if (!stmt) {
@@ -127,12 +274,7 @@ std::vector<AudioRecord> SQLiteDatabase::getAllRecords() {
     }
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        AudioRecord record;
-        record.id = sqlite3_column_int(stmt, 0);
-        record.filePath = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        record.durationSec = sqlite3_column_int(stmt, 2);
-        
-        records.push_back(record);
+        records.push_back(readAudioRecord(stmt));
     }
 
     sqlite3_finalize(stmt);
@@ -140,6 +282,26 @@ std::vector<AudioRecord> SQLiteDatabase::getAllRecords() {
     return records;
 }
 
+AudioRecord SQLiteDatabase::getAudioRecord(int recordId) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    const std::string querySQL = std::string("SELECT ") + AUDIO_RECORD_COLUMNS + " FROM audio_records WHERE id = ?;";
+    sqlite3_stmt* stmt = prepareStatement(querySQL);
+    if (!stmt) {
+        return AudioRecord{};
+    }
+    sqlite3_bind_int(stmt, 1, recordId);
+
+    AudioRecord record;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        record = readAudioRecord(stmt);
+    } else {
+        R_LOG(WARN, "SQLiteDatabase: No record found with id %d.", recordId);
+    }
+    sqlite3_finalize(stmt);
+    return record;
+}
+
 std::string SQLiteDatabase::removeAudioRecord(int recordId) {
     std::lock_guard<std::mutex> lock(dbMutex_);
 
@@ -168,4 +330,393 @@ std::string SQLiteDatabase::removeAudioRecord(int recordId) {
 
     sqlite3_finalize(stmt);
     return filePath;
-}
\ No newline at end of file
+}
+
+AudioRecord SQLiteDatabase::updateAudioRecordInfo(int recordId, const std::optional<std::string> &title,
+    const std::optional<std::string> &tags) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    // NULL keeps the current value
+    const std::string updateSQL = std::string(R"(
+        UPDATE audio_records SET title = COALESCE(?, title), tags = COALESCE(?, tags)
+        WHERE id = ? RETURNING )") + AUDIO_RECORD_COLUMNS + ";";
+
+    sqlite3_stmt* stmt = prepareStatement(updateSQL);
+    if (!stmt) {
+        return AudioRecord{};
+    }
+
+    if (title) {
+        sqlite3_bind_text(stmt, 1, title->c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 1);
+    }
+    if (tags) {
+        sqlite3_bind_text(stmt, 2, tags->c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, 2);
+    }
+    sqlite3_bind_int(stmt, 3, recordId);
+
+    AudioRecord record;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        record = readAudioRecord(stmt);
+        R_LOG(INFO, "SQLiteDatabase: Audio record with id %d updated.", recordId);
+    } else if (rc == SQLITE_DONE) {
+        R_LOG(WARN, "SQLiteDatabase: No record found with id %d to update.", recordId);
+    } else {
+        R_LOG(ERROR, "SQLiteDatabase: Failed to update audio record with id %d: %s", recordId, sqlite3_errmsg(db_));
+    }
+
+    sqlite3_finalize(stmt);
+    return record;
+}
+
+SearchResult SQLiteDatabase::search(const std::string &query, bool includeRecords, bool includeContacts, int limit) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    SearchResult result;
+
+    if (includeRecords) {
+        const std::string matchQuery = buildPrefixQuery(query);
+        if (!matchQuery.empty()) {
+            // bm25 column weights: title > tags > transcript
+            const std::string searchSQL = R"(
+                SELECT a.id, a.file_path, a.duration_sec, a.created_at, a.file_size_bytes, a.title, a.tags,
+                       a.codec, a.bitrate, a.peaks, snippet(records_fts, -1, '[', ']', '...', 10)
+                FROM records_fts JOIN audio_records a ON a.id = records_fts.rowid
+                WHERE records_fts MATCH ?
+                ORDER BY bm25(records_fts, 10.0, 5.0, 1.0) LIMIT ?;
+            )";
+            sqlite3_stmt* stmt = prepareStatement(searchSQL);
+            if (stmt) {
+                sqlite3_bind_text(stmt, 1, matchQuery.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_int(stmt, 2, limit);
+                while (sqlite3_step(stmt) == SQLITE_ROW) {
+                    result.records.push_back({readAudioRecord(stmt), columnText(stmt, 10)});
+                }
+                sqlite3_finalize(stmt);
+            }
+        }
+    }
+
+    if (includeContacts) {
+        // Trigram index needs at least 3 characters; shorter input falls back to a LIKE scan
+        const std::string digits = normalizeNumber(query);
+        const bool useTrigram = query.size() >= 3;
+        std::string searchSQL;
+        std::string pattern;
+        if (useTrigram) {
+            pattern = "name : " + quoteFtsTerm(query);
+            if (digits.size() >= 3) {
+                pattern += " OR normalized_number : " + quoteFtsTerm(digits);
+            }
+            searchSQL = R"(
+                SELECT c.id, c.name, c.number, c.normalized_number
+                FROM contacts_fts JOIN contacts c ON c.id = contacts_fts.rowid
+                WHERE contacts_fts MATCH ?
+                ORDER BY rank LIMIT ?;
+            )";
+        } else {
+            pattern = "%" + escapeLike(query) + "%";
+            searchSQL = R"(
+                SELECT id, name, number, normalized_number FROM contacts
+                WHERE name LIKE ?1 ESCAPE '\' OR normalized_number LIKE ?1 ESCAPE '\'
+                ORDER BY name COLLATE NOCASE LIMIT ?2;
+            )";
+        }
+
+        sqlite3_stmt* stmt = query.empty() ? nullptr : prepareStatement(searchSQL);
+        if (stmt) {
+            sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 2, limit);
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                result.contacts.push_back({sqlite3_column_int(stmt, 0), columnText(stmt, 1),
+                    columnText(stmt, 2), columnText(stmt, 3)});
+            }
+            sqlite3_finalize(stmt);
+        }
+    }
+
+    R_LOG(INFO, "SQLiteDatabase: Search '%s' matched %zu records, %zu contacts",
+        query.c_str(), result.records.size(), result.contacts.size());
+    return result;
+}
+
+DBPageStats SQLiteDatabase::getPageStats() {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    DBPageStats stats;
+    const char* pragmas[] = {"PRAGMA page_count;", "PRAGMA freelist_count;", "PRAGMA page_size;"};
+    long long* targets[] = {&stats.pageCount, &stats.freelistCount, &stats.pageSize};
+    for (int i = 0; i < 3; i++) {
+        sqlite3_stmt* stmt = prepareStatement(pragmas[i]);
+        if (!stmt) {
+            continue;
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            *targets[i] = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return stats;
+}
+
+bool SQLiteDatabase::checkpointWal(int &walFrames, int &checkpointedFrames) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    // PASSIVE: copy what can be copied without waiting on any reader or writer
+    int rc = sqlite3_wal_checkpoint_v2(db_, nullptr, SQLITE_CHECKPOINT_PASSIVE, &walFrames, &checkpointedFrames);
+    if (rc != SQLITE_OK) {
+        R_LOG(WARN, "SQLiteDatabase: WAL checkpoint failed: %s", sqlite3_errmsg(db_));
+        return false;
+    }
+    return true;
+}
+
+bool SQLiteDatabase::incrementalVacuum(int maxPages) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    return executeSQL("PRAGMA incremental_vacuum(" + std::to_string(maxPages) + ");");
+}
+
+bool SQLiteDatabase::optimizeFullText() {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    // Merge FTS5 segments; pages left behind by deleted rows end up on the freelist
+    return executeSQL("INSERT INTO records_fts(records_fts) VALUES ('optimize');"
+                      "INSERT INTO contacts_fts(contacts_fts) VALUES ('optimize');");
+}
+
+bool SQLiteDatabase::analyze(bool full) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    // optimize only re-analyzes tables whose statistics are missing or stale
+    return executeSQL(full ? "ANALYZE;" : "PRAGMA optimize;");
+}
+
+std::string SQLiteDatabase::normalizeNumber(const std::string &number) {
+    // Strip formatting ("+84 (90) 123-4567" -> "+84901234567"), "00" prefix is the same as '+'
+    std::string normalized;
+    normalized.reserve(number.size());
+    for (char c : number) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            normalized.push_back(c);
+        } else if (c == '+' && normalized.empty()) {
+            normalized.push_back(c);
+        }
+    }
+    if (normalized.rfind("00", 0) == 0) {
+        normalized.replace(0, 2, "+");
+    }
+    return normalized;
+}
+
+int SQLiteDatabase::countRows(const std::string& table) {
+    int count = 0;
+    sqlite3_stmt* stmt = prepareStatement("SELECT COUNT(*) FROM " + table + ";");
+    if (!stmt) {
+        return 0;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+bool SQLiteDatabase::syncContacts(const std::vector<Contact> &contacts, bool pruneMissing) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    const std::string upsertSQL = R"(
+        INSERT INTO contacts (name, number, normalized_number, synced_at)
+        VALUES (?, ?, ?, ?)
+        ON CONFLICT(normalized_number) DO UPDATE SET
+            name = excluded.name,
+            number = excluded.number,
+            synced_at = excluded.synced_at;
+    )";
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    // Every row touched by this sync gets the same generation, any other row was removed on
+    // the phone. A counter rather than the wall clock, which can step back on a Pi without RTC
+    sqlite3_int64 syncStamp = 1;
+    sqlite3_stmt* stampStmt = prepareStatement("SELECT COALESCE(MAX(synced_at), 0) + 1 FROM contacts;");
+    if (!stampStmt) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+    if (sqlite3_step(stampStmt) == SQLITE_ROW) {
+        syncStamp = sqlite3_column_int64(stampStmt, 0);
+    }
+    sqlite3_finalize(stampStmt);
+
+    sqlite3_stmt* stmt = prepareStatement(upsertSQL);
+    if (!stmt) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+
+    for (const auto& contact : contacts) {
+        std::string normalized = normalizeNumber(contact.number);
+        if (normalized.empty()) {
+            continue;
+        }
+        sqlite3_bind_text(stmt, 1, contact.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, contact.number.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, normalized.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 4, syncStamp);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            R_LOG(ERROR, "SQLiteDatabase: Failed to upsert contact %s: %s", contact.number.c_str(), sqlite3_errmsg(db_));
+            sqlite3_finalize(stmt);
+            executeSQL("ROLLBACK;");
+            return false;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (pruneMissing) {
+        sqlite3_stmt* pruneStmt = prepareStatement("DELETE FROM contacts WHERE synced_at <> ?;");
+        if (!pruneStmt) {
+            executeSQL("ROLLBACK;");
+            return false;
+        }
+        sqlite3_bind_int64(pruneStmt, 1, syncStamp);
+        if (sqlite3_step(pruneStmt) != SQLITE_DONE) {
+            R_LOG(ERROR, "SQLiteDatabase: Failed to prune stale contacts: %s", sqlite3_errmsg(db_));
+            sqlite3_finalize(pruneStmt);
+            executeSQL("ROLLBACK;");
+            return false;
+        }
+        R_LOG(INFO, "SQLiteDatabase: Pruned %d stale contacts", sqlite3_changes(db_));
+        sqlite3_finalize(pruneStmt);
+    }
+
+    if (!executeSQL("COMMIT;")) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+
+    R_LOG(INFO, "SQLiteDatabase: Synced %zu contacts", contacts.size());
+    return true;
+}
+
+ContactPage SQLiteDatabase::getContacts(int offset, int limit) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    ContactPage page{{}, 0};
+    const std::string querySQL = R"(
+        SELECT id, name, number, normalized_number FROM contacts
+        ORDER BY name COLLATE NOCASE LIMIT ? OFFSET ?;
+    )";
+
+    sqlite3_stmt* stmt = prepareStatement(querySQL);
+    if (!stmt) {
+        return page;
+    }
+    sqlite3_bind_int(stmt, 1, limit);
+    sqlite3_bind_int(stmt, 2, offset);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Contact contact;
+        contact.id = sqlite3_column_int(stmt, 0);
+        contact.name = columnText(stmt, 1);
+        contact.number = columnText(stmt, 2);
+        contact.normalizedNumber = columnText(stmt, 3);
+        page.contacts.push_back(contact);
+    }
+    sqlite3_finalize(stmt);
+
+    page.total = countRows("contacts");
+    R_LOG(INFO, "SQLiteDatabase: Retrieved %zu/%d contacts (offset %d)", page.contacts.size(), page.total, offset);
+    return page;
+}
+
+bool SQLiteDatabase::upsertCallHistory(const std::vector<CallHistoryEntry> &entries) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    // The phone only reports its latest entries, so history is merged rather than replaced
+    const std::string upsertSQL = R"(
+        INSERT INTO call_history (name, number, normalized_number, call_type, call_time)
+        VALUES (?, ?, ?, ?, ?)
+        ON CONFLICT(normalized_number, call_type, call_time) DO UPDATE SET
+            name = excluded.name
+        WHERE name != excluded.name;
+    )";
+
+    if (!executeSQL("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    sqlite3_stmt* stmt = prepareStatement(upsertSQL);
+    if (!stmt) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+
+    int inserted = 0;
+    for (const auto& entry : entries) {
+        std::string normalized = normalizeNumber(entry.number);
+        sqlite3_bind_text(stmt, 1, entry.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, entry.number.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, normalized.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, entry.type.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 5, entry.callTime.c_str(), -1, SQLITE_TRANSIENT);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            R_LOG(ERROR, "SQLiteDatabase: Failed to upsert call history entry %s: %s", entry.number.c_str(), sqlite3_errmsg(db_));
+            sqlite3_finalize(stmt);
+            executeSQL("ROLLBACK;");
+            return false;
+        }
+        inserted += sqlite3_changes(db_);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (!executeSQL("COMMIT;")) {
+        executeSQL("ROLLBACK;");
+        return false;
+    }
+
+    R_LOG(INFO, "SQLiteDatabase: Merged %zu call history entries (%d new or changed)", entries.size(), inserted);
+    return true;
+}
+
+CallHistoryPage SQLiteDatabase::getCallHistory(int offset, int limit) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+
+    CallHistoryPage page{{}, 0};
+    const std::string querySQL = R"(
+        SELECT id, name, number, normalized_number, call_type, call_time FROM call_history
+        ORDER BY call_time DESC LIMIT ? OFFSET ?;
+    )";
+
+    sqlite3_stmt* stmt = prepareStatement(querySQL);
+    if (!stmt) {
+        return page;
+    }
+    sqlite3_bind_int(stmt, 1, limit);
+    sqlite3_bind_int(stmt, 2, offset);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        CallHistoryEntry entry;
+        entry.id = sqlite3_column_int(stmt, 0);
+        entry.name = columnText(stmt, 1);
+        entry.number = columnText(stmt, 2);
+        entry.normalizedNumber = columnText(stmt, 3);
+        entry.type = columnText(stmt, 4);
+        entry.callTime = columnText(stmt, 5);
+        page.entries.push_back(entry);
+    }
+    sqlite3_finalize(stmt);
+
+    page.total = countRows("call_history");
+    R_LOG(INFO, "SQLiteDatabase: Retrieved %zu/%d call history entries (offset %d)", page.entries.size(), page.total, offset);
+    return page;
+}
@@ -18,13 +18,6 @@ DBusMessage* CMSenderFactory::makeMsg(DBusCommand cmd) {
             return makeMsg_HangupCall(cmd);
         case DBusCommand::ANSWER_CALL:
             return makeMsg_AnswerCall(cmd);
-        // Record
-        case DBusCommand::START_RECORD:
-            return makeMsg_StartRecord(cmd);
-        case DBusCommand::STOP_RECORD:
-            return makeMsg_StopRecord(cmd);
-        case DBusCommand::CANCEL_RECORD:
-            return makeMsg_CancelRecord(cmd);
         default:
             R_LOG(WARN, "CMSenderFactory makeMsg Error: Unknown DBusCommand");
             return nullptr;
@@ -48,6 +41,15 @@ DBusMessage* CMSenderFactory::makeMsgNoti(DBusCommand cmd, bool isSuccess, const
         return makeMsgNoti_AcceptBTDeviceRequestConfirmation(cmd, isSuccess, msgInfo);
     case DBusCommand::DIAL_CALL:
         return makeMsgNoti_DialCall(cmd, isSuccess, msgInfo);
+    // Record commands carry the capture session id
+    case DBusCommand::START_RECORD:
+        return makeMsgNoti_StartRecord(cmd, isSuccess, msgInfo);
+    case DBusCommand::STOP_RECORD:
+        return makeMsgNoti_StopRecord(cmd, isSuccess, msgInfo);
+    case DBusCommand::CANCEL_RECORD:
+        return makeMsgNoti_CancelRecord(cmd, isSuccess, msgInfo);
+    case DBusCommand::CANCEL_FILTER:
+        return makeMsgNoti_CancelFilter(cmd, isSuccess, msgInfo);
     default:
         R_LOG(WARN, "CMSenderFactory makeMsgNoti Error: Unknown DBusCommand");
         return nullptr;
@@ -169,26 +171,34 @@ DBusMessage* CMSenderFactory::makeMsgNoti_DialCall(DBusCommand cmd, bool isSucce
 }
 
 // Record
-DBusMessage* CMSenderFactory::makeMsg_StartRecord(DBusCommand cmd) {
+DBusMessage* CMSenderFactory::makeMsgNoti_StartRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
     const char* objectPath = "/com/example/recordmanager";
     const char* interfaceName = "com.example.recordmanager.interface";
     const char* signalName = "RecordSignal";
 
-    return makeMsgInternal(objectPath, interfaceName, signalName, cmd);
+    return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
 }
 
-DBusMessage* CMSenderFactory::makeMsg_StopRecord(DBusCommand cmd) {
+DBusMessage* CMSenderFactory::makeMsgNoti_StopRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
     const char* objectPath = "/com/example/recordmanager";
     const char* interfaceName = "com.example.recordmanager.interface";
     const char* signalName = "RecordSignal";
 
-    return makeMsgInternal(objectPath, interfaceName, signalName, cmd);
+    return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
 }
 
-DBusMessage* CMSenderFactory::makeMsg_CancelRecord(DBusCommand cmd) {
+DBusMessage* CMSenderFactory::makeMsgNoti_CancelRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
     const char* objectPath = "/com/example/recordmanager";
     const char* interfaceName = "com.example.recordmanager.interface";
     const char* signalName = "RecordSignal";
 
-    return makeMsgInternal(objectPath, interfaceName, signalName, cmd);
+    return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
+}
+
+DBusMessage* CMSenderFactory::makeMsgNoti_CancelFilter(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
+    const char* objectPath = "/com/example/recordmanager";
+    const char* interfaceName = "com.example.recordmanager.interface";
+    const char* signalName = "RecordSignal";
+
+    return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
 }
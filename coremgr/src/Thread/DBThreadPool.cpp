@@ -1,27 +1,26 @@
 #include "DBThreadPool.hpp"
 #include "SQLiteDatabase.hpp"
 #include "EventQueue.hpp"
+#include "Event.hpp"
+#include "EventTypeId.hpp"
 #include "RLogger.hpp"
 #include "Config.hpp"
 #include <functional>
 #include <future>
+#include <algorithm>
 
-DBThreadPool::DBThreadPool(std::shared_ptr<EventQueue> eventQueue, int numWorkers) 
-    : ThreadBase("DBThreadPool"), eventQueue_(eventQueue) {
-    // Initialize database connection
-    database_ = std::make_shared<SQLiteDatabase>(CONFIG_INSTANCE()->getSQLiteDBFilePath());
-    if (!database_->open()) {
-        R_LOG(ERROR, "DBThreadPool: Failed to open database connection");
-    } else {
-        R_LOG(INFO, "DBThreadPool: Database connection opened successfully");
+namespace {
+    std::chrono::milliseconds readDeadline() {
+        // A read nobody is waiting for anymore is not worth running
+        return std::chrono::milliseconds(CONFIG_INSTANCE()->getDBReadDeadlineMs());
     }
+}
 
-    // Start worker threads
-    for (int i = 0; i < numWorkers; i++) {
-        // Explicitly bind threadFunction to this instance
-        workers_.emplace_back(&DBThreadPool::threadFunction, this);
-    }
-    R_LOG(INFO, "DBThreadPool: Started %d worker threads", numWorkers);
+DBThreadPool::DBThreadPool(std::shared_ptr<EventQueue> eventQueue, int numWorkers) 
+    : ThreadBase("DBThreadPool"), eventQueue_(eventQueue), numWorkers_(numWorkers) {
+    // Opening and migrating happen on the pool thread (see threadFunction) so startup is not blocked;
+    // tasks enqueued meanwhile simply wait in the queue
+    database_ = std::make_shared<SQLiteDatabase>(CONFIG_INSTANCE()->getSQLiteDBFilePath());
 }
 
 DBThreadPool::~DBThreadPool() {
@@ -44,60 +43,263 @@ void DBThreadPool::stop() {
     cv_.notify_all(); // Wake up all worker threads to exit
 }
 
-void DBThreadPool::enqueueTask(std::function<void()> task) {
+void DBThreadPool::enqueueTask(std::function<void()> task, DBTaskLane lane, std::chrono::milliseconds deadline) {
     {
         std::lock_guard<std::mutex> lock(taskMutex_);
         if (!runningFlag_) {
             R_LOG(WARN, "DBThreadPool: Attempted to enqueue task after stop was called");
             return;
         }
-        tasksQueue_.push(std::move(task));
+        auto now = std::chrono::steady_clock::now();
+        auto expiresAt = deadline.count() > 0 ? now + deadline : std::chrono::steady_clock::time_point::max();
+
+        int laneIdx = static_cast<int>(lane);
+        lanes_[laneIdx].push_back({std::move(task), now, expiresAt});
+        DBLaneStats& stats = laneStats_[laneIdx];
+        stats.depth = lanes_[laneIdx].size();
+        stats.maxDepth = std::max(stats.maxDepth, stats.depth);
     }
     cv_.notify_one();
 }
 
+DBLaneStats DBThreadPool::getLaneStats(DBTaskLane lane) {
+    std::lock_guard<std::mutex> lock(taskMutex_);
+    return laneStats_[static_cast<int>(lane)];
+}
+
+bool DBThreadPool::hasRunnableTask() const {
+    if (!lanes_[static_cast<int>(DBTaskLane::INTERACTIVE)].empty()) {
+        return true;
+    }
+    return !lanes_[static_cast<int>(DBTaskLane::BACKGROUND)].empty() && activeBackgroundTasks_ == 0;
+}
+
+// Called with taskMutex_ held
+bool DBThreadPool::popRunnableTask(QueuedTask &task, DBTaskLane &lane) {
+    auto& interactive = lanes_[static_cast<int>(DBTaskLane::INTERACTIVE)];
+    auto& background = lanes_[static_cast<int>(DBTaskLane::BACKGROUND)];
+    const auto now = std::chrono::steady_clock::now();
+    const auto maxBackgroundWait = std::chrono::milliseconds(CONFIG_INSTANCE()->getDBBackgroundMaxWaitMs());
+
+    while (true) {
+        // Background work runs one task at a time, and only when the UI is not waiting,
+        // unless it has already been starved for too long
+        bool backgroundAllowed = !background.empty() && activeBackgroundTasks_ == 0;
+        bool backgroundStarved = backgroundAllowed && (now - background.front().enqueuedAt) > maxBackgroundWait;
+
+        std::deque<QueuedTask>* queue = nullptr;
+        if (!interactive.empty() && !backgroundStarved) {
+            queue = &interactive;
+            lane = DBTaskLane::INTERACTIVE;
+        } else if (backgroundAllowed) {
+            queue = &background;
+            lane = DBTaskLane::BACKGROUND;
+        } else {
+            return false;
+        }
+
+        task = std::move(queue->front());
+        queue->pop_front();
+        DBLaneStats& stats = laneStats_[static_cast<int>(lane)];
+        stats.depth = queue->size();
+
+        if (now > task.deadline) {
+            stats.expired++;
+            R_LOG(WARN, "DBThreadPool: Dropping %s task that waited %lld ms past its deadline",
+                lane == DBTaskLane::INTERACTIVE ? "interactive" : "background",
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(now - task.deadline).count()));
+            task.run = nullptr;     // releases the packaged_task -> caller sees broken_promise
+            continue;
+        }
+
+        if (lane == DBTaskLane::BACKGROUND) {
+            activeBackgroundTasks_++;
+        }
+        return true;
+    }
+}
+
+void DBThreadPool::recordExecuted(DBTaskLane lane, uint64_t waitMs) {
+    DBLaneStats& stats = laneStats_[static_cast<int>(lane)];
+    stats.executed++;
+    stats.totalWaitMs += waitMs;
+    stats.maxWaitMs = std::max(stats.maxWaitMs, waitMs);
+
+    const char* laneName = (lane == DBTaskLane::INTERACTIVE) ? "interactive" : "background";
+    if (waitMs >= CONFIG_INSTANCE()->getDBSlowWaitWarnMs()) {
+        R_LOG(WARN, "DBThreadPool: %s task waited %llu ms in queue", laneName, static_cast<unsigned long long>(waitMs));
+    }
+    if (stats.executed % 100 == 0) {
+        R_LOG(INFO, "DBThreadPool: %s lane: executed=%llu expired=%llu depth=%zu maxDepth=%zu avgWait=%llu ms maxWait=%llu ms",
+            laneName, static_cast<unsigned long long>(stats.executed), static_cast<unsigned long long>(stats.expired),
+            stats.depth, stats.maxDepth, static_cast<unsigned long long>(stats.totalWaitMs / stats.executed),
+            static_cast<unsigned long long>(stats.maxWaitMs));
+    }
+}
+
+void DBThreadPool::runMaintenance(bool fullAnalyze) {
+    if (maintenanceRunning_.exchange(true)) {
+        R_LOG(WARN, "DBThreadPool: Maintenance already in progress, skipping");
+        return;
+    }
+
+    auto run = std::make_shared<MaintenanceRun>();
+    run->report.fullAnalyze = fullAnalyze;
+    run->startedAt = std::chrono::steady_clock::now();
+    enqueueTask([this, run](){ maintenanceStep(run); }, DBTaskLane::BACKGROUND);
+}
+
+DBMaintenanceReport DBThreadPool::getLastMaintenanceReport() {
+    std::lock_guard<std::mutex> lock(taskMutex_);
+    return lastMaintenanceReport_;
+}
+
+void DBThreadPool::maintenanceStep(std::shared_ptr<MaintenanceRun> run) {
+    auto stepStart = std::chrono::steady_clock::now();
+    DBMaintenanceReport& report = run->report;
+    bool finished = false;
+
+    {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        switch (run->stage) {
+            case MaintenanceStage::CHECKPOINT:
+            {
+                if (report.fullAnalyze) {
+                    database_->optimizeFullText();
+                }
+                DBPageStats stats = database_->getPageStats();
+                report.pagesBefore = stats.pageCount;
+                report.freelistBefore = stats.freelistCount;
+                report.pageSize = stats.pageSize;
+                database_->checkpointWal(report.walFrames, report.walCheckpointedFrames);
+                run->stage = MaintenanceStage::VACUUM;
+                break;
+            }
+            case MaintenanceStage::VACUUM:
+            {
+                // One bounded chunk per task so interactive requests get the database in between
+                DBPageStats stats = database_->getPageStats();
+                if (stats.freelistCount > 0 && report.vacuumSteps < CONFIG_INSTANCE()->getDBVacuumMaxSteps()) {
+                    database_->incrementalVacuum(CONFIG_INSTANCE()->getDBVacuumPagesPerStep());
+                    report.vacuumSteps++;
+                } else {
+                    run->stage = MaintenanceStage::ANALYZE;
+                }
+                break;
+            }
+            case MaintenanceStage::ANALYZE:
+            {
+                database_->analyze(report.fullAnalyze);
+                // Vacuumed pages sit in the WAL until checkpointed back into (and truncating) the main file
+                int walFrames = 0;
+                int checkpointed = 0;
+                database_->checkpointWal(walFrames, checkpointed);
+                report.walFrames += walFrames;
+                report.walCheckpointedFrames += checkpointed;
+                DBPageStats stats = database_->getPageStats();
+                report.pagesAfter = stats.pageCount;
+                report.freelistAfter = stats.freelistCount;
+                finished = true;
+                break;
+            }
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    report.busyMs += std::chrono::duration_cast<std::chrono::milliseconds>(now - stepStart).count();
+
+    if (!finished) {
+        enqueueTask([this, run](){ maintenanceStep(run); }, DBTaskLane::BACKGROUND);
+        return;
+    }
+
+    report.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - run->startedAt).count();
+    long long freedPages = report.pagesBefore - report.pagesAfter;
+    R_LOG(INFO, "DBThreadPool: Maintenance done: freed %lld pages (%lld KiB), pages %lld->%lld, freelist %lld->%lld, "
+        "WAL checkpointed %d/%d frames, %d vacuum steps, %s, busy %llu ms, elapsed %llu ms",
+        freedPages, freedPages * report.pageSize / 1024, report.pagesBefore, report.pagesAfter,
+        report.freelistBefore, report.freelistAfter, report.walCheckpointedFrames, report.walFrames,
+        report.vacuumSteps, report.fullAnalyze ? "ANALYZE" : "optimize",
+        static_cast<unsigned long long>(report.busyMs), static_cast<unsigned long long>(report.elapsedMs));
+
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        lastMaintenanceReport_ = report;
+    }
+    maintenanceRunning_ = false;
+}
+
 void DBThreadPool::threadFunction() {
+    R_LOG(INFO, "DBThreadPool: Preparing database");
+
+    if (!database_->open()) {
+        R_LOG(ERROR, "DBThreadPool: Failed to open database connection");
+    } else if (!database_->migrateSchema()) {
+        R_LOG(ERROR, "DBThreadPool: Schema migration failed, continuing with version %d", database_->getSchemaVersion());
+    } else {
+        R_LOG(INFO, "DBThreadPool: Database ready (schema version %d)", database_->getSchemaVersion());
+    }
+
+    // Workers are started even on failure: queued requests must still complete (with an error result)
+    // instead of leaving their callers blocked on the future
+    for (int i = 0; i < numWorkers_; i++) {
+        workers_.emplace_back(&DBThreadPool::workerLoop, this);
+    }
+    R_LOG(INFO, "DBThreadPool: Started %d worker threads", numWorkers_);
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void DBThreadPool::workerLoop() {
     R_LOG(INFO, "DBThreadPool worker thread started");
 
     while (runningFlag_) {
         std::unique_lock<std::mutex> lock(taskMutex_);
-        cv_.wait(lock, [this]{ return !tasksQueue_.empty() || !runningFlag_; });
+        cv_.wait(lock, [this]{ return hasRunnableTask() || !runningFlag_; });
 
         if (!runningFlag_) {
             break;
         }
 
-        if(tasksQueue_.empty()) {
+        QueuedTask task;
+        DBTaskLane lane = DBTaskLane::INTERACTIVE;
+        if (!popRunnableTask(task, lane)) {
             continue;
         }
-
-        auto task = std::move(tasksQueue_.front());
-        tasksQueue_.pop();
+        uint64_t waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - task.enqueuedAt).count();
         lock.unlock();
 
         // Execute the task
         try {
-            task();
+            task.run();
         } catch (const std::exception& e) {
             R_LOG(ERROR, "DBThreadPool: Exception in worker thread: %s", e.what());
         }
+
+        lock.lock();
+        recordExecuted(lane, waitMs);
+        if (lane == DBTaskLane::BACKGROUND) {
+            activeBackgroundTasks_--;
+            cv_.notify_one();   // the next background task may now run
+        }
     }
 
     R_LOG(INFO, "DBThreadPool worker thread exiting");
 }
 
-std::future<AudioRecord> DBThreadPool::insertAudioRecord(const std::string& filePath, int durationSec) {
-    auto task = std::make_shared<std::packaged_task<AudioRecord()>>([this, filePath, durationSec]() {
-        AudioRecord record;
-        record.filePath = filePath;
-        record.durationSec = durationSec;
-
+std::future<AudioRecord> DBThreadPool::insertAudioRecord(const AudioRecord& record) {
+    auto task = std::make_shared<std::packaged_task<AudioRecord()>>([this, record]() {
         std::lock_guard<std::mutex> dbLock(dbMutex_);
         AudioRecord newRecord = database_->insertAudioRecord(record);
         if (newRecord.id == -1) {
             R_LOG(ERROR, "DBThreadPool: Failed to insert audio record into database");
         } else {
-            R_LOG(INFO, "DBThreadPool: Audio record inserted successfully: %s", filePath.c_str());
+            R_LOG(INFO, "DBThreadPool: Audio record inserted successfully: %s (%s)", record.filePath.c_str(), record.codec.c_str());
         }
         return newRecord;
     });
@@ -116,7 +318,18 @@ std::future<std::vector<AudioRecord>> DBThreadPool::getAllAudioRecords() {
     });
 
     auto future = task->get_future();
-    enqueueTask([task](){ (*task)(); });
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::INTERACTIVE, readDeadline());
+    return future;
+}
+
+std::future<AudioRecord> DBThreadPool::getAudioRecord(int recordId) {
+    auto task = std::make_shared<std::packaged_task<AudioRecord()>>([this, recordId]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        return database_->getAudioRecord(recordId);
+    });
+
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::INTERACTIVE, readDeadline());
     return future;
 }
 
@@ -137,11 +350,81 @@ std::future<std::string> DBThreadPool::removeAudioRecord(int recordId) {
     return future;
 }
 
+std::future<AudioRecord> DBThreadPool::updateAudioRecordInfo(int recordId, std::optional<std::string> title, std::optional<std::string> tags) {
+    auto task = std::make_shared<std::packaged_task<AudioRecord()>>([this, recordId, title = std::move(title), tags = std::move(tags)]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        return database_->updateAudioRecordInfo(recordId, title, tags);
+    });
+
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); });
+    return future;
+}
+
+std::future<SearchResult> DBThreadPool::search(const std::string& query, bool includeRecords, bool includeContacts, int limit) {
+    auto task = std::make_shared<std::packaged_task<SearchResult()>>([this, query, includeRecords, includeContacts, limit]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        return database_->search(query, includeRecords, includeContacts, limit);
+    });
 
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::INTERACTIVE, readDeadline());
+    return future;
+}
 
+std::future<bool> DBThreadPool::syncContacts(std::vector<Contact> contacts) {
+    auto task = std::make_shared<std::packaged_task<bool()>>([this, contacts = std::move(contacts)]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        bool ok = database_->syncContacts(contacts, true);
+        if (!ok) {
+            R_LOG(ERROR, "DBThreadPool: Failed to sync %zu contacts into database", contacts.size());
+        }
+        // Background lane: nobody blocks on the future, completion is reported as an event
+        eventQueue_->pushEvent(std::make_shared<Event>(EventTypeID::CONTACTS_SYNCED_NOTI,
+            std::make_shared<NotiPayload>(ok, ok ? "Contacts updated" : "Failed to store contacts")));
+        return ok;
+    });
 
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::BACKGROUND);
+    return future;
+}
 
+std::future<ContactPage> DBThreadPool::getContacts(int offset, int limit) {
+    auto task = std::make_shared<std::packaged_task<ContactPage()>>([this, offset, limit]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        return database_->getContacts(offset, limit);
+    });
 
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::INTERACTIVE, readDeadline());
+    return future;
+}
 
+std::future<bool> DBThreadPool::upsertCallHistory(std::vector<CallHistoryEntry> entries) {
+    auto task = std::make_shared<std::packaged_task<bool()>>([this, entries = std::move(entries)]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        bool ok = database_->upsertCallHistory(entries);
+        if (!ok) {
+            R_LOG(ERROR, "DBThreadPool: Failed to merge %zu call history entries into database", entries.size());
+        }
+        eventQueue_->pushEvent(std::make_shared<Event>(EventTypeID::CALL_HISTORY_SYNCED_NOTI,
+            std::make_shared<NotiPayload>(ok, ok ? "Call history updated" : "Failed to store call history")));
+        return ok;
+    });
+
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::BACKGROUND);
+    return future;
+}
 
+std::future<CallHistoryPage> DBThreadPool::getCallHistory(int offset, int limit) {
+    auto task = std::make_shared<std::packaged_task<CallHistoryPage()>>([this, offset, limit]() {
+        std::lock_guard<std::mutex> dbLock(dbMutex_);
+        return database_->getCallHistory(offset, limit);
+    });
 
+    auto future = task->get_future();
+    enqueueTask([task](){ (*task)(); }, DBTaskLane::INTERACTIVE, readDeadline());
+    return future;
+}
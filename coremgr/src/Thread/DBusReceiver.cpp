@@ -4,7 +4,10 @@
 #include "Event.hpp"
 #include "EventTypeId.hpp"
 #include "EventQueue.hpp"
+#include "DBusHex.hpp"
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 DBusReceiver::DBusReceiver(std::shared_ptr<EventQueue> eventQueue) : 
     DBusReceiverBase(
@@ -24,8 +27,10 @@ void DBusReceiver::handleMessage(DBusCommand cmd) {
 
 void DBusReceiver::handleMessageNoti(DBusCommand cmd, bool isSuccess, const DBusDataInfo &dataInfo) {
     // TODO : Payload for Noti Msg
-    R_LOG(INFO, "DBusReceiver handling notification: cmd=%d, isSuccess=%d, msgInfo=%s",
-            static_cast<int>(cmd), isSuccess, dataInfo.data[DBUS_DATA_MESSAGE].c_str());
+    if (cmd != DBusCommand::RECORD_LEVEL_NOTI) {  // 10 per second while recording, too chatty to log
+        R_LOG(INFO, "DBusReceiver handling notification: cmd=%d, isSuccess=%d, msgInfo=%s",
+                static_cast<int>(cmd), isSuccess, dataInfo.data[DBUS_DATA_MESSAGE].c_str());
+    }
     switch (cmd) {
         // From Hardware Manager Service
         case DBusCommand::UPDATE_TEMPERATURE_NOTI: {
@@ -302,39 +307,67 @@ void DBusReceiver::handleMessageNoti(DBusCommand cmd, bool isSuccess, const DBus
         // From Record Manager Service
         case DBusCommand::START_RECORD_NOTI: {
             R_LOG(INFO, "Dispatching START_RECORD_NOTI from DBus");
-            std::shared_ptr<Payload> payload = std::make_shared<NotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE]);
+            std::shared_ptr<Payload> payload = std::make_shared<RecordNotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE],
+                                                    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID]);
             auto event = std::make_shared<Event>(EventTypeID::START_RECORD_NOTI, payload);
             eventQueue_->pushEvent(event);
             break;
         }
         case DBusCommand::STOP_RECORD_NOTI: {
             R_LOG(INFO, "Dispatching STOP_RECORD_NOTI from DBus");
-            std::shared_ptr<Payload> payload = std::make_shared<NotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE]);
+            std::shared_ptr<Payload> payload = std::make_shared<RecordStopPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE],
+                                                    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID],
+                                                    dataInfo.data[DBUS_DATA_STOP_REASON],
+                                                    std::stoi(dataInfo.data[DBUS_DATA_WAV_FILE_DURATION_SEC]),
+                                                    std::stoi(dataInfo.data[DBUS_DATA_RECORD_FILE_COUNT]));
             auto event = std::make_shared<Event>(EventTypeID::STOP_RECORD_NOTI, payload);
             eventQueue_->pushEvent(event);
             break;
         }
         case DBusCommand::CANCEL_RECORD_NOTI: {
             R_LOG(INFO, "Dispatching CANCEL_RECORD_NOTI from DBus");
-            std::shared_ptr<Payload> payload = std::make_shared<NotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE]);
+            std::shared_ptr<Payload> payload = std::make_shared<RecordNotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE],
+                                                    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID]);
             auto event = std::make_shared<Event>(EventTypeID::CANCEL_RECORD_NOTI, payload);
             eventQueue_->pushEvent(event);
             break;
         }
         case DBusCommand::FILTER_WAV_FILE_NOTI: {
             R_LOG(INFO, "Dispatching FILTER_WAV_FILE_NOTI from DBus");
-            std::shared_ptr<Payload> payload = std::make_shared<NotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE]);
+            std::shared_ptr<Payload> payload = std::make_shared<RecordNotiPayload>(isSuccess, dataInfo.data[DBUS_DATA_MESSAGE],
+                                                    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID]);
             auto event = std::make_shared<Event>(EventTypeID::FILTER_WAV_FILE_NOTI, payload);
             
             if (isSuccess) {
                 std::shared_ptr<Payload> payload2 = std::make_shared<WavPayload>(dataInfo.data[DBUS_DATA_WAV_FILE_PATH], 
-                                                    std::stoi(dataInfo.data[DBUS_DATA_WAV_FILE_DURATION_SEC]));
+                                                    std::stoi(dataInfo.data[DBUS_DATA_WAV_FILE_DURATION_SEC]), false,
+                                                    dataInfo.data[DBUS_DATA_AUDIO_CODEC],
+                                                    std::stoi(dataInfo.data[DBUS_DATA_AUDIO_BITRATE]),
+                                                    DBusHex::toBytes(dataInfo.data[DBUS_DATA_PEAKS_THUMBNAIL]),
+                                                    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID]);
                 auto event2 = std::make_shared<Event>(EventTypeID::INSERT_WAV_FILE, payload2);
                 eventQueue_->pushEvent(event2);
             }
             eventQueue_->pushEvent(event);
             break;
         }
+        case DBusCommand::RECORD_LEVEL_NOTI: {
+            // Waveform arrives as hex, one byte per point
+            std::shared_ptr<Payload> payload = std::make_shared<RecordLevelPayload>(dataInfo.data[DBUS_DATA_RECORD_SESSION_ID],
+                std::stof(dataInfo.data[DBUS_DATA_LEVEL_RMS_DBFS]), std::stof(dataInfo.data[DBUS_DATA_LEVEL_PEAK_DBFS]),
+                DBusHex::toBytes(dataInfo.data[DBUS_DATA_LEVEL_WAVEFORM]));
+            auto event = std::make_shared<Event>(EventTypeID::RECORD_LEVEL_NOTI, payload);
+            eventQueue_->pushEvent(event);
+            break;
+        }
+        case DBusCommand::FILTER_PROGRESS_NOTI: {
+            std::shared_ptr<Payload> payload = std::make_shared<FilterProgressPayload>(
+                std::stoi(dataInfo.data[DBUS_DATA_FILTER_JOB_ID]), dataInfo.data[DBUS_DATA_WAV_FILE_PATH],
+                std::stoi(dataInfo.data[DBUS_DATA_FILTER_PROGRESS]));
+            auto event = std::make_shared<Event>(EventTypeID::FILTER_PROGRESS_NOTI, payload);
+            eventQueue_->pushEvent(event);
+            break;
+        }
 
         default:
             R_LOG(WARN, "DBusReceiver received unknown DBusCommand");
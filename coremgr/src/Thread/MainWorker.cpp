@@ -10,6 +10,7 @@
 #include "RecordHandler.hpp"
 #include "DBThreadPool.hpp"
 #include "SQLiteDBHandler.hpp"
+#include "Config.hpp"
 
 MainWorker::MainWorker(std::shared_ptr<EventQueue> eventQueue) 
     : ThreadBase("MainWorker"), eventQueue_(eventQueue) {
@@ -65,6 +66,7 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
     switch (event->getEventTypeId()) {
         case EventTypeID::STARTUP:
             // TODO: bip bip speaker by hardwareHandler_->()
+            sqliteDBHandler_->scheduleMaintenance(CONFIG_INSTANCE()->getDBMaintenanceFirstDelayMs());
             break;
         // Hardware
         case EventTypeID::START_SCAN_BTDEVICE:
@@ -153,21 +155,27 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
             break;
         case EventTypeID::PBAP_PHONEBOOK_PULL_START_NOTI:
             hardwareHandler_->pbapPhonebookPullStartNOTI(payload);
+            sqliteDBHandler_->beginContactSync(payload);
             break;
         case EventTypeID::PBAP_PHONEBOOK_PULL_NOTI:
             hardwareHandler_->pbapPhonebookPullNOTI(payload);
+            sqliteDBHandler_->bufferContact(payload);
             break;
         case EventTypeID::PBAP_PHONEBOOK_PULL_END_NOTI:
             hardwareHandler_->pbapPhonebookPullEndNOTI(payload);
+            sqliteDBHandler_->commitContactSync(payload);
             break;
         case EventTypeID::CALL_HISTORY_PULL_START_NOTI:
             hardwareHandler_->callHistoryPullStartNOTI(payload);
+            sqliteDBHandler_->beginCallHistorySync(payload);
             break;
         case EventTypeID::CALL_HISTORY_PULL_NOTI:
             hardwareHandler_->callHistoryPullNOTI(payload);
+            sqliteDBHandler_->bufferCallHistory(payload);
             break;
         case EventTypeID::CALL_HISTORY_PULL_END_NOTI:
             hardwareHandler_->callHistoryPullEndNOTI(payload);
+            sqliteDBHandler_->commitCallHistorySync(payload);
             break;
         case EventTypeID::INCOMING_CALL_NOTI:
             hardwareHandler_->incomingCallNOTI(payload);
@@ -177,9 +185,11 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
             break;
         case EventTypeID::CALL_STATE_CHANGED_NOTI:
             hardwareHandler_->callStateChangedNOTI(payload);
+            recordHandler_->followCallState();
             break;
         case EventTypeID::CALL_ENDED_NOTI:
             hardwareHandler_->callEndedNOTI(payload);
+            recordHandler_->followCallState();
             break;
         case EventTypeID::DIAL_CALL_NOTI:
             hardwareHandler_->dialCallNOTI(payload);
@@ -193,13 +203,16 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
         
         // Record
         case EventTypeID::START_RECORD:
-            recordHandler_->startRecord();
+            recordHandler_->startRecord(payload);
             break;
         case EventTypeID::STOP_RECORD:
-            recordHandler_->stopRecord();
+            recordHandler_->stopRecord(payload);
             break;
         case EventTypeID::CANCEL_RECORD:
-            recordHandler_->cancelRecord();
+            recordHandler_->cancelRecord(payload);
+            break;
+        case EventTypeID::CANCEL_FILTER:
+            recordHandler_->cancelFilter(payload);
             break;
         case EventTypeID::REMOVE_RECORD:
             sqliteDBHandler_->removeAudioRecord(payload);
@@ -207,6 +220,12 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
         case EventTypeID::GET_ALL_RECORD:
             sqliteDBHandler_->getAllAudioRecords();
             break;
+        case EventTypeID::UPDATE_RECORD:
+            sqliteDBHandler_->updateAudioRecord(payload);
+            break;
+        case EventTypeID::GET_RECORD_PEAKS:
+            sqliteDBHandler_->getRecordPeaks(payload);
+            break;
         case EventTypeID::INSERT_WAV_FILE:
             sqliteDBHandler_->insertAudioRecord(payload);
             break;
@@ -222,6 +241,32 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
         case EventTypeID::FILTER_WAV_FILE_NOTI:
             recordHandler_->filterWavFileNOTI(payload);
             break;
+        case EventTypeID::RECORD_LEVEL_NOTI:
+            recordHandler_->recordLevelNOTI(payload);
+            break;
+        case EventTypeID::FILTER_PROGRESS_NOTI:
+            recordHandler_->filterProgressNOTI(payload);
+            break;
+
+        // Database
+        case EventTypeID::GET_CONTACTS:
+            sqliteDBHandler_->getContacts(payload);
+            break;
+        case EventTypeID::GET_CALL_HISTORY:
+            sqliteDBHandler_->getCallHistory(payload);
+            break;
+        case EventTypeID::SEARCH:
+            sqliteDBHandler_->search(payload);
+            break;
+        case EventTypeID::CONTACTS_SYNCED_NOTI:
+            sqliteDBHandler_->contactsSyncedNOTI(payload);
+            break;
+        case EventTypeID::CALL_HISTORY_SYNCED_NOTI:
+            sqliteDBHandler_->callHistorySyncedNOTI(payload);
+            break;
+        case EventTypeID::DB_MAINTENANCE:
+            sqliteDBHandler_->runMaintenanceIfIdle();
+            break;
         
         default:
             R_LOG(WARN, "MainWorker received unknown event type");
@@ -88,6 +88,14 @@ namespace {
         CANCEL_RECORD,
         REMOVE_RECORD,
         GET_ALL_RECORD,
+        UPDATE_RECORD,
+        GET_RECORD_PEAKS,
+        CANCEL_FILTER,
+
+        // Database
+        GET_CONTACTS,
+        GET_CALL_HISTORY,
+        SEARCH,
         UNKNOWN
     };
 
@@ -113,6 +121,14 @@ namespace {
         if (commandStr == "cancel_record") return CommandType::CANCEL_RECORD;
         if (commandStr == "remove_record") return CommandType::REMOVE_RECORD;
         if (commandStr == "get_all_record") return CommandType::GET_ALL_RECORD;
+        if (commandStr == "update_record") return CommandType::UPDATE_RECORD;
+        if (commandStr == "get_record_peaks") return CommandType::GET_RECORD_PEAKS;
+        if (commandStr == "cancel_filter") return CommandType::CANCEL_FILTER;
+
+        // Database
+        if (commandStr == "get_contacts") return CommandType::GET_CONTACTS;
+        if (commandStr == "get_call_history") return CommandType::GET_CALL_HISTORY;
+        if (commandStr == "search") return CommandType::SEARCH;
         return CommandType::UNKNOWN;
     }
 }
@@ -214,14 +230,17 @@ std::shared_ptr<Event> WebSocket::translateMsg(const std::string& message, const
 
         // Record
         case CommandType::START_RECORD:
-            event = std::make_shared<Event>(EventTypeID::START_RECORD);
-            break;
         case CommandType::STOP_RECORD:
-            event = std::make_shared<Event>(EventTypeID::STOP_RECORD);
-            break;
         case CommandType::CANCEL_RECORD:
-            event = std::make_shared<Event>(EventTypeID::CANCEL_RECORD);
+        {
+            // { "session_id": "headset" } (optional, recordmgr's default microphone when missing)
+            std::shared_ptr<Payload> payload = std::make_shared<RecordSessionPayload>(
+                data.value("session_id", std::string(DEFAULT_RECORD_SESSION_ID)));
+            const EventTypeID type = cmd == CommandType::START_RECORD ? EventTypeID::START_RECORD
+                                   : cmd == CommandType::STOP_RECORD ? EventTypeID::STOP_RECORD : EventTypeID::CANCEL_RECORD;
+            event = std::make_shared<Event>(type, payload);
             break;
+        }
         case CommandType::REMOVE_RECORD:
         {
             // { "id": 1234567890 }
@@ -235,6 +254,68 @@ std::shared_ptr<Event> WebSocket::translateMsg(const std::string& message, const
         case CommandType::GET_ALL_RECORD:
             event = std::make_shared<Event>(EventTypeID::GET_ALL_RECORD);
             break;
+        case CommandType::UPDATE_RECORD:
+        {
+            // { "id": 12, "title": "Meeting", "tags": "work weekly" } (title/tags optional)
+            auto recordIdOpt = JSON_HELPER_INSTANCE()->getIntField(data, "id");
+            if (recordIdOpt) {
+                std::optional<std::string> title;
+                std::optional<std::string> tags;
+                if (data.contains("title")) title = JSON_HELPER_INSTANCE()->getStringField(data, "title");
+                if (data.contains("tags")) tags = JSON_HELPER_INSTANCE()->getStringField(data, "tags");
+                std::shared_ptr<Payload> payload = std::make_shared<RecordInfoPayload>(*recordIdOpt, title, tags);
+                event = std::make_shared<Event>(EventTypeID::UPDATE_RECORD, payload);
+            }
+            break;
+        }
+        case CommandType::GET_RECORD_PEAKS:
+        {
+            // { "id": 12, "points": 800 } (points optional)
+            auto recordIdOpt = JSON_HELPER_INSTANCE()->getIntField(data, "id");
+            if (recordIdOpt) {
+                std::shared_ptr<Payload> payload = std::make_shared<RecordPeaksPayload>(*recordIdOpt,
+                    data.value("points", CONFIG_INSTANCE()->getPeaksDefaultPoints()));
+                event = std::make_shared<Event>(EventTypeID::GET_RECORD_PEAKS, payload);
+            }
+            break;
+        }
+        case CommandType::CANCEL_FILTER:
+        {
+            // { "job_id": 3 } (0 or missing = every queued and running job)
+            std::shared_ptr<Payload> payload = std::make_shared<FilterJobPayload>(data.value("job_id", 0));
+            event = std::make_shared<Event>(EventTypeID::CANCEL_FILTER, payload);
+            break;
+        }
+
+        // Database
+        case CommandType::GET_CONTACTS:
+        {
+            // { "offset": 0, "limit": 50 } (both optional)
+            std::shared_ptr<Payload> payload = std::make_shared<PagePayload>(data.value("offset", 0),
+                data.value("limit", CONFIG_INSTANCE()->getDBPageDefaultLimit()));
+            event = std::make_shared<Event>(EventTypeID::GET_CONTACTS, payload);
+            break;
+        }
+        case CommandType::GET_CALL_HISTORY:
+        {
+            // { "offset": 0, "limit": 50 } (both optional)
+            std::shared_ptr<Payload> payload = std::make_shared<PagePayload>(data.value("offset", 0),
+                data.value("limit", CONFIG_INSTANCE()->getDBPageDefaultLimit()));
+            event = std::make_shared<Event>(EventTypeID::GET_CALL_HISTORY, payload);
+            break;
+        }
+        case CommandType::SEARCH:
+        {
+            // { "query": "meeting", "scope": "all" | "records" | "contacts", "limit": 20 } (scope/limit optional)
+            auto queryOpt = JSON_HELPER_INSTANCE()->getStringField(data, "query");
+            if (queryOpt) {
+                std::shared_ptr<Payload> payload = std::make_shared<SearchPayload>(*queryOpt,
+                    data.value("scope", std::string("all")),
+                    data.value("limit", CONFIG_INSTANCE()->getSearchDefaultLimit()));
+                event = std::make_shared<Event>(EventTypeID::SEARCH, payload);
+            }
+            break;
+        }
         case CommandType::UNKNOWN:
         default:
             R_LOG(WARN, "Unknown command received: %s", message.c_str());
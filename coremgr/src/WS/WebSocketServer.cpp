@@ -35,9 +35,28 @@ void WebSocketSession::doAccept(){
     doRead();
 }
 
+namespace {
+    // Binary frames queued per client before new ones are dropped
+    constexpr size_t MAX_BINARY_BACKLOG = 4;
+}
+
 void WebSocketSession::send(const std::string& message) {
+    enqueue({message, false});
+}
+
+void WebSocketSession::sendBinary(const std::string& frame) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (message_queue_.size() >= MAX_BINARY_BACKLOG) {
+            return;
+        }
+    }
+    enqueue({frame, true});
+}
+
+void WebSocketSession::enqueue(OutMessage message) {
     std::lock_guard<std::mutex> lock(queue_mutex_);
-    message_queue_.push(message);
+    message_queue_.push(std::move(message));
 
     // If not already writing, start the write loop
     if (!writing_) {
@@ -52,8 +71,9 @@ void WebSocketSession::doWrite() {
     // No need to lock queue_mutex_ here because access is serialized by the strand.
     
     // Send the next message in the queue
+    ws_.binary(message_queue_.front().binary);
     ws_.async_write(
-        asio::buffer(message_queue_.front()),
+        asio::buffer(message_queue_.front().data),
         [self = shared_from_this()](beast::error_code ec, std::size_t /*bytes_transferred*/) {
             // Always pop the message from the queue after the write operation completes.
             std::lock_guard<std::mutex> lock(self->queue_mutex_);
@@ -154,6 +174,13 @@ void WebSocketServer::broadcast(const std::string& message) {
     }
 }
 
+void WebSocketServer::broadcastBinary(const std::string& frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& session : sessions_) {
+        session->sendBinary(frame);
+    }
+}
+
 void WebSocketServer::doAccept(){
     acceptor_.async_accept(
         [this](beast::error_code ec, tcp::socket socket)
@@ -198,10 +225,12 @@ void WebSocketServer::sendInitStateToClient(std::shared_ptr<WebSocketSession> se
     session->send(message);
 
     // Send current record state
+    const std::vector<std::string> recordingSessions = STATE_VIEW_INSTANCE()->getRecordSessionsIn(RecordState::RECORDING);
     jsonData["msg"] = "initial_state";
     jsonData["component"] = "Record";
     jsonData["data"] = {
-        {"is_recording", STATE_VIEW_INSTANCE()->RECORD_STATE == RecordState::RECORDING ? true : false}
+        {"is_recording", !recordingSessions.empty()},
+        {"recording_sessions", recordingSessions}
     };
     status_msg["data"] = jsonData;
     message = status_msg.dump();
@@ -0,0 +1,135 @@
+#include "FakePcmSource.hpp"
+#include "WavReader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace {
+    template <typename T>
+    void putSample(uint8_t *dst, T value) { memcpy(dst, &value, sizeof(value)); }
+
+    int32_t quantize(float v, double scale, double lo, double hi) {
+        return static_cast<int32_t>(std::clamp(std::llround(static_cast<double>(v) * scale),
+                                               static_cast<long long>(lo), static_cast<long long>(hi)));
+    }
+}
+
+FakePcmSource::FakePcmSource(const DeviceFormat &device, unsigned int outRate, unsigned int outChannels, size_t periodFrames)
+    : device_(device), periodFrames_(std::max<size_t>(periodFrames, 1)), converter_(outRate, outChannels) {
+    converter_.configure(device_.format, device_.rate, device_.channels, periodFrames_);
+}
+
+void FakePcmSource::setFixture(const std::vector<float> &frames) {
+    const size_t channels = std::max(device_.channels, 1u);
+    const size_t sampleBytes = PcmConverter::sampleBytes(device_.format);
+    fixtureFrames_ = frames.size() / channels;
+    bytes_.assign(fixtureFrames_ * channels * sampleBytes, 0);
+    position_ = 0;
+
+    uint8_t *dst = bytes_.data();
+    for (size_t i = 0; i < fixtureFrames_ * channels; ++i, dst += sampleBytes) {
+        const float v = frames[i];
+        switch (device_.format) {
+            case SND_PCM_FORMAT_S16_LE:
+                putSample(dst, static_cast<int16_t>(quantize(v, 32768.0, -32768.0, 32767.0)));
+                break;
+            case SND_PCM_FORMAT_S24_LE:
+                putSample(dst, quantize(v, 8388608.0, -8388608.0, 8388607.0));
+                break;
+            case SND_PCM_FORMAT_S32_LE:
+                putSample(dst, quantize(v, 2147483648.0, -2147483648.0, 2147483647.0));
+                break;
+            default:
+                putSample(dst, v);
+                break;
+        }
+    }
+    converter_.reset();
+}
+
+std::vector<float> FakePcmSource::syntheticSpeech(unsigned int rate, unsigned int channels, double seconds, uint32_t seed) {
+    const double pi = std::acos(-1.0);
+    const size_t frames = static_cast<size_t>(seconds * rate);
+    std::vector<float> out(frames * channels);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    double phase = 0.0;
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(i) / rate;
+        // 2 s phrases of 250 ms syllables, then 1 s of room noise
+        const double inPhrase = std::fmod(t, 3.0);
+        double envelope = 0.0;
+        if (inPhrase < 2.0) {
+            const double s = std::sin(pi * std::fmod(inPhrase, 0.25) / 0.25);
+            envelope = s * s;
+        }
+        const double f0 = 120.0 + 30.0 * std::sin(2.0 * pi * 0.7 * t);
+        phase += 2.0 * pi * f0 / rate;
+        double voiced = 0.0;
+        for (int k = 1; k <= 8; ++k) {
+            voiced += std::sin(k * phase) / k;
+        }
+        const float speech = static_cast<float>(0.25 * envelope * voiced);
+        for (unsigned int c = 0; c < channels; ++c) {
+            out[i * channels + c] = speech * (1.0f - 0.1f * c) + 0.002f * noise(rng);
+        }
+    }
+    return out;
+}
+
+bool FakePcmSource::loadWav(const std::string &filePath, std::vector<float> &frames, unsigned int &rate, unsigned int &channels) {
+    WavReader reader;
+    if (!reader.open(filePath)) {
+        return false;
+    }
+    rate = reader.getSampleRate();
+    channels = reader.getChannels();
+    frames.clear();
+    frames.reserve(static_cast<size_t>(reader.getTotalSamples()));
+    std::vector<int16_t> block(4096 * std::max(channels, 1u));
+    size_t n;
+    while ((n = reader.read(block.data(), block.size())) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            frames.push_back(block[i] * (1.0f / 32768.0f));
+        }
+    }
+    return !frames.empty();
+}
+
+bool FakePcmSource::captureOnce(PcmSink &sink, snd_pcm_uframes_t &framesRead) {
+    framesRead = 0;
+    // Same contract as a wakeup or a poll timeout on the real device
+    if (woken_.exchange(false) || fixtureFrames_ == 0 || isFinished()) {
+        return true;
+    }
+
+    if (realtime_) {
+        const auto now = std::chrono::steady_clock::now();
+        if (nextPeriod_ == std::chrono::steady_clock::time_point()) {
+            nextPeriod_ = now;
+        }
+        std::this_thread::sleep_until(nextPeriod_);
+        nextPeriod_ += std::chrono::nanoseconds(static_cast<int64_t>(periodFrames_ * 1000000000ull / device_.rate));
+    }
+
+    // What a real capture thread spends per period: conversion plus every sink downstream
+    const auto workStart = std::chrono::steady_clock::now();
+    size_t frames = periodFrames_;
+    if (totalFrames_ > 0) {
+        frames = static_cast<size_t>(std::min<uint64_t>(frames, totalFrames_ - servedFrames_));
+    }
+    const size_t frameBytes = converter_.getFrameBytes();
+    while (frames > 0) {
+        // The fixture wraps like the mmap ring: two deliveries when a period straddles the end
+        const size_t chunk = std::min(frames, fixtureFrames_ - position_);
+        framesRead += converter_.deliver(sink, bytes_.data() + position_ * frameBytes, chunk);
+        position_ = (position_ + chunk) % fixtureFrames_;
+        servedFrames_ += chunk;
+        frames -= chunk;
+    }
+    lastWork_ = std::chrono::steady_clock::now() - workStart;
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef FAKE_PCM_SOURCE_HPP_
+#define FAKE_PCM_SOURCE_HPP_
+
+#include "PcmSource.hpp"
+#include "PcmConverter.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Stands in for AlsaHelper without a sound card: serves a fixture period by period as
+// if it came from a device in the given format, through the same PcmConverter as the
+// real capture path. The fixture is encoded to device bytes once, so captureOnce() only
+// hands out pointers into it, like the mmap area. Loops until totalFrames are served.
+class FakePcmSource : public PcmSource {
+    public:
+        struct DeviceFormat {
+            snd_pcm_format_t format = SND_PCM_FORMAT_S16_LE;
+            unsigned int rate = 16000;
+            unsigned int channels = 1;
+        };
+
+        FakePcmSource(const DeviceFormat &device, unsigned int outRate, unsigned int outChannels, size_t periodFrames);
+
+        // Interleaved float frames at the device rate and channel count, full scale = 1.0
+        void setFixture(const std::vector<float> &frames);
+        // Speech-like bursts (harmonics with a moving pitch and syllable envelope), pauses
+        // and a noise floor; deterministic for a given seed
+        static std::vector<float> syntheticSpeech(unsigned int rate, unsigned int channels, double seconds, uint32_t seed);
+        // 16-bit WAV recording, e.g. a real microphone take. Returns false when it cannot be read
+        static bool loadWav(const std::string &filePath, std::vector<float> &frames, unsigned int &rate, unsigned int &channels);
+
+        // Device frames to serve in total (the fixture repeats), 0 = forever
+        void setTotalFrames(uint64_t totalFrames) { totalFrames_ = totalFrames; }
+        // Sleep until each period is due, like a real device; otherwise serve as fast as asked
+        void setRealtime(bool realtime) { realtime_ = realtime; }
+
+        // One period per call
+        bool captureOnce(PcmSink &sink, snd_pcm_uframes_t &framesRead) override;
+        void wakeup() override { woken_ = true; }
+
+        bool isFinished() const { return totalFrames_ > 0 && servedFrames_ >= totalFrames_; }
+        uint64_t getServedFrames() const { return servedFrames_; }
+        // Time the last captureOnce() spent delivering, without the realtime wait
+        std::chrono::nanoseconds getLastWork() const { return lastWork_; }
+        const PcmConverter &getConverter() const { return converter_; }
+
+    private:
+        const DeviceFormat device_;
+        const size_t periodFrames_;
+        PcmConverter converter_;
+        std::vector<uint8_t> bytes_;        // fixture in the device format
+        size_t fixtureFrames_ = 0;
+        size_t position_ = 0;               // next fixture frame
+        uint64_t totalFrames_ = 0;
+        uint64_t servedFrames_ = 0;
+        bool realtime_ = false;
+        std::chrono::steady_clock::time_point nextPeriod_;
+        std::chrono::nanoseconds lastWork_{0};
+        std::atomic<bool> woken_{false};
+};
+
+#endif // FAKE_PCM_SOURCE_HPP_
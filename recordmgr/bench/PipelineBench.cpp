@@ -0,0 +1,444 @@
+// pipelinebench: the recording pipeline without a sound card. A fake PCM source serves a
+// fixture (synthetic speech, or a WAV take) in a device format through the same
+// PcmConverter as AlsaHelper, and each stage reports throughput, heap allocations and
+// per-block latency percentiles:
+//   capture   device format -> S16/resample -> SPSC ring, the capture thread's share
+//   filter    FilterChain on FILTER_BLOCK_SAMPLES blocks
+//   encode    every compiled-in codec
+//   pipeline  capture -> AudioWriter (ring, streaming filter, VAD, encoder) -> file
+// Exit code is non-zero when the capture thread allocates after warm-up, the ring
+// overruns, a stage fails or the capture p99 is over --max-p99-us.
+//
+//   cmake -S . -B build -DRECORDMGR_BUILD_BENCH=ON
+//   cmake --build build --target pipelinebench && ./build/pipelinebench [options]
+//     --seconds N            audio per stage (default 60)
+//     --fixture take.wav     16-bit WAV instead of synthetic speech
+//     --format s16|s24|s32|float  --rate HZ  --channels N   device (default s32 48000 2)
+//     --period FRAMES        device period (default 1024)
+//     --realtime             pace the pipeline stage like a real device
+//     --out DIR              where the encode/pipeline stages write (default /tmp)
+//     --max-p99-us N         capture latency budget
+
+#include "FakePcmSource.hpp"
+#include "PcmRingBuffer.hpp"
+#include "FilterChain.hpp"
+#include "AudioSink.hpp"
+#include "AudioWriter.hpp"
+#include "Config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every heap allocation in the process is counted, per thread and in total
+namespace {
+    thread_local uint64_t t_allocs = 0;
+    std::atomic<uint64_t> g_allocs{0};
+    std::atomic<uint64_t> g_allocBytes{0};
+}
+
+void *operator new(size_t size) {
+    ++t_allocs;
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+// Out of line, or GCC pairs the inlined free() with operator new and warns about a mismatch
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t WARMUP_BLOCKS = 16;    // scratch buffers grow to size on the first blocks
+
+    struct Options {
+        double seconds = 60.0;
+        std::string fixture;
+        FakePcmSource::DeviceFormat device{SND_PCM_FORMAT_S32_LE, 48000, 2};
+        size_t periodFrames = 1024;
+        bool realtime = false;
+        std::string outDir = "/tmp";
+        double maxP99Us = 0.0;
+    };
+
+    // Per-block latencies, storage reserved up front so recording one does not allocate
+    class Latency {
+        public:
+            explicit Latency(size_t blocks) { ns_.reserve(blocks); }
+            void add(Clock::duration d) {
+                if (ns_.size() < ns_.capacity()) {
+                    ns_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+                }
+            }
+            double percentileUs(double p) {
+                if (ns_.empty()) return 0.0;
+                const size_t i = std::min(ns_.size() - 1, static_cast<size_t>(p / 100.0 * ns_.size()));
+                std::nth_element(ns_.begin(), ns_.begin() + i, ns_.end());
+                return ns_[i] / 1000.0;
+            }
+            void print() {
+                printf("    per block  p50 %8.1f us  p90 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f  (%zu blocks)\n",
+                       percentileUs(50), percentileUs(90), percentileUs(99), percentileUs(99.9), percentileUs(100),
+                       ns_.size());
+            }
+
+        private:
+            std::vector<int64_t> ns_;
+    };
+
+    struct StageResult {
+        double audioSec = 0.0;
+        double workSec = 0.0;
+        uint64_t allocs = 0;
+        uint64_t steadyAllocs = 0;
+    };
+
+    void report(const char *stage, const StageResult &r) {
+        printf("%-10s %9.1f x realtime   allocs %llu (%llu after warm-up)\n", stage,
+               r.workSec > 0.0 ? r.audioSec / r.workSec : 0.0,
+               static_cast<unsigned long long>(r.allocs), static_cast<unsigned long long>(r.steadyAllocs));
+    }
+
+    // Stands in for the writer: the capture thread's ring plus an inline consumer
+    class RingSink : public PcmSink {
+        public:
+            RingSink(size_t capacity, unsigned int channels) : ring_(capacity), channels_(channels), drain_(capacity) {}
+            void onPcm(const int16_t *samples, size_t frames) override {
+                ring_.write(samples, frames * channels_, channels_);
+            }
+            void drain() { while (ring_.read(drain_.data(), drain_.size()) > 0) {} }
+            PcmRingStats getStats() const { return ring_.getStats(); }
+
+        private:
+            PcmRingBuffer ring_;
+            unsigned int channels_;
+            std::vector<int16_t> drain_;
+    };
+
+    class CollectSink : public PcmSink {
+        public:
+            CollectSink(std::vector<int16_t> &out, unsigned int channels) : out_(out), channels_(channels) {}
+            void onPcm(const int16_t *samples, size_t frames) override {
+                out_.insert(out_.end(), samples, samples + frames * channels_);
+            }
+
+        private:
+            std::vector<int16_t> &out_;
+            unsigned int channels_;
+    };
+
+    bool parseFormat(const char *name, snd_pcm_format_t &format) {
+        if (!strcmp(name, "s16")) format = SND_PCM_FORMAT_S16_LE;
+        else if (!strcmp(name, "s24")) format = SND_PCM_FORMAT_S24_LE;
+        else if (!strcmp(name, "s32")) format = SND_PCM_FORMAT_S32_LE;
+        else if (!strcmp(name, "float")) format = SND_PCM_FORMAT_FLOAT_LE;
+        else return false;
+        return true;
+    }
+
+    bool parseArgs(int argc, char **argv, Options &opt) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string key = argv[i];
+            if (key == "--realtime") {
+                opt.realtime = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                fprintf(stderr, "missing value for %s\n", key.c_str());
+                return false;
+            }
+            const char *value = argv[++i];
+            if (key == "--seconds") opt.seconds = atof(value);
+            else if (key == "--fixture") opt.fixture = value;
+            else if (key == "--rate") opt.device.rate = static_cast<unsigned int>(atoi(value));
+            else if (key == "--channels") opt.device.channels = static_cast<unsigned int>(atoi(value));
+            else if (key == "--period") opt.periodFrames = static_cast<size_t>(atoi(value));
+            else if (key == "--out") opt.outDir = value;
+            else if (key == "--max-p99-us") opt.maxP99Us = atof(value);
+            else if (key == "--format") {
+                if (!parseFormat(value, opt.device.format)) {
+                    fprintf(stderr, "unknown format %s\n", value);
+                    return false;
+                }
+            } else {
+                fprintf(stderr, "unknown option %s\n", key.c_str());
+                return false;
+            }
+        }
+        return opt.seconds > 0.0 && opt.device.rate > 0 && opt.device.channels > 0 && opt.periodFrames > 0;
+    }
+
+    std::unique_ptr<FakePcmSource> makeSource(const Options &opt, const std::vector<float> &fixture,
+                                              unsigned int rate, unsigned int channels) {
+        auto source = std::make_unique<FakePcmSource>(opt.device, rate, channels, opt.periodFrames);
+        source->setFixture(fixture);
+        source->setTotalFrames(static_cast<uint64_t>(opt.seconds * opt.device.rate));
+        return source;
+    }
+
+    // Conversion and the ring write, what the capture thread does per period
+    bool benchCapture(const Options &opt, const std::vector<float> &fixture, unsigned int rate, unsigned int channels) {
+        std::unique_ptr<FakePcmSource> source = makeSource(opt, fixture, rate, channels);
+        RingSink sink(static_cast<size_t>(rate) * channels, channels);
+        const size_t periods = static_cast<size_t>(opt.seconds * opt.device.rate / opt.periodFrames) + 1;
+        Latency latency(periods);
+        StageResult r;
+
+        const uint64_t allocsBefore = t_allocs;
+        uint64_t steadyFrom = allocsBefore;
+        uint64_t outFrames = 0;
+        for (size_t n = 0; !source->isFinished(); ++n) {
+            if (n == WARMUP_BLOCKS) {
+                steadyFrom = t_allocs;
+            }
+            snd_pcm_uframes_t frames = 0;
+            source->captureOnce(sink, frames);
+            outFrames += frames;
+            latency.add(source->getLastWork());
+            r.workSec += std::chrono::duration<double>(source->getLastWork()).count();
+            sink.drain();
+        }
+        r.allocs = t_allocs - allocsBefore;
+        r.steadyAllocs = t_allocs - steadyFrom;
+        r.audioSec = static_cast<double>(outFrames) / rate;
+
+        const PcmConverter &conv = source->getConverter();
+        char label[64];
+        snprintf(label, sizeof(label), "%s%s", conv.isPassthrough() ? "passthrough" : "convert",
+                 conv.isResampling() ? "+resample" : "");
+        report("capture", r);
+        printf("    %u Hz %u ch -> %u Hz %u ch, %s, %llu frames out\n", opt.device.rate, opt.device.channels,
+               rate, channels, label, static_cast<unsigned long long>(outFrames));
+        latency.print();
+
+        bool ok = true;
+        if (r.steadyAllocs > 0) {
+            printf("    FAIL: capture path allocates after warm-up\n");
+            ok = false;
+        }
+        if (sink.getStats().overruns > 0) {
+            printf("    FAIL: ring overruns\n");
+            ok = false;
+        }
+        if (opt.maxP99Us > 0.0 && latency.percentileUs(99) > opt.maxP99Us) {
+            printf("    FAIL: p99 over %.1f us\n", opt.maxP99Us);
+            ok = false;
+        }
+        return ok;
+    }
+
+    void benchFilter(const std::vector<int16_t> &pcm, unsigned int rate, unsigned int channels, size_t block) {
+        FilterChain chain(FilterChain::defaultParams(rate, channels));
+        std::vector<int16_t> out;
+        Latency latency(pcm.size() / block + 1);
+        StageResult r;
+
+        const uint64_t allocsBefore = t_allocs;
+        uint64_t steadyFrom = allocsBefore;
+        size_t n = 0;
+        for (size_t pos = 0; pos < pcm.size(); pos += block, ++n) {
+            if (n == WARMUP_BLOCKS) {
+                steadyFrom = t_allocs;
+            }
+            const auto start = Clock::now();
+            chain.process(pcm.data() + pos, std::min(block, pcm.size() - pos), out);
+            const auto elapsed = Clock::now() - start;
+            latency.add(elapsed);
+            r.workSec += std::chrono::duration<double>(elapsed).count();
+        }
+        chain.flush(out);
+        r.allocs = t_allocs - allocsBefore;
+        r.steadyAllocs = t_allocs - steadyFrom;
+        r.audioSec = static_cast<double>(pcm.size()) / channels / rate;
+
+        report("filter", r);
+        latency.print();
+    }
+
+    bool benchEncode(const Options &opt, const std::vector<int16_t> &pcm, unsigned int rate, unsigned int channels, size_t block) {
+        bool ok = true;
+        for (AudioCodec codec : {AudioCodec::WAV, AudioCodec::FLAC, AudioCodec::OPUS}) {
+            if (!AudioSink::isSupported(codec)) {
+                printf("%-10s %s not compiled in\n", "encode", AudioSink::codecName(codec));
+                continue;
+            }
+            std::unique_ptr<AudioSink> sink = AudioSink::create(codec);
+            const std::string path = opt.outDir + "/pipelinebench_encode" + AudioSink::fileExtension(codec);
+            if (!sink->open(path, rate, channels)) {
+                printf("%-10s %s: FAIL: cannot open %s\n", "encode", AudioSink::codecName(codec), path.c_str());
+                ok = false;
+                continue;
+            }
+
+            Latency latency(pcm.size() / block + 1);
+            StageResult r;
+            const uint64_t allocsBefore = t_allocs;
+            uint64_t steadyFrom = allocsBefore;
+            size_t n = 0;
+            bool written = true;
+            for (size_t pos = 0; pos < pcm.size() && written; pos += block, ++n) {
+                if (n == WARMUP_BLOCKS) {
+                    steadyFrom = t_allocs;
+                }
+                const auto start = Clock::now();
+                written = sink->write(pcm.data() + pos, std::min(block, pcm.size() - pos));
+                const auto elapsed = Clock::now() - start;
+                latency.add(elapsed);
+                r.workSec += std::chrono::duration<double>(elapsed).count();
+            }
+            const auto closeStart = Clock::now();
+            written = sink->close() && written;
+            r.workSec += std::chrono::duration<double>(Clock::now() - closeStart).count();
+            r.allocs = t_allocs - allocsBefore;
+            r.steadyAllocs = t_allocs - steadyFrom;
+            r.audioSec = static_cast<double>(pcm.size()) / channels / rate;
+
+            const std::string stage = std::string("encode ") + AudioSink::codecName(codec);
+            report(stage.c_str(), r);
+            printf("    %llu bytes, %u bit/s\n", static_cast<unsigned long long>(sink->getBytesWritten()), sink->getBitrate());
+            latency.print();
+            if (!written) {
+                printf("    FAIL: write error\n");
+                ok = false;
+            }
+            remove(path.c_str());
+        }
+        return ok;
+    }
+
+    // The whole chain with the writer thread behind the ring, as RecordWorker runs it
+    bool benchPipeline(const Options &opt, const std::vector<float> &fixture, unsigned int rate, unsigned int channels) {
+        std::unique_ptr<FakePcmSource> source = makeSource(opt, fixture, rate, channels);
+        source->setRealtime(opt.realtime);
+        AudioWriter writer("bench", channels);
+        writer.run();
+
+        const AudioCodec codec = AudioSink::configuredCodec();
+        const std::string path = opt.outDir + "/pipelinebench" + AudioSink::fileExtension(codec);
+        const bool filterStreaming = CONFIG_INSTANCE()->isStreamingFilterEnabled();
+        if (!writer.beginSession(path, rate, channels, filterStreaming, codec)) {
+            printf("%-10s FAIL: cannot start a session on %s\n", "pipeline", path.c_str());
+            writer.stop();
+            writer.join();
+            return false;
+        }
+
+        const size_t periods = static_cast<size_t>(opt.seconds * opt.device.rate / opt.periodFrames) + 1;
+        Latency latency(periods);
+        StageResult r;
+        const size_t highMark = writer.getRingStats().capacity / 2;
+        const auto wallStart = Clock::now();
+        const uint64_t allocsBefore = t_allocs;
+        uint64_t steadyFrom = allocsBefore;
+        uint64_t outFrames = 0;
+        for (size_t n = 0; !source->isFinished(); ++n) {
+            if (n == WARMUP_BLOCKS) {
+                steadyFrom = t_allocs;
+            }
+            // Faster than realtime the writer would fall behind by design; wait for it
+            // instead of measuring overruns a real device cannot cause
+            while (!opt.realtime && writer.getRingStats().fill > highMark) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            snd_pcm_uframes_t frames = 0;
+            source->captureOnce(writer, frames);
+            outFrames += frames;
+            latency.add(source->getLastWork());
+        }
+        const uint64_t captureAllocs = t_allocs - allocsBefore;
+        const uint64_t steadyAllocs = t_allocs - steadyFrom;
+
+        const auto endStart = Clock::now();
+        std::vector<AudioFileInfo> files;
+        const bool ended = writer.endSession(files);
+        const double endSec = std::chrono::duration<double>(Clock::now() - endStart).count();
+        r.workSec = std::chrono::duration<double>(Clock::now() - wallStart).count();
+        const PcmRingStats stats = writer.getRingStats();
+        writer.stop();
+        writer.join();
+
+        r.audioSec = static_cast<double>(outFrames) / rate;
+        r.allocs = captureAllocs;
+        r.steadyAllocs = steadyAllocs;
+        report("pipeline", r);
+        printf("    %s, filter %s, ring high water %zu/%zu, endSession %.1f ms, %.1f MB allocated in total\n",
+               AudioSink::codecName(codec), filterStreaming ? "streaming" : "off", stats.highWater, stats.capacity,
+               endSec * 1000.0, g_allocBytes.load() / 1e6);
+        for (const AudioFileInfo &file : files) {
+            printf("    %s  %llu frames  %llu bytes\n", file.filePath.c_str(),
+                   static_cast<unsigned long long>(file.frames), static_cast<unsigned long long>(file.bytes));
+        }
+        latency.print();
+
+        bool ok = true;
+        if (!ended) {
+            printf("    FAIL: endSession\n");
+            ok = false;
+        }
+        if (steadyAllocs > 0) {
+            printf("    FAIL: capture thread allocates after warm-up\n");
+            ok = false;
+        }
+        if (stats.overruns > 0) {
+            printf("    FAIL: %llu ring overruns, %llu samples dropped\n", static_cast<unsigned long long>(stats.overruns),
+                   static_cast<unsigned long long>(stats.droppedSamples));
+            ok = false;
+        }
+        return ok;
+    }
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        fprintf(stderr, "usage: %s [--seconds N] [--fixture take.wav] [--format s16|s24|s32|float] [--rate HZ]"
+                        " [--channels N] [--period FRAMES] [--realtime] [--out DIR] [--max-p99-us N]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<float> fixture;
+    if (!opt.fixture.empty()) {
+        // A take plays back in its own rate and channel count, only the sample format is simulated
+        if (!FakePcmSource::loadWav(opt.fixture, fixture, opt.device.rate, opt.device.channels)) {
+            fprintf(stderr, "cannot read %s\n", opt.fixture.c_str());
+            return 2;
+        }
+    } else {
+        fixture = FakePcmSource::syntheticSpeech(opt.device.rate, opt.device.channels, 9.0, 1);
+    }
+
+    const unsigned int rate = CONFIG_INSTANCE()->getSampleRate();
+    const unsigned int channels = std::max(CONFIG_INSTANCE()->getCaptureChannels(), 1u);
+    const size_t block = std::max<size_t>(CONFIG_INSTANCE()->getFilterBlockSamples() / channels, 1) * channels;
+    printf("fixture %s, %.0f s per stage, device period %zu frames\n",
+           opt.fixture.empty() ? "synthetic speech" : opt.fixture.c_str(), opt.seconds, opt.periodFrames);
+
+    bool ok = benchCapture(opt, fixture, rate, channels);
+
+    // Filter and encoders work on what the capture stage delivers
+    std::vector<int16_t> pcm;
+    {
+        std::unique_ptr<FakePcmSource> source = makeSource(opt, fixture, rate, channels);
+        CollectSink collect(pcm, channels);
+        snd_pcm_uframes_t frames = 0;
+        while (!source->isFinished()) {
+            source->captureOnce(collect, frames);
+        }
+    }
+    benchFilter(pcm, rate, channels, block);
+    ok = benchEncode(opt, pcm, rate, channels, block) && ok;
+    ok = benchPipeline(opt, fixture, rate, channels) && ok;
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -2,10 +2,26 @@
 #define CONFIG_HPP_
 
 #include "IConfig.hpp"
+#include "Define.hpp"
 #include <alsa/asoundlib.h>
+#include <algorithm>
+#include <vector>
 
 #define CONFIG_INSTANCE() Config::getInstance()
 
+// One independent capture session: its own PCM, capture thread, ring and writer
+struct RecordSessionConfig {
+    std::string id;         // DBUS_DATA_RECORD_SESSION_ID
+    std::string device;     // ALSA PCM name, "" = first capture card found
+    std::string callDevice; // far end of a phone call (HFP/SCO capture PCM), "" = microphone only
+    bool callStereo = false;    // microphone left, far end right; otherwise both mixed into every channel
+
+    // The stereo call layout records a mono microphone
+    unsigned int micChannels() const;
+    // Channels of a recording with the far end in it
+    unsigned int callChannels() const { return callStereo ? micChannels() + 1 : micChannels(); }
+};
+
 class Config {
     public:
         static Config *getInstance() {
@@ -22,11 +38,62 @@ class Config {
         const std::string &getSignalName() const { return RECORDMGR_SIGNAL_NAME;}
 
         unsigned int getSampleRate() const { return SAMPLE_RATE; }
+        unsigned int getCaptureChannels() const { return CAPTURE_CHANNELS; }
+        const std::string &getCaptureSampleFormat() const { return CAPTURE_SAMPLE_FORMAT; }
+        bool isInProcessResampleEnabled() const { return IN_PROCESS_RESAMPLE_ENABLED; }
         snd_pcm_uframes_t getFramesPerPeriod() const { return FRAMES_PER_PERIOD; }
         const std::string &getMicrophoneDevice() const { return MICROPHONE_DEVICE; }
+        const std::vector<RecordSessionConfig> &getRecordSessions() const { return RECORD_SESSIONS; }
         unsigned int getMaxRecordDurationSec() const { return MAX_RECORD_DURATION_SEC; }
         const std::string &getWavOutputDir() const { return WAV_OUTPUT_DIR; }
         const std::string &getFilteredAudioDir() const { return FILTERED_AUDIO_DIR; }
+        const std::string &getStagingDir() const { return STAGING_DIR; }
+        float getFilterHighPassHz() const { return FILTER_HIGHPASS_HZ; }
+        float getFilterLowPassHz() const { return FILTER_LOWPASS_HZ; }
+        unsigned int getNoiseProfileMs() const { return NOISE_PROFILE_MS; }
+        size_t getNoiseGateFrameSize() const { return NOISE_GATE_FRAME_SIZE; }
+        float getNoiseGateThreshold() const { return NOISE_GATE_THRESHOLD; }
+        float getNoiseGateFloorGain() const { return NOISE_GATE_FLOOR_GAIN; }
+        float getNoiseGateRelease() const { return NOISE_GATE_RELEASE; }
+        size_t getFilterBlockSamples() const { return FILTER_BLOCK_SAMPLES; }
+        bool isStreamingFilterEnabled() const { return STREAMING_FILTER_ENABLED; }
+        unsigned int getFilterWorkerCount() const { return FILTER_WORKER_COUNT; }
+        size_t getFilterQueueCapacity() const { return FILTER_QUEUE_CAPACITY; }
+        unsigned int getFilterProgressStepPercent() const { return FILTER_PROGRESS_STEP_PERCENT; }
+        const std::string &getRecordCodec() const { return RECORD_CODEC; }
+        unsigned int getFlacCompressionLevel() const { return FLAC_COMPRESSION_LEVEL; }
+        unsigned int getOpusBitrate() const { return OPUS_BITRATE; }
+        unsigned int getPeakBaseFrames() const { return PEAK_BASE_FRAMES; }
+        unsigned int getPeakLevelFactor() const { return PEAK_LEVEL_FACTOR; }
+        unsigned int getPeakThumbnailPoints() const { return PEAK_THUMBNAIL_POINTS; }
+        bool isVadEnabled() const { return VAD_ENABLED; }
+        bool isVadTrimEnabled() const { return VAD_TRIM_SILENCE; }
+        unsigned int getVadSplitSilenceMs() const { return VAD_SPLIT_SILENCE_MS; }
+        unsigned int getVadAutoStopSilenceMs() const { return VAD_AUTO_STOP_SILENCE_MS; }
+        unsigned int getVadMarginMs() const { return VAD_MARGIN_MS; }
+        unsigned int getVadMaxHoldMs() const { return VAD_MAX_HOLD_MS; }
+        unsigned int getVadFrameMs() const { return VAD_FRAME_MS; }
+        float getVadThresholdDb() const { return VAD_THRESHOLD_DB; }
+        float getVadMinSpeechDbfs() const { return VAD_MIN_SPEECH_DBFS; }
+        unsigned int getVadHangoverMs() const { return VAD_HANGOVER_MS; }
+        unsigned int getCaptureWaitTimeoutMs() const { return CAPTURE_WAIT_TIMEOUT_MS; }
+        bool isCaptureRealtimeEnabled() const { return CAPTURE_REALTIME_ENABLED; }
+        int getCaptureRtPriority() const { return CAPTURE_RT_PRIORITY; }
+        int getCaptureCpu() const { return CAPTURE_CPU; }
+        bool isLockMemoryEnabled() const { return LOCK_MEMORY_ENABLED; }
+        size_t getCapturePrefaultStackBytes() const { return CAPTURE_PREFAULT_STACK_BYTES; }
+        bool isPcmWarmModeEnabled() const { return PCM_WARM_MODE_ENABLED; }
+        bool isPreRollEnabled() const { return PREROLL_ENABLED; }
+        unsigned int getPreRollMs() const { return PREROLL_MS; }
+        unsigned int getPreRollRetryMs() const { return PREROLL_RETRY_MS; }
+        unsigned int getPcmRingCapacityMs() const { return PCM_RING_CAPACITY_MS; }
+        unsigned int getWriterWakeIntervalMs() const { return WRITER_WAKE_INTERVAL_MS; }
+        unsigned int getRecoverySyncIntervalMs() const { return RECOVERY_SYNC_INTERVAL_MS; }
+        bool isLevelNotiEnabled() const { return LEVEL_NOTI_ENABLED; }
+        unsigned int getLevelNotiIntervalMs() const { return LEVEL_NOTI_INTERVAL_MS; }
+        unsigned int getWaveformPointsPerSec() const { return WAVEFORM_POINTS_PER_SEC; }
+        unsigned int getCallAudioJitterMs() const { return CALL_AUDIO_JITTER_MS; }
+        unsigned int getCallAudioRetryMs() const { return CALL_AUDIO_RETRY_MS; }
 
     private:
         Config() = default;
@@ -39,16 +106,122 @@ class Config {
         inline static const std::string RECORDMGR_INTERFACE_NAME = "com.example.recordmanager.interface";
         inline static const std::string RECORDMGR_SIGNAL_NAME = "RecordSignal";
 
+        // Rate and channel count of the recordings. The device format is negotiated when the
+        // PCM opens and converted in-process when the card cannot deliver this exactly
         inline static const unsigned int SAMPLE_RATE = 16000;
+        inline static const unsigned int CAPTURE_CHANNELS = 1;
+        inline static const std::string CAPTURE_SAMPLE_FORMAT = "s16";   // preferred device format: "s16", "s24", "s32", "float"
+        // Open hw: instead of plughw: so rate conversion runs in our Resampler, not in alsa-lib
+        inline static const bool IN_PROCESS_RESAMPLE_ENABLED = true;
         inline static const snd_pcm_uframes_t FRAMES_PER_PERIOD = 1024;
-        inline static const unsigned int MAX_RECORD_DURATION_SEC = 300; // 5 minutes
+        inline static const unsigned int MAX_RECORD_DURATION_SEC = 3600; // 1 hour, audio is streamed to disk so RAM use does not grow with it
 #ifdef RASPBERRY_PI
         inline static const std::string MICROPHONE_DEVICE = "plughw:1,0"; // card 1 device 0
 #else
         inline static const std::string MICROPHONE_DEVICE = "plughw:0,0"; // For laptops or other systems
 #endif
-        inline static const std::string WAV_OUTPUT_DIR = "/tmp";
+        // Sessions can record at the same time, each from its own device. Commands without a
+        // session id go to DEFAULT_RECORD_SESSION_ID. Only one session may use the card scan (""),
+        // e.g. add {"headset", "bluealsa:DEV=00:00:00:00:00:00,PROFILE=sco"} for a Bluetooth headset.
+        // callDevice (e.g. "bluealsa:DEV=<phone>,PROFILE=sco") is tapped only for the call recording
+        // coremgr starts with CALL_RECORD_ENABLED (DBUS_DATA_RECORD_CALL_AUDIO); none by default
+        inline static const std::vector<RecordSessionConfig> RECORD_SESSIONS = {
+            {DEFAULT_RECORD_SESSION_ID, "", "", false},
+        };
+        // Recordings in progress (*.part + *.journal) until the filter step moves them out.
+        // Not /tmp: it is cleared at boot, which would defeat the crash recovery
+        inline static const std::string WAV_OUTPUT_DIR = "/var/local/recordmanager/spool";
         inline static const std::string FILTERED_AUDIO_DIR = "/var/local/recordmanager/audio";
+        // Filter pass output; on the same filesystem as FILTERED_AUDIO_DIR so finishing is a rename
+        inline static const std::string STAGING_DIR = "/var/local/recordmanager/audio/.staging";
+
+        // In-process filter chain (replaces "sox highpass 100 lowpass 3000 noisered prof 0.21")
+        inline static const float FILTER_HIGHPASS_HZ = 100.0f;
+        inline static const float FILTER_LOWPASS_HZ = 3000.0f;
+        inline static const unsigned int NOISE_PROFILE_MS = 400;         // leading audio used as the noise profile
+        inline static const size_t NOISE_GATE_FRAME_SIZE = 512;          // 32 ms at 16 kHz
+        inline static const float NOISE_GATE_THRESHOLD = 2.0f;           // bins below 2x the profile are gated
+        inline static const float NOISE_GATE_FLOOR_GAIN = 0.25f;         // -12 dB on gated bins
+        inline static const float NOISE_GATE_RELEASE = 0.6f;
+        inline static const size_t FILTER_BLOCK_SAMPLES = 4096;
+        // Run the filter chain on the capture stream so the file is final when recording stops.
+        // false = record raw and filter the whole file after STOP_RECORD
+        inline static const bool STREAMING_FILTER_ENABLED = true;
+        // Filter/store jobs run on a worker pool, newest recording first
+        inline static const unsigned int FILTER_WORKER_COUNT = 0;          // 0 = CPU cores - 1 (at least 1)
+        inline static const size_t FILTER_QUEUE_CAPACITY = 8;              // jobs waiting for the filter; beyond that the oldest is stored unfiltered
+        inline static const unsigned int FILTER_PROGRESS_STEP_PERCENT = 10;
+
+        // Output codec: "wav", "flac" (lossless) or "opus" (speech). Falls back to wav when
+        // the encoder library was not found at build time
+        inline static const std::string RECORD_CODEC = "flac";
+        inline static const unsigned int FLAC_COMPRESSION_LEVEL = 5;
+        inline static const unsigned int OPUS_BITRATE = 24000;          // bits/s, plenty for 16 kHz mono speech
+
+        // Waveform summary stored next to each recording (<file>.peaks) plus a thumbnail for the DB
+        inline static const unsigned int PEAK_BASE_FRAMES = 256;        // 16 ms per point at 16 kHz
+        inline static const unsigned int PEAK_LEVEL_FACTOR = 4;
+        inline static const unsigned int PEAK_THUMBNAIL_POINTS = 100;
+
+        // Voice activity detection on the (filtered) stream in AudioWriter, needed by trimming,
+        // splitting and auto-stop
+        inline static const bool VAD_ENABLED = false;
+        inline static const bool VAD_TRIM_SILENCE = false;              // cut leading/trailing silence down to VAD_MARGIN_MS, a take without speech is kept whole
+        inline static const unsigned int VAD_SPLIT_SILENCE_MS = 0;      // start a new file after a pause this long, 0 = off (implies trimming)
+        inline static const unsigned int VAD_AUTO_STOP_SILENCE_MS = 0;  // stop recording after this much silence, 0 = off
+        inline static const unsigned int VAD_MARGIN_MS = 300;           // silence kept around speech
+        inline static const unsigned int VAD_MAX_HOLD_MS = 10000;       // longer pauses inside speech are written as they are
+        inline static const unsigned int VAD_FRAME_MS = 20;
+        inline static const float VAD_THRESHOLD_DB = 9.0f;              // above the tracked noise floor
+        inline static const float VAD_MIN_SPEECH_DBFS = -50.0f;
+        inline static const unsigned int VAD_HANGOVER_MS = 300;
+
+        // Upper bound for one poll() on the PCM; stop/cancel wake it up immediately
+        inline static const unsigned int CAPTURE_WAIT_TIMEOUT_MS = 500;
+        // Capture threads run SCHED_FIFO so filtering, logging and D-Bus cannot delay a period
+        // into an ALSA overrun. Needs LimitRTPRIO/LimitMEMLOCK in recordmanager.service;
+        // without them the thread stays SCHED_OTHER and a warning is logged
+        inline static const bool CAPTURE_REALTIME_ENABLED = true;
+        inline static const int CAPTURE_RT_PRIORITY = 70;              // above the writer/filter threads, below the IRQ threads
+#ifdef RASPBERRY_PI
+        inline static const int CAPTURE_CPU = 3;                       // keep it free with isolcpus=3 in /boot/cmdline.txt
+#else
+        inline static const int CAPTURE_CPU = -1;                      // no pinning
+#endif
+        // mlockall(MCL_CURRENT) when the first capture thread starts; pages mapped later
+        // (other threads' stacks, heap growth) are not locked
+        inline static const bool LOCK_MEMORY_ENABLED = false;
+        inline static const size_t CAPTURE_PREFAULT_STACK_BYTES = 256 * 1024;
+        // Keep the capture PCM open and prepared between sessions so START_RECORD only has to
+        // start it. The device stays claimed while idle, so other users of the card get EBUSY
+        inline static const bool PCM_WARM_MODE_ENABLED = false;
+        // Capture continuously while idle and keep the last PREROLL_MS in RAM (never on disk);
+        // START_RECORD prepends it, so speech from before the click is not lost.
+        // Costs one wakeup per period while idle and keeps the card claimed
+        inline static const bool PREROLL_ENABLED = false;
+        inline static const unsigned int PREROLL_MS = 2000;             // well below PCM_RING_CAPACITY_MS
+        inline static const unsigned int PREROLL_RETRY_MS = 5000;       // reopen delay when idle capture fails
+
+        // Capture -> writer ring, sized to ride out long SD card stalls
+        inline static const unsigned int PCM_RING_CAPACITY_MS = 10000;
+        inline static const unsigned int WRITER_WAKE_INTERVAL_MS = 200;
+        // Header/journal sync of the file being recorded; a crash loses at most this much
+        inline static const unsigned int RECOVERY_SYNC_INTERVAL_MS = 5000;
+
+        // Live input level for the dashboard, published as RECORD_LEVEL_NOTI while recording
+        inline static const bool LEVEL_NOTI_ENABLED = true;
+        inline static const unsigned int LEVEL_NOTI_INTERVAL_MS = 100;
+        inline static const unsigned int WAVEFORM_POINTS_PER_SEC = 50;  // one peak per 20 ms
+
+        // Far end of a call, captured on its own thread and mixed into the microphone stream.
+        // Only reads the SCO PCM: BlueALSA must allow several clients on it (multi-client mode),
+        // so the call audio path keeps its own stream and gets no extra latency
+        inline static const unsigned int CALL_AUDIO_JITTER_MS = 60;     // far end buffered before mixing (re)starts
+        inline static const unsigned int CALL_AUDIO_RETRY_MS = 500;     // SCO comes up shortly after the call is answered
 };
 
+inline unsigned int RecordSessionConfig::micChannels() const {
+    return !callDevice.empty() && callStereo ? 1 : std::max(CONFIG_INSTANCE()->getCaptureChannels(), 1u);
+}
+
 #endif // CONFIG_HPP_
\ No newline at end of file
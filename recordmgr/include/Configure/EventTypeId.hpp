@@ -11,6 +11,7 @@ enum class EventTypeID {
     CANCEL_RECORD,
 
     FILTER_WAV_FILE,
+    CANCEL_FILTER,
 
     MAX
 };
@@ -19,6 +19,8 @@ class RMSenderFactory : public ISenderFactory {
         DBusMessage* makeMsgNoti_StopRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
         DBusMessage* makeMsgNoti_CancelRecord(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
         DBusMessage* makeMsgNoti_FilterWavFile(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
+        DBusMessage* makeMsgNoti_RecordLevel(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
+        DBusMessage* makeMsgNoti_FilterProgress(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo);
 
 };
 
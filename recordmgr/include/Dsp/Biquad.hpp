@@ -0,0 +1,32 @@
+#ifndef BIQUAD_HPP_
+#define BIQUAD_HPP_
+
+#include "DspKernels.hpp"
+#include <cstddef>
+
+// Second-order IIR section, transposed direct form II.
+// Coefficients follow the RBJ audio EQ cookbook, the same 2-pole responses sox uses
+// for "highpass"/"lowpass" (Q = 0.707 by default).
+class Biquad {
+    public:
+        using Coefficients = BiquadCoefficients;
+
+        static Coefficients highPass(float sampleRate, float cutoffHz, float q = 0.70710678f);
+        static Coefficients lowPass(float sampleRate, float cutoffHz, float q = 0.70710678f);
+
+        Biquad() = default;
+        explicit Biquad(const Coefficients &coefficients) : c_(coefficients) {}
+
+        void process(float *samples, size_t count) { DspKernels::biquad(c_, state_, samples, count); }
+        // first then second, pipelined through the vector kernel
+        static void processPair(Biquad &first, Biquad &second, float *samples, size_t count) {
+            DspKernels::biquadPair(first.c_, first.state_, second.c_, second.state_, samples, count);
+        }
+        void reset() { state_ = BiquadState(); }
+
+    private:
+        Coefficients c_;
+        BiquadState state_;
+};
+
+#endif // BIQUAD_HPP_
@@ -0,0 +1,55 @@
+#ifndef DSP_KERNELS_HPP_
+#define DSP_KERNELS_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+// Inner loops of the audio path, with NEON / AVX2 / SSE2 versions picked at compile time
+// and a scalar reference. Every vector version produces bit-identical output to the
+// scalar one (same operation order per sample, no FMA contraction, integer metering),
+// which the dspbench target checks.
+
+struct BiquadCoefficients {
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
+    float a1 = 0.0f, a2 = 0.0f;     // a0 normalized to 1
+};
+
+struct BiquadState {
+    float z1 = 0.0f;
+    float z2 = 0.0f;
+};
+
+struct PcmLevels {
+    uint64_t sumSquares = 0;    // sum of sample^2, exact
+    int32_t peak = 0;           // max |sample|, 0..32768
+    size_t count = 0;
+
+    double rms() const;         // 0..1 full scale
+    double rmsDbfs() const;     // floored at -120 dBFS for digital silence
+    double peakDbfs() const;
+};
+
+namespace DspKernels {
+    // Name of the instruction set the dispatching functions use: "neon", "avx2", "sse2" or "scalar"
+    const char *isaName();
+
+    void int16ToFloat(const int16_t *in, float *out, size_t count);     // scaled to [-1, 1)
+    void floatToInt16(const float *in, int16_t *out, size_t count);     // rounded, saturated
+    void biquad(const BiquadCoefficients &c, BiquadState &s, float *samples, size_t count);
+    // Two cascaded sections (first then second), run side by side in two vector lanes
+    void biquadPair(const BiquadCoefficients &c0, BiquadState &s0,
+                    const BiquadCoefficients &c1, BiquadState &s1, float *samples, size_t count);
+    PcmLevels measureLevels(const int16_t *in, size_t count);
+
+    // Reference implementations, always compiled
+    namespace scalar {
+        void int16ToFloat(const int16_t *in, float *out, size_t count);
+        void floatToInt16(const float *in, int16_t *out, size_t count);
+        void biquad(const BiquadCoefficients &c, BiquadState &s, float *samples, size_t count);
+        void biquadPair(const BiquadCoefficients &c0, BiquadState &s0,
+                        const BiquadCoefficients &c1, BiquadState &s1, float *samples, size_t count);
+        PcmLevels measureLevels(const int16_t *in, size_t count);
+    }
+}
+
+#endif // DSP_KERNELS_HPP_
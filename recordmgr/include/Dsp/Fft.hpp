@@ -0,0 +1,28 @@
+#ifndef FFT_HPP_
+#define FFT_HPP_
+
+#include <complex>
+#include <vector>
+#include <cstddef>
+
+// In-place iterative radix-2 complex FFT. Twiddles and the bit-reversal table
+// are computed once per size, transforms do not allocate.
+class Fft {
+    public:
+        explicit Fft(size_t size);   // size must be a power of two
+
+        void forward(std::complex<float> *data) const { transform(data, false); }
+        // Includes the 1/N scaling
+        void inverse(std::complex<float> *data) const;
+
+        size_t size() const { return size_; }
+
+    private:
+        void transform(std::complex<float> *data, bool inverse) const;
+
+        size_t size_;
+        std::vector<std::complex<float>> twiddles_;
+        std::vector<size_t> bitReverse_;
+};
+
+#endif // FFT_HPP_
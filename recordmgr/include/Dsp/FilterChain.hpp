@@ -0,0 +1,47 @@
+#ifndef FILTER_CHAIN_HPP_
+#define FILTER_CHAIN_HPP_
+
+#include "Biquad.hpp"
+#include "SpectralGate.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// highpass -> lowpass -> spectral noise gate on interleaved 16-bit PCM, each channel
+// with its own filter state and noise profile.
+// Same chain as the old "sox highpass 100 lowpass 3000 noisered", run in-process.
+// Block based so it works on a whole file as well as on the live capture stream.
+class FilterChain {
+    public:
+        struct Params {
+            unsigned int sampleRate = 16000;
+            unsigned int channels = 1;
+            float highPassHz = 100.0f;
+            float lowPassHz = 3000.0f;
+            unsigned int noiseProfileMs = 400;
+            SpectralGate::Params gate;
+        };
+        // Filter settings from Config for the given rate
+        static Params defaultParams(unsigned int sampleRate, unsigned int channels = 1);
+
+        explicit FilterChain(const Params &params);
+
+        // Replaces the content of out with whatever output is ready (may be empty while
+        // the noise profile is being learned). Buffers are reused across calls.
+        void process(const int16_t *in, size_t count, std::vector<int16_t> &out);
+        void flush(std::vector<int16_t> &out);
+        void reset();
+
+    private:
+        void convertOut(std::vector<int16_t> &out);
+
+        unsigned int channels_;
+        std::vector<Biquad> highPass_;      // one per channel
+        std::vector<Biquad> lowPass_;
+        std::vector<SpectralGate> gates_;
+        std::vector<float> scratch_;
+        std::vector<std::vector<float>> gated_;
+        std::vector<float> interleaved_;
+};
+
+#endif // FILTER_CHAIN_HPP_
@@ -0,0 +1,41 @@
+#ifndef LEVEL_METER_HPP_
+#define LEVEL_METER_HPP_
+
+#include "DspKernels.hpp"
+#include "PcmRingBuffer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Input level metering for the live dashboard.
+// process() runs on the capture thread and only touches atomics and an SPSC ring;
+// the publisher thread collects the RMS/peak accumulated since its last call plus
+// a decimated waveform (one peak value per bucket).
+class LevelMeter {
+    public:
+        LevelMeter(size_t waveformBucketSamples, size_t waveformCapacity);
+        LevelMeter(const LevelMeter &) = delete;
+        LevelMeter &operator=(const LevelMeter &) = delete;
+
+        // Producer side
+        void process(const int16_t *samples, size_t count);
+
+        // Consumer side, both reset what they return
+        PcmLevels takeLevels();
+        size_t takeWaveform(int16_t *peaks, size_t maxPoints);
+
+        // Only while the producer is stopped
+        void reset(size_t waveformBucketSamples);
+
+    private:
+        PcmRingBuffer waveform_;
+        size_t bucketSamples_;
+        size_t bucketFill_ = 0;         // producer only
+        int32_t bucketPeak_ = 0;        // producer only
+
+        std::atomic<uint64_t> sumSquares_{0};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<int32_t> peak_{0};
+};
+
+#endif // LEVEL_METER_HPP_
@@ -0,0 +1,56 @@
+#ifndef PEAK_PYRAMID_HPP_
+#define PEAK_PYRAMID_HPP_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Multi-resolution min/max summary of a recording, for drawing waveforms without
+// decoding the audio. Level 0 has one (min, max) pair per baseFrames frames, every
+// further level merges `factor` pairs of the one below, down to a few dozen points.
+// Values are the top 8 bits of the 16-bit samples, all channels folded together.
+//
+// Sidecar file "<audio file>.peaks", little-endian:
+//   "PKS1" | u32 sampleRate | u32 baseFrames | u16 factor | u16 levelCount
+//   per level: u32 pointCount | pointCount x (i8 min, i8 max)
+class PeakPyramid {
+    public:
+        struct Level {
+            uint32_t framesPerPoint = 0;
+            std::vector<int8_t> minMax;     // interleaved min, max
+            size_t points() const { return minMax.size() / 2; }
+        };
+
+        PeakPyramid() = default;
+
+        void reset(unsigned int sampleRate, unsigned int channels, unsigned int baseFrames, unsigned int factor);
+        void add(const int16_t *samples, size_t count);
+        // Close the partial bucket and build the coarser levels
+        void finish();
+
+        bool save(const std::string &filePath) const;
+        bool load(const std::string &filePath);
+
+        // Exactly `points` (min, max) pairs spread over the whole recording, from level 0
+        std::vector<int8_t> thumbnail(size_t points) const;
+        const std::vector<Level> &getLevels() const { return levels_; }
+
+        static std::string sidecarPath(const std::string &audioPath) { return audioPath + ".peaks"; }
+
+    private:
+        void flushBucket();
+
+        unsigned int sampleRate_ = 0;
+        unsigned int channels_ = 1;
+        unsigned int baseFrames_ = 256;
+        unsigned int factor_ = 4;
+        std::vector<Level> levels_;
+
+        size_t bucketSamples_ = 0;
+        size_t bucketFill_ = 0;
+        int16_t bucketMin_ = 0;
+        int16_t bucketMax_ = 0;
+};
+
+#endif // PEAK_PYRAMID_HPP_
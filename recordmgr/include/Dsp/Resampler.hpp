@@ -0,0 +1,49 @@
+#ifndef RESAMPLER_HPP_
+#define RESAMPLER_HPP_
+
+#include <vector>
+#include <cstddef>
+
+// Streaming sample rate converter for interleaved float PCM.
+// Polyphase windowed-sinc (Kaiser): the rate ratio is reduced to L/M and one
+// set of taps is precomputed for each of the L output phases, so every output
+// sample costs one dot product. The cutoff sits just below the lower of the two
+// Nyquist rates; the output is aligned with the input (no added delay) and
+// loses about half a filter length at the very end of the stream.
+class Resampler {
+    public:
+        struct Params {
+            unsigned int zeroCrossings = 16;    // sinc lobes on each side of the centre
+            float cutoff = 0.92f;               // of the lower Nyquist rate
+            float kaiserBeta = 8.0f;            // ~80 dB stopband
+        };
+
+        Resampler() = default;
+
+        void reset(unsigned int inRate, unsigned int outRate, unsigned int channels, const Params &params);
+        void reset(unsigned int inRate, unsigned int outRate, unsigned int channels) { reset(inRate, outRate, channels, Params()); }
+        bool isPassthrough() const { return up_ == down_; }
+        // After reset(): room for process() calls of up to maxFrames, so they do not allocate
+        void reserve(size_t maxFrames);
+
+        // Appends the converted frames to out
+        void process(const float *in, size_t frames, std::vector<float> &out);
+
+        unsigned int getInRate() const { return inRate_; }
+        unsigned int getOutRate() const { return outRate_; }
+
+    private:
+        unsigned int inRate_ = 0;
+        unsigned int outRate_ = 0;
+        unsigned int channels_ = 1;
+        unsigned int up_ = 1;           // L
+        unsigned int down_ = 1;         // M
+        size_t taps_ = 0;               // per phase
+        std::vector<float> coeffs_;     // up_ x taps_
+
+        std::vector<float> history_;    // interleaved input not consumed yet
+        size_t base_ = 0;               // first input frame of the next output
+        unsigned int phase_ = 0;        // 0..up_-1
+};
+
+#endif // RESAMPLER_HPP_
@@ -0,0 +1,58 @@
+#ifndef SPECTRAL_GATE_HPP_
+#define SPECTRAL_GATE_HPP_
+
+#include "Fft.hpp"
+#include <complex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// STFT noise gate, the in-process replacement for "sox noiseprof" + "noisered".
+// The first profileSamples of input are used as the noise profile (mean magnitude per bin),
+// then every bin that stays below threshold x profile is attenuated to floorGain.
+// Streaming: process() may be fed any block size, output lags input by up to one frame
+// (plus the profile length at the very start) and flush() returns the tail.
+class SpectralGate {
+    public:
+        struct Params {
+            size_t frameSize = 512;         // power of two, 50% overlap
+            size_t profileSamples = 0;      // 0 = no profile, gate passes everything through
+            float threshold = 2.0f;         // open when magnitude > threshold x noise
+            float floorGain = 0.25f;        // gain for gated bins
+            float release = 0.6f;           // per-frame smoothing when a bin closes, 0..1
+        };
+
+        explicit SpectralGate(const Params &params);
+
+        // Appends processed samples to out
+        void process(const float *in, size_t count, std::vector<float> &out);
+        void flush(std::vector<float> &out);
+        void reset();
+
+        bool hasProfile() const { return profileReady_; }
+
+    private:
+        void buildProfile();
+        void feed(const float *in, size_t count, std::vector<float> &out);
+        void processFrame(std::vector<float> &out);
+
+        Params params_;
+        size_t hop_;
+        Fft fft_;
+        std::vector<float> window_;             // sqrt-Hann, analysis and synthesis
+        std::vector<std::complex<float>> spectrum_;
+        std::vector<float> noise_;              // per bin, frameSize/2 + 1
+        std::vector<float> gains_;
+
+        std::vector<float> learnBuffer_;
+        bool profileReady_ = false;
+
+        std::vector<float> inFifo_;
+        size_t inFill_ = 0;
+        std::vector<float> outAccum_;
+        uint64_t inputCount_ = 0;       // real samples fed to the STFT
+        uint64_t emitted_ = 0;          // STFT output samples, including the warm-up prefix
+        uint64_t emitLimit_ = UINT64_MAX;
+};
+
+#endif // SPECTRAL_GATE_HPP_
@@ -0,0 +1,40 @@
+#ifndef VOICE_DETECTOR_HPP_
+#define VOICE_DETECTOR_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+// Frame-based voice activity detector: energy against an adaptive noise floor, with
+// zero-crossing rate to reject hiss. Speech is held for a hangover after the energy
+// drops so word gaps do not count as silence.
+class VoiceDetector {
+    public:
+        struct Params {
+            unsigned int frameMs = 20;
+            float thresholdDb = 9.0f;       // above the noise floor
+            float minSpeechDbfs = -50.0f;   // quieter than this is never speech
+            float maxZeroCrossRate = 0.35f; // crossings per sample, noise is above
+            unsigned int hangoverMs = 300;
+        };
+
+        VoiceDetector() = default;
+
+        void reset(unsigned int sampleRate, unsigned int channels, const Params &params);
+        size_t frameSamples() const { return frameSamples_; }
+
+        // One frame of frameSamples() samples; true while speech (hangover included)
+        bool classify(const int16_t *frame, size_t count);
+
+        float getNoiseFloorDbfs() const { return noiseFloorDb_; }
+
+    private:
+        Params params_;
+        unsigned int channels_ = 1;
+        size_t frameSamples_ = 320;
+        unsigned int hangoverFrames_ = 0;
+        unsigned int hangoverLeft_ = 0;
+        float noiseFloorDb_ = 0.0f;
+        bool floorInitialized_ = false;
+};
+
+#endif // VOICE_DETECTOR_HPP_
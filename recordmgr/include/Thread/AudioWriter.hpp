@@ -0,0 +1,110 @@
+#ifndef AUDIO_WRITER_HPP_
+#define AUDIO_WRITER_HPP_
+
+#include "ThreadBase.hpp"
+#include "AudioSink.hpp"
+#include "PcmRingBuffer.hpp"
+#include "AlsaHelper.hpp"
+#include "FilterChain.hpp"
+#include "PeakPyramid.hpp"
+#include "VoiceDetector.hpp"
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <chrono>
+#include <vector>
+
+// Consumer side of the capture pipeline.
+// The capture thread pushes samples into a preallocated SPSC ring and never touches the file
+// or a lock, so a slow write on the SD card does not delay the next ALSA read.
+class AudioWriter : public ThreadBase, public PcmSink {
+    public:
+        // channels: the most a recording of this session can have, sizes the ring
+        AudioWriter(const std::string &sessionId, unsigned int channels);
+        ~AudioWriter() = default;
+
+        // Control side, called from RecordWorker before/after its capture loop.
+        // With filterStreaming the filter chain runs block by block here and the file
+        // is already filtered when the session ends. Encoding also runs on this thread.
+        bool beginSession(const std::string &filePath, unsigned int sampleRate, unsigned int channels,
+                          bool filterStreaming, AudioCodec codec = AudioCodec::WAV);
+        // Drain the ring to disk, then finish the encoder and close the file.
+        // With VAD splitting one session can produce several files, in recording order;
+        // none means the session held no speech (the file is removed)
+        bool endSession(std::vector<AudioFileInfo> &files);
+        void abortSession();
+
+        // Silence since the last speech (or the session start), for auto-stop. Any thread
+        unsigned int getSilenceMs() const { return silenceMs_; }
+
+        // Capture thread only, lock-free
+        void pushBlock(const int16_t *samples, size_t sampleCount);
+        void onPcm(const int16_t *samples, size_t frames) override { pushBlock(samples, frames * channels_); }
+
+        PcmRingStats getRingStats() const { return ring_.getStats(); }
+
+        void stop() override;
+
+    private:
+        void threadFunction() override;
+        bool drainRing();   // mtx_ held
+        bool writeRegions(const int16_t *first, size_t firstCount, const int16_t *second, size_t secondCount);
+        bool writeSamples(const int16_t *samples, size_t count);
+        bool writeOut(const int16_t *samples, size_t count);   // final audio -> peaks + file
+
+        // Voice activity gate between the filter and the file
+        bool gateSamples(const int16_t *samples, size_t count);
+        bool onVadFrame(bool speech);
+        bool finishGate();
+        bool openSink(const std::string &filePath);
+        void abortSink();
+        void syncSink();
+        bool closeSegment();
+        bool restartSegment();
+        bool openNextSegment();
+        void finishPeaks(const std::string &filePath);
+
+        const std::string sessionId_;
+        PcmRingBuffer ring_;
+        std::unique_ptr<AudioSink> sink_;     // rebuilt only when the codec changes
+        std::string sinkPath_;                // final name, the sink writes <sinkPath_>.part
+        std::chrono::steady_clock::time_point lastSync_;
+        unsigned int sampleRate_ = 0;
+        unsigned int channels_ = 0;
+
+        std::unique_ptr<FilterChain> filterChain_;     // rebuilt only when the rate changes
+        unsigned int filterSampleRate_ = 0;
+        unsigned int filterChannels_ = 0;
+        bool filterStreaming_ = false;
+        std::vector<int16_t> filtered_;
+        std::vector<int16_t> stitched_;     // one frame across the ring wrap
+        PeakPyramid peaks_;     // of the final (filtered) audio, saved next to it on endSession
+
+        VoiceDetector vad_;
+        bool vadEnabled_ = false;
+        bool holdSilence_ = false;      // trimming or splitting: silence waits in held_
+        // Trimming, but no speech yet this session: the file gets everything so a take
+        // without speech is kept whole, and restarts from held_ at the first words
+        bool untrimmedLead_ = false;
+        std::vector<int16_t> vadFrame_;
+        std::vector<int16_t> held_;     // silence not written yet
+        size_t marginSamples_ = 0;
+        size_t holdCapSamples_ = 0;
+        uint64_t splitSamples_ = 0;
+        uint64_t silenceSamples_ = 0;
+        std::atomic<unsigned int> silenceMs_{0};
+        bool heardSpeech_ = false;      // in the current file
+        bool segmentOpen_ = false;
+        std::string basePath_;
+        unsigned int segmentIndex_ = 0;
+        std::vector<AudioFileInfo> segments_;   // closed files of this session
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::atomic<bool> sessionActive_{false};
+        bool writeError_ = false;
+};
+
+#endif // AUDIO_WRITER_HPP_
@@ -0,0 +1,49 @@
+#ifndef CALL_AUDIO_TAP_HPP_
+#define CALL_AUDIO_TAP_HPP_
+
+#include "ThreadBase.hpp"
+#include "AlsaHelper.hpp"
+#include "PcmRingBuffer.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Captures the far end of a phone call (RecordSessionConfig callDevice, the BlueALSA
+// HFP/SCO PCM) while a session records a call. Runs on its own thread because the SCO
+// PCM only exists during a call and may take a moment to appear; the microphone capture
+// never waits for it. Frames go, mono at the session rate, to a ring that CallAudioMixer
+// drains on the microphone's capture thread.
+class CallAudioTap : public ThreadBase, private PcmSink {
+    public:
+        CallAudioTap(const std::string &sessionId, const std::string &device);
+        ~CallAudioTap() = default;
+
+        // From the session's capture thread, around a recording with the far end in it.
+        // endSession() returns once the PCM is closed and the ring is no longer written
+        void beginSession();
+        void endSession();
+
+        // Consumer side of the ring (CallAudioMixer)
+        PcmRingBuffer &getRing() { return ring_; }
+
+        void stop() override;
+
+    private:
+        void threadFunction() override;
+        // Keeps the PCM open and capturing until the session ends, reopening when it goes away
+        void captureSession();
+        void onPcm(const int16_t *samples, size_t frames) override;
+
+        const std::string sessionId_;
+        const std::string device_;
+        std::unique_ptr<AlsaHelper> alsaHelper_;
+        PcmRingBuffer ring_;
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        bool active_ = false;       // a session wants the far end
+        bool capturing_ = false;    // tap thread is inside a session, ring in use
+};
+
+#endif // CALL_AUDIO_TAP_HPP_
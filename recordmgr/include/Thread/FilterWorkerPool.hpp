@@ -0,0 +1,67 @@
+#ifndef FILTER_WORKER_POOL_HPP_
+#define FILTER_WORKER_POOL_HPP_
+
+#include "ThreadBase.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class WavPayload;
+
+struct FilterJob {
+    uint32_t id = 0;
+    std::string filePath;
+    int durationSec = 0;
+    bool isFiltered = false;    // streaming filter already ran, only store the file
+    std::string codec;
+    int bitrate = 0;
+    std::string sessionId;
+    // Skip (or stop) the filter pass and store the original file
+    std::atomic<bool> canceled{false};
+
+    bool needsFilter() const { return !isFiltered && !canceled; }
+};
+
+// Filters and stores finished recordings off the MainWorker thread.
+// Jobs waiting for the filter are served newest first so the recording the
+// user just made is ready soonest; store-only jobs (pre-filtered or canceled)
+// are cheap and go ahead of them. At most FILTER_QUEUE_CAPACITY jobs wait for
+// the filter, past that the oldest one is stored unfiltered. Every job sends
+// FILTER_PROGRESS_NOTI updates and ends with FILTER_WAV_FILE_NOTI.
+class FilterWorkerPool : public ThreadBase {
+    public:
+        FilterWorkerPool();
+        ~FilterWorkerPool() = default;
+
+        // Returns the job id, 0 when the pool is stopping
+        uint32_t submit(const WavPayload &wav);
+        // jobId 0 = every queued and running job
+        void cancel(uint32_t jobId);
+
+        void stop() override;
+
+    private:
+        void threadFunction() override;
+        void workerLoop();
+        std::shared_ptr<FilterJob> takeJob();     // mtx_ held
+        void runJob(FilterJob &job);
+        void sendProgress(const FilterJob &job, int percent);
+
+        int numWorkers_;
+        size_t capacity_;
+        uint32_t nextJobId_ = 1;
+
+        std::deque<std::shared_ptr<FilterJob>> pending_;
+        std::vector<std::shared_ptr<FilterJob>> running_;
+        std::vector<std::thread> workers_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+};
+
+#endif // FILTER_WORKER_POOL_HPP_
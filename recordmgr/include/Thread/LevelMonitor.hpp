@@ -0,0 +1,45 @@
+#ifndef LEVEL_MONITOR_HPP_
+#define LEVEL_MONITOR_HPP_
+
+#include "ThreadBase.hpp"
+#include "AlsaHelper.hpp"
+#include "LevelMeter.hpp"
+#include "DBusData.hpp"
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Publishes the live input level while recording.
+// The capture thread feeds the meter through onPcm(); this thread sends a
+// RECORD_LEVEL_NOTI every LEVEL_NOTI_INTERVAL_MS, so a slow D-Bus peer never
+// holds up capture.
+class LevelMonitor : public ThreadBase, public PcmSink {
+    public:
+        explicit LevelMonitor(const std::string &sessionId = DEFAULT_RECORD_SESSION_ID);
+        ~LevelMonitor() = default;
+
+        void beginSession(unsigned int sampleRate, unsigned int channels);
+        void endSession();
+
+        // Capture thread only
+        void onPcm(const int16_t *samples, size_t frames) override;
+
+        void stop() override;
+
+    private:
+        void threadFunction() override;
+        bool collect(DBusDataInfo &info);  // mtx_ held
+
+        const std::string sessionId_;
+        LevelMeter meter_;
+        unsigned int channels_ = 1;
+        std::vector<int16_t> waveform_;
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::atomic<bool> sessionActive_{false};
+};
+
+#endif // LEVEL_MONITOR_HPP_
@@ -2,32 +2,41 @@
 #define MAIN_WORKER_HPP_
 
 #include <memory>
+#include <string>
 #include "ThreadBase.hpp"
+#include "Define.hpp"
 
 #define INTERNAL_EVENTQUEUE_TIMEOUT_MS  2500
 
 class EventQueue;
 class Event;
 class RecordWorker;
+class RecordSessionManager;
+class FilterWorkerPool;
 class Payload;
 
 class MainWorker : public ThreadBase {
     public:
-        explicit MainWorker(std::shared_ptr<class EventQueue> eventQueue, std::shared_ptr<RecordWorker> recordWorker);
+        explicit MainWorker(std::shared_ptr<class EventQueue> eventQueue, std::shared_ptr<RecordSessionManager> recordSessions,
+                            std::shared_ptr<FilterWorkerPool> filterWorkerPool);
         ~MainWorker() = default;
 
     private:
         std::shared_ptr<EventQueue> eventQueue_;
-        std::shared_ptr<RecordWorker> recordWorker_;
+        std::shared_ptr<RecordSessionManager> recordSessions_;
+        std::shared_ptr<FilterWorkerPool> filterWorkerPool_;
 
         void threadFunction() override;
 
         void processEvent(const std::shared_ptr<Event> event);
 
-        void processStartRecordEvent();
-        void processStopRecordEvent();
-        void processCancelRecordEvent();
+        void processStartRecordEvent(std::shared_ptr<Payload>);
+        void processStopRecordEvent(std::shared_ptr<Payload>);
+        void processCancelRecordEvent(std::shared_ptr<Payload>);
+        // Answers with a failed notiCmd when the session does not exist
+        std::shared_ptr<RecordWorker> findSession(std::shared_ptr<Payload>, DBusCommand notiCmd);
         void processFilterWavFileEvent(std::shared_ptr<Payload>);
+        void processCancelFilterEvent(std::shared_ptr<Payload>);
 };
 
 #endif // MAIN_WORKER_HPP_
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef RECORD_SESSION_MANAGER_HPP_
+#define RECORD_SESSION_MANAGER_HPP_
+
+#include <map>
+#include <memory>
+#include <string>
+
+class EventQueue;
+class RecordWorker;
+class AudioWriter;
+class LevelMonitor;
+class CallAudioTap;
+
+// Owns the capture sessions from Config RECORD_SESSIONS, each a RecordWorker with its
+// own AudioWriter and LevelMonitor thread (plus a CallAudioTap when it records calls),
+// and routes record commands by session id.
+class RecordSessionManager {
+    public:
+        explicit RecordSessionManager(std::shared_ptr<EventQueue> eventQueue);
+        ~RecordSessionManager() = default;
+
+        // Recovers recordings interrupted by a crash, then starts every session
+        void run();
+        void stop();
+        void join();
+
+        // nullptr for an unknown session id
+        std::shared_ptr<RecordWorker> find(const std::string &sessionId) const;
+
+    private:
+        struct Session {
+            std::shared_ptr<AudioWriter> audioWriter;
+            std::shared_ptr<LevelMonitor> levelMonitor;
+            std::shared_ptr<RecordWorker> recordWorker;
+            std::shared_ptr<CallAudioTap> callAudioTap;     // nullptr without a callDevice
+        };
+
+        // Part files left by a crash are repaired and handed to the filter step
+        void recoverInterruptedRecordings();
+
+        std::shared_ptr<EventQueue> eventQueue_;
+        std::map<std::string, Session> sessions_;
+};
+
+#endif // RECORD_SESSION_MANAGER_HPP_
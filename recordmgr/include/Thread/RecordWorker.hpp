@@ -2,6 +2,10 @@
 #define RECORD_WORKER_HPP_
 
 #include "ThreadBase.hpp"
+#include "AudioSink.hpp"
+#include "PreRollBuffer.hpp"
+#include "DBusData.hpp"
+#include "Config.hpp"
 #include <string>
 #include <mutex>
 #include <condition_variable>
@@ -10,13 +14,24 @@
 
 class EventQueue;
 class AlsaHelper;
+class AudioWriter;
+class LevelMonitor;
+class CallAudioTap;
 
+// Capture thread of one recording session (one microphone). Sessions run
+// independently, each with its own PCM, writer ring and level monitor.
+// callAudioTap is nullptr for sessions without a callDevice.
 class RecordWorker : public ThreadBase {
     public:
-        explicit RecordWorker(std::shared_ptr<EventQueue> eventQueue);
+        explicit RecordWorker(const RecordSessionConfig &config, std::shared_ptr<EventQueue> eventQueue,
+                              std::shared_ptr<AudioWriter> audioWriter, std::shared_ptr<LevelMonitor> levelMonitor,
+                              std::shared_ptr<CallAudioTap> callAudioTap);
         ~RecordWorker();
 
-        void startRecording();
+        const std::string &getSessionId() const { return sessionId_; }
+
+        // withCallAudio: a call is active, record its far end too (when the session has a callDevice)
+        void startRecording(bool withCallAudio = false);
         void stopRecording();
         void cancelRecording();
         void stop() override;
@@ -28,15 +43,28 @@ class RecordWorker : public ThreadBase {
         };
 
         void threadFunction() override;
+        // Fills preRoll_ until a session is requested; leaves the PCM running
+        void captureIdle();
+        std::string makeOutputFilePath(AudioCodec codec) const;
+        // Tags the noti with this session
+        void sendNoti(DBusCommand cmd, bool isSuccess, DBusDataInfo &info) const;
 
+        const RecordSessionConfig config_;
+        const std::string sessionId_;
         std::shared_ptr<EventQueue> eventQueue_;
+        std::shared_ptr<AudioWriter> audioWriter_;
+        std::shared_ptr<LevelMonitor> levelMonitor_;
+        std::shared_ptr<CallAudioTap> callAudioTap_;
         std::unique_ptr<AlsaHelper> alsaHelper_;
+        PreRollBuffer preRoll_;
+        bool pcmRunning_ = false;   // capture thread only
 
         // Thread control
         std::mutex mtx_;
         std::condition_variable cv_;
         std::atomic<State> state_;
         std::atomic<bool> cancelRequested_;
+        std::atomic<bool> withCallAudio_;
 };
 
 #endif // RECORD_WORKER_HPP_
\ No newline at end of file
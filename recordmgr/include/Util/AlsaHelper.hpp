@@ -2,30 +2,66 @@
 #define ALSA_HELPER_HPP_
 
 #include <alsa/asoundlib.h>
-#include <vector>
+#include "PcmSink.hpp"
+#include "PcmSource.hpp"
+#include "PcmConverter.hpp"
 #include <string>
+#include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <poll.h>
 
-class AlsaHelper {
+class AlsaHelper : public PcmSource {
 public:
-    AlsaHelper();
+    // device "" = first capture card found, rescanned when cards come and go.
+    // channels 0 = Config CAPTURE_CHANNELS
+    explicit AlsaHelper(const std::string& device = "", unsigned int channels = 0);
     ~AlsaHelper();
 
+    // Start capturing; reuses the PCM kept open by warm mode when the devices did not change
     bool initAlsa();
+    // End of a session: closes the PCM, or in warm mode stops it and keeps it prepared
+    void releaseAlsa();
+    // Open and prepare the PCM ahead of the first session (warm mode only)
+    bool warmUp();
     void cleanupAlsa();
-    bool captureOnce();
-    bool saveWavFile();
+    bool captureOnce(PcmSink& sink, snd_pcm_uframes_t& framesRead) override;
+    void wakeup() override;
 
-    void clearAudioBuffer();
-    bool isAudioBufferEmpty() const;
-    const std::string& getOutputFilePath() const;
+    bool isMmap() const { return useMmap_; }
+    // Overruns (EPIPE) since the helper was created, capture thread only
+    uint64_t getXrunCount() const { return xruns_; }
+    // What the sinks get (Config SAMPLE_RATE, channel count from the constructor), whatever the device delivers
+    unsigned int getSampleRate() const { return converter_.getOutRate(); }
+    unsigned int getChannels() const { return converter_.getOutChannels(); }
 
 private:
     std::string findCaptureDevice();
+    bool openPcm();
+    void watchDevices();
+    bool devicesChanged();
+    bool setAccess(snd_pcm_hw_params_t* hwParams);
+    bool setFormat(snd_pcm_hw_params_t* hwParams);
+    bool recover(int err);
+    bool captureMmap(PcmSink& sink, snd_pcm_uframes_t& framesRead);
+    bool captureReadi(PcmSink& sink, snd_pcm_uframes_t& framesRead);
 
     snd_pcm_t* pcmHandle_;
-    std::vector<int16_t> audioBuffer_;
-    std::string outputFilePath_;
+    bool useMmap_;
+    int wakeupFd_;
+    int inotifyFd_;                         // /dev/snd watch, -1 when caching is off
+    const std::string device_;              // fixed PCM name from the session config
+    std::string cachedDevice_;              // empty = scan the cards again
+    std::vector<struct pollfd> pollFds_;    // PCM descriptors + wakeupFd_ last
+    std::vector<uint8_t> periodBuffer_;     // readi fallback only, sized once in openPcm
+
+    // Negotiated device format
+    snd_pcm_format_t format_;
+    unsigned int deviceRate_;
+    unsigned int deviceChannels_;
+    uint64_t xruns_ = 0;
+
+    PcmConverter converter_;                // device format -> S16_LE for the sinks
 };
 
 #endif // ALSA_HELPER_HPP_
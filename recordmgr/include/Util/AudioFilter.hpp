@@ -1,7 +1,12 @@
 #ifndef AUDIO_FILTER_HPP_
 #define AUDIO_FILTER_HPP_
 
+#include "AudioSink.hpp"
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <atomic>
+#include <functional>
 
 class AudioFilter {
     public:
@@ -9,11 +14,28 @@ class AudioFilter {
         ~AudioFilter() = default;
 
         // Tham chieu den file WAV can loc
-        bool applyFilter(const std::string& wavFilePath);
+        // isPreFiltered: the streaming filter already ran during capture, only store the file
+        bool applyFilter(const std::string& wavFilePath, bool isPreFiltered = false);
+        // Called with 0..100 while the filter chain runs
+        void setProgressCallback(std::function<void(int)> callback) { progressCallback_ = std::move(callback); }
+        // Checked between blocks; once set the filter pass stops and the original file is stored
+        void setCancelFlag(const std::atomic<bool> *cancelFlag) { cancelFlag_ = cancelFlag; }
         std::string getFilteredFilePath() const { return filteredFilePath_; }
+        // Codec/bitrate of the file written by the filter pass (not set when isPreFiltered)
+        const AudioFileInfo &getFileInfo() const { return fileInfo_; }
+        // Min/max pairs from the stored peak file, empty when there is none
+        const std::vector<int8_t> &getThumbnail() const { return thumbnail_; }
 
     private:
+        bool runFilterChain(const std::string& inputPath, const std::string& outputPath, AudioCodec codec);
+
         std::string filteredFilePath_ = "";
+        AudioFileInfo fileInfo_;
+        std::vector<int8_t> thumbnail_;
+        std::function<void(int)> progressCallback_;
+        const std::atomic<bool> *cancelFlag_ = nullptr;
+
+        bool isCanceled() const { return cancelFlag_ != nullptr && cancelFlag_->load(); }
 };
 
 #endif // AUDIO_FILTER_HPP_
\ No newline at end of file
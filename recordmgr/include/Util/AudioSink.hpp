@@ -0,0 +1,55 @@
+#ifndef AUDIO_SINK_HPP_
+#define AUDIO_SINK_HPP_
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+enum class AudioCodec {
+    WAV,    // 16-bit PCM, always available
+    FLAC,   // lossless, needs libFLAC (HAVE_FLAC)
+    OPUS,   // speech, needs libopusenc (HAVE_OPUS)
+};
+
+struct AudioFileInfo {
+    std::string filePath;
+    AudioCodec codec = AudioCodec::WAV;
+    unsigned int bitrate = 0;   // bits per second
+    uint64_t frames = 0;
+    uint64_t bytes = 0;         // size of the file on disk
+};
+
+// Output stage of the recording pipeline: takes interleaved 16-bit samples and
+// encodes them straight to a file. Implementations are not thread-safe.
+class AudioSink {
+    public:
+        virtual ~AudioSink() = default;
+
+        virtual bool open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) = 0;
+        virtual bool write(const int16_t *samples, size_t sampleCount) = 0;
+        virtual bool close() = 0;
+        virtual void abort() = 0;   // close and delete the file
+        // Make what was written so far survive a crash. Encoders whose stream stays
+        // decodable when truncated (FLAC, Ogg Opus) have nothing to do
+        virtual bool sync() { return true; }
+
+        virtual bool isOpen() const = 0;
+        virtual const std::string &getFilePath() const = 0;
+        virtual uint64_t getFramesWritten() const = 0;
+        virtual uint64_t getBytesWritten() const = 0;
+        virtual AudioCodec getCodec() const = 0;
+        // Nominal rate for WAV/Opus, measured average for FLAC (valid after close())
+        virtual unsigned int getBitrate() const = 0;
+
+        AudioFileInfo getInfo() const;
+
+        static const char *codecName(AudioCodec codec);
+        static const char *fileExtension(AudioCodec codec);     // with the leading dot
+        static bool isSupported(AudioCodec codec);
+        // Codec from Config, WAV if it is unknown or not compiled in
+        static AudioCodec configuredCodec();
+        static std::unique_ptr<AudioSink> create(AudioCodec codec);
+};
+
+#endif // AUDIO_SINK_HPP_
@@ -0,0 +1,49 @@
+#ifndef CALL_AUDIO_MIXER_HPP_
+#define CALL_AUDIO_MIXER_HPP_
+
+#include "PcmSink.hpp"
+#include "PcmRingBuffer.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Adds the far end of a call (mono, from CallAudioTap's ring) to the microphone frames,
+// on the microphone's capture thread. The two devices run on their own clocks: mixing
+// starts once jitterFrames of far-end audio are buffered, a shortfall is filled with
+// silence and buffers again, and a backlog past twice the target is dropped so the far
+// end never drifts behind the microphone. Buffers are sized up front for blockFrames;
+// longer deliveries are mixed in pieces, so the capture callback never allocates.
+class CallAudioMixer : public PcmSink {
+    public:
+        // stereo: the far end becomes an extra last channel instead of being mixed into every one
+        CallAudioMixer(PcmSink &out, PcmRingBuffer &farEnd, unsigned int micChannels, bool stereo, size_t jitterFrames,
+                       size_t blockFrames);
+
+        void onPcm(const int16_t *samples, size_t frames) override;
+
+        unsigned int getChannels() const { return outChannels_; }
+        uint64_t getSilencedFrames() const { return silencedFrames_; }
+        uint64_t getDroppedFrames() const { return droppedFrames_; }
+
+    private:
+        // Far end for the next frames into farEnd_, silence where there is none.
+        // Returns the number of real far-end frames
+        size_t pullFarEnd(size_t frames);
+        void mixBlock(const int16_t *samples, size_t frames);
+
+        PcmSink &out_;
+        PcmRingBuffer &ring_;
+        const unsigned int micChannels_;
+        const unsigned int outChannels_;
+        const bool stereo_;
+        const size_t jitterFrames_;
+        const size_t blockFrames_;
+        bool primed_ = false;
+
+        std::vector<int16_t> farEnd_;
+        std::vector<int16_t> mixed_;
+        uint64_t silencedFrames_ = 0;   // after mixing started, frames with no far end in time
+        uint64_t droppedFrames_ = 0;    // far end thrown away to catch up
+};
+
+#endif // CALL_AUDIO_MIXER_HPP_
@@ -0,0 +1,21 @@
+#ifndef FILE_MOVER_HPP_
+#define FILE_MOVER_HPP_
+
+#include <string>
+#include <cstdint>
+
+// Moves finished recordings into place without writing them a second time.
+// Same filesystem: a plain rename. Across filesystems: an in-kernel copy
+// (copy_file_range, sendfile when the kernel refuses) into "<dst>.tmp",
+// fdatasync, rename over dst, then the source is removed. Readers of dst
+// never see a partial file either way.
+class FileMover {
+    public:
+        // bytesCopied: data written by the cross-device copy, 0 after a rename
+        static bool move(const std::string &srcPath, const std::string &dstPath, uint64_t &bytesCopied);
+
+    private:
+        static bool copyData(int inFd, int outFd, uint64_t size);
+};
+
+#endif // FILE_MOVER_HPP_
@@ -0,0 +1,46 @@
+#ifndef FLAC_WRITER_HPP_
+#define FLAC_WRITER_HPP_
+
+#ifdef HAVE_FLAC
+
+#include "AudioSink.hpp"
+#include <FLAC/stream_encoder.h>
+#include <vector>
+
+// Lossless FLAC output through the libFLAC stream encoder.
+// Roughly halves the size of speech recordings at level 5 with a few % of one Pi core.
+class FlacWriter : public AudioSink {
+    public:
+        explicit FlacWriter(unsigned int compressionLevel);
+        ~FlacWriter() override;
+        FlacWriter(const FlacWriter &) = delete;
+        FlacWriter &operator=(const FlacWriter &) = delete;
+
+        bool open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) override;
+        bool write(const int16_t *samples, size_t sampleCount) override;
+        bool close() override;
+        void abort() override;
+
+        bool isOpen() const override { return encoder_ != nullptr; }
+        const std::string &getFilePath() const override { return filePath_; }
+        uint64_t getFramesWritten() const override { return framesWritten_; }
+        uint64_t getBytesWritten() const override { return bytesWritten_; }
+        AudioCodec getCodec() const override { return AudioCodec::FLAC; }
+        unsigned int getBitrate() const override;
+
+    private:
+        void destroyEncoder();
+
+        unsigned int compressionLevel_;
+        FLAC__StreamEncoder *encoder_ = nullptr;
+        std::string filePath_;
+        unsigned int sampleRate_ = 0;
+        unsigned int channels_ = 0;
+        uint64_t framesWritten_ = 0;
+        uint64_t bytesWritten_ = 0;
+        std::vector<FLAC__int32> scratch_;  // libFLAC takes 32-bit samples
+};
+
+#endif // HAVE_FLAC
+
+#endif // FLAC_WRITER_HPP_
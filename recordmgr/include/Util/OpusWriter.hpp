@@ -0,0 +1,41 @@
+#ifndef OPUS_WRITER_HPP_
+#define OPUS_WRITER_HPP_
+
+#ifdef HAVE_OPUS
+
+#include "AudioSink.hpp"
+#include <opusenc.h>
+
+// Ogg Opus output through libopusenc, tuned for speech (OPUS_SIGNAL_VOICE).
+// libopusenc resamples to 48 kHz internally, so any capture rate works.
+class OpusWriter : public AudioSink {
+    public:
+        explicit OpusWriter(unsigned int bitrate);
+        ~OpusWriter() override;
+        OpusWriter(const OpusWriter &) = delete;
+        OpusWriter &operator=(const OpusWriter &) = delete;
+
+        bool open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) override;
+        bool write(const int16_t *samples, size_t sampleCount) override;
+        bool close() override;
+        void abort() override;
+
+        bool isOpen() const override { return encoder_ != nullptr; }
+        const std::string &getFilePath() const override { return filePath_; }
+        uint64_t getFramesWritten() const override { return framesWritten_; }
+        uint64_t getBytesWritten() const override { return bytesWritten_; }
+        AudioCodec getCodec() const override { return AudioCodec::OPUS; }
+        unsigned int getBitrate() const override { return bitrate_; }
+
+    private:
+        unsigned int bitrate_;
+        OggOpusEnc *encoder_ = nullptr;
+        std::string filePath_;
+        unsigned int channels_ = 0;
+        uint64_t framesWritten_ = 0;
+        uint64_t bytesWritten_ = 0;
+};
+
+#endif // HAVE_OPUS
+
+#endif // OPUS_WRITER_HPP_
@@ -0,0 +1,55 @@
+#ifndef PCM_CONVERTER_HPP_
+#define PCM_CONVERTER_HPP_
+
+#include "PcmSink.hpp"
+#include "Resampler.hpp"
+#include <alsa/asoundlib.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Device frames -> what the sinks want: interleaved S16_LE at the output rate and channel
+// count. Converts S16/S24/S32/FLOAT, downmixes or duplicates channels and resamples; a
+// device that already matches is handed through without a copy. Capture thread only.
+// Scratch buffers are sized in configure(), a longer delivery is converted in pieces,
+// so deliver() never allocates.
+class PcmConverter {
+    public:
+        PcmConverter(unsigned int outRate, unsigned int outChannels);
+
+        // After the device format is negotiated. blockFrames: the usual delivery, e.g. one period
+        void configure(snd_pcm_format_t format, unsigned int deviceRate, unsigned int deviceChannels, size_t blockFrames);
+        // New stream, no resampler history from the previous one
+        void reset();
+        // Returns the number of frames the sink received
+        size_t deliver(PcmSink& sink, const uint8_t* data, size_t frames);
+
+        size_t getFrameBytes() const { return frameBytes_; }
+        bool isPassthrough() const { return passthrough_; }
+        bool isResampling() const { return !resampler_.isPassthrough(); }
+        unsigned int getOutRate() const { return outRate_; }
+        unsigned int getOutChannels() const { return outChannels_; }
+
+        // Container size of one sample; S24_LE sits in 32 bits
+        static size_t sampleBytes(snd_pcm_format_t format) { return format == SND_PCM_FORMAT_S16_LE ? 2 : 4; }
+
+    private:
+        void toFloat(const uint8_t* data, size_t frames);
+        size_t deliverBlock(PcmSink& sink, const uint8_t* data, size_t frames);
+
+        const unsigned int outRate_;
+        const unsigned int outChannels_;
+        snd_pcm_format_t format_;
+        unsigned int deviceRate_;
+        unsigned int deviceChannels_;
+        size_t frameBytes_;
+        bool passthrough_;
+        size_t blockFrames_;
+
+        Resampler resampler_;
+        std::vector<float> converted_;          // out channel count, device rate
+        std::vector<float> resampled_;
+        std::vector<int16_t> output_;
+};
+
+#endif // PCM_CONVERTER_HPP_
@@ -0,0 +1,63 @@
+#ifndef PCM_RING_BUFFER_HPP_
+#define PCM_RING_BUFFER_HPP_
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct PcmRingStats {
+    size_t capacity = 0;            // samples
+    size_t highWater = 0;           // max fill seen, samples
+    uint64_t overruns = 0;          // writes that did not fit
+    uint64_t droppedSamples = 0;    // samples lost to overruns
+    uint64_t underruns = 0;         // reads that came up short
+    uint64_t samplesWritten = 0;
+    size_t fill = 0;                // samples waiting when the stats were taken
+};
+
+// Lock-free single-producer/single-consumer ring of PCM samples.
+// Storage is allocated once; write() is called only from the capture thread and
+// read()/peek()/consume() only from the consumer thread.
+class PcmRingBuffer {
+    public:
+        explicit PcmRingBuffer(size_t minCapacity);
+        PcmRingBuffer(const PcmRingBuffer &) = delete;
+        PcmRingBuffer &operator=(const PcmRingBuffer &) = delete;
+
+        // Producer side. Writes as much as fits and counts the rest as dropped.
+        // frameSamples: only whole frames are written, so interleaved channels stay in order
+        size_t write(const int16_t *samples, size_t count, size_t frameSamples = 1);
+
+        // Consumer side
+        size_t read(int16_t *out, size_t count);
+        // Up to two contiguous readable regions, valid until consume()
+        size_t peek(const int16_t *&first, size_t &firstCount, const int16_t *&second, size_t &secondCount) const;
+        void consume(size_t count);
+        // Consumer woke up for a period and found nothing to read
+        void noteUnderrun() { underruns_.fetch_add(1, std::memory_order_relaxed); }
+
+        size_t readAvailable() const;
+        size_t writeAvailable() const { return capacity_ - readAvailable(); }
+        size_t capacity() const { return capacity_; }
+
+        // Only while neither side is active
+        void reset();
+        PcmRingStats getStats() const;
+
+    private:
+        std::vector<int16_t> buffer_;
+        const size_t capacity_;
+        const size_t mask_;
+
+        alignas(64) std::atomic<size_t> head_{0};   // next write position, owned by producer
+        alignas(64) std::atomic<size_t> tail_{0};   // next read position, owned by consumer
+
+        alignas(64) std::atomic<size_t> highWater_{0};
+        std::atomic<uint64_t> overruns_{0};
+        std::atomic<uint64_t> droppedSamples_{0};
+        std::atomic<uint64_t> underruns_{0};
+        std::atomic<uint64_t> samplesWritten_{0};
+};
+
+#endif // PCM_RING_BUFFER_HPP_
@@ -0,0 +1,30 @@
+#ifndef PCM_SINK_HPP_
+#define PCM_SINK_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+// Receives captured frames on the capture thread, interleaved 16-bit at the configured
+// rate and channel count. The pointer may refer to the ALSA mmap area and is only valid
+// during the call.
+class PcmSink {
+public:
+    virtual ~PcmSink() = default;
+    virtual void onPcm(const int16_t* samples, size_t frames) = 0;
+};
+
+// Hands the same frames to two sinks, first then second
+class PcmTee : public PcmSink {
+public:
+    PcmTee(PcmSink& first, PcmSink& second) : first_(first), second_(second) {}
+    void onPcm(const int16_t* samples, size_t frames) override {
+        first_.onPcm(samples, frames);
+        second_.onPcm(samples, frames);
+    }
+
+private:
+    PcmSink& first_;
+    PcmSink& second_;
+};
+
+#endif // PCM_SINK_HPP_
@@ -0,0 +1,19 @@
+#ifndef PCM_SOURCE_HPP_
+#define PCM_SOURCE_HPP_
+
+#include "PcmSink.hpp"
+#include <alsa/asoundlib.h>
+
+// Where a capture loop pulls its frames from: AlsaHelper on a sound card, or a fake
+// source serving a fixture (bench/FakePcmSource) so the pipeline runs without one.
+class PcmSource {
+    public:
+        virtual ~PcmSource() = default;
+        // Wait for frames (or wakeup()) and hand every available frame to the sink.
+        // framesRead is 0 after a timeout, a wakeup or a recovered xrun.
+        virtual bool captureOnce(PcmSink& sink, snd_pcm_uframes_t& framesRead) = 0;
+        // Thread-safe, interrupts a captureOnce() that is waiting
+        virtual void wakeup() = 0;
+};
+
+#endif // PCM_SOURCE_HPP_
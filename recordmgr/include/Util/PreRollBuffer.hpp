@@ -0,0 +1,31 @@
+#ifndef PRE_ROLL_BUFFER_HPP_
+#define PRE_ROLL_BUFFER_HPP_
+
+#include "AlsaHelper.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Keeps the most recent audio captured while no session is running, overwriting the
+// oldest frames. Fed and drained on the capture thread only, so there is no locking.
+class PreRollBuffer : public PcmSink {
+    public:
+        PreRollBuffer(size_t capacityFrames, unsigned int channels);
+
+        void onPcm(const int16_t *samples, size_t frames) override;
+
+        // Hands the buffered frames to the sink oldest first and empties the buffer.
+        // Returns the number of frames handed over.
+        size_t drainTo(PcmSink &sink);
+        void clear();
+
+        size_t frames() const { return fill_ / channels_; }
+
+    private:
+        std::vector<int16_t> buffer_;
+        const size_t channels_;
+        size_t start_ = 0;      // oldest sample
+        size_t fill_ = 0;       // samples
+};
+
+#endif // PRE_ROLL_BUFFER_HPP_
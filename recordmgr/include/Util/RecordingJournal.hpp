@@ -0,0 +1,49 @@
+#ifndef RECORDING_JOURNAL_HPP_
+#define RECORDING_JOURNAL_HPP_
+
+#include "AudioSink.hpp"
+#include "Define.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Crash safety for recordings in progress.
+// While a session runs the audio goes to "<file>.part" and a small text journal
+// "<file>.journal" describes it (format, frames synced so far). A clean close renames
+// the part file and deletes the journal, so anything left over at startup is a
+// recording interrupted by a crash or a power loss.
+class RecordingJournal {
+    public:
+        struct Entry {
+            AudioCodec codec = AudioCodec::WAV;
+            unsigned int sampleRate = 0;
+            unsigned int channels = 1;
+            bool filtered = false;      // streaming filter was on, no post-stop pass needed
+            uint64_t frames = 0;        // handed to the encoder at the last sync
+            std::string sessionId = DEFAULT_RECORD_SESSION_ID;
+        };
+
+        struct Recovered {
+            AudioFileInfo info;
+            unsigned int sampleRate = 0;
+            bool filtered = false;
+            std::string sessionId;
+        };
+
+        static std::string partPath(const std::string &filePath) { return filePath + ".part"; }
+        static std::string journalPath(const std::string &filePath) { return filePath + ".journal"; }
+
+        // Replaces the journal atomically (temp file + rename)
+        static bool write(const std::string &filePath, const Entry &entry);
+        static bool read(const std::string &filePath, Entry &entry);
+        static void remove(const std::string &filePath);
+
+        // Part file -> final name, journal removed
+        static bool commit(const std::string &filePath);
+
+        // Repairs every part file in dir and gives it its final name.
+        // Empty or unreadable leftovers are deleted.
+        static std::vector<Recovered> recoverAll(const std::string &dir);
+};
+
+#endif // RECORDING_JOURNAL_HPP_
@@ -0,0 +1,32 @@
+#ifndef WAV_READER_HPP_
+#define WAV_READER_HPP_
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+// Sequential reader for 16-bit PCM WAV files (the format WavWriter produces).
+class WavReader {
+    public:
+        WavReader() = default;
+        ~WavReader() = default;
+
+        bool open(const std::string &filePath);
+        // Returns the number of samples read, 0 at end of data
+        size_t read(int16_t *samples, size_t maxSamples);
+        void close() { in_.close(); }
+
+        unsigned int getSampleRate() const { return sampleRate_; }
+        unsigned int getChannels() const { return channels_; }
+        uint64_t getTotalSamples() const { return dataBytes_ / sizeof(int16_t); }
+
+    private:
+        std::ifstream in_;
+        unsigned int sampleRate_ = 0;
+        unsigned int channels_ = 0;
+        uint64_t dataBytes_ = 0;
+        uint64_t remainingBytes_ = 0;
+};
+
+#endif // WAV_READER_HPP_
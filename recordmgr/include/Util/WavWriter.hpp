@@ -0,0 +1,51 @@
+#ifndef WAV_WRITER_HPP_
+#define WAV_WRITER_HPP_
+
+#include "AudioSink.hpp"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Streaming 16-bit PCM WAV writer.
+// The header is written on open() with zero sizes, samples are appended as they arrive
+// and the RIFF/data sizes are patched in place on close() and on every sync().
+class WavWriter : public AudioSink {
+    public:
+        WavWriter() = default;
+        ~WavWriter() override;
+        WavWriter(const WavWriter &) = delete;
+        WavWriter &operator=(const WavWriter &) = delete;
+
+        bool open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) override;
+        bool write(const int16_t *samples, size_t sampleCount) override;
+        bool close() override;
+        void abort() override;
+        bool sync() override;
+
+        // Fix the sizes in the header of a WAV written by this class and cut off a torn
+        // last frame, for files left behind by a crash. getFramesWritten() is valid afterwards
+        bool recover(const std::string &filePath);
+
+        bool isOpen() const override { return fd_ >= 0; }
+        const std::string &getFilePath() const override { return filePath_; }
+        uint64_t getFramesWritten() const override { return channels_ ? dataBytes_ / (channels_ * sizeof(int16_t)) : 0; }
+        uint64_t getBytesWritten() const override { return HEADER_SIZE + dataBytes_; }
+        AudioCodec getCodec() const override { return AudioCodec::WAV; }
+        unsigned int getBitrate() const override { return sampleRate_ * channels_ * 16; }
+        uint64_t getDataBytes() const { return dataBytes_; }
+        unsigned int getSampleRate() const { return sampleRate_; }
+
+    private:
+        static constexpr size_t HEADER_SIZE = 44;
+
+        bool writeHeader();
+        bool writeAll(const void *data, size_t size);
+
+        int fd_ = -1;
+        std::string filePath_;
+        unsigned int sampleRate_ = 0;
+        unsigned int channels_ = 0;
+        uint64_t dataBytes_ = 0;
+};
+
+#endif // WAV_WRITER_HPP_
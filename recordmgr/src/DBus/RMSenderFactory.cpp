@@ -20,6 +20,10 @@ DBusMessage* RMSenderFactory::makeMsgNoti(DBusCommand cmd, bool isSuccess, const
             return makeMsgNoti_CancelRecord(cmd, isSuccess, msgInfo);
         case DBusCommand::FILTER_WAV_FILE_NOTI:
             return makeMsgNoti_FilterWavFile(cmd, isSuccess, msgInfo);
+        case DBusCommand::RECORD_LEVEL_NOTI:
+            return makeMsgNoti_RecordLevel(cmd, isSuccess, msgInfo);
+        case DBusCommand::FILTER_PROGRESS_NOTI:
+            return makeMsgNoti_FilterProgress(cmd, isSuccess, msgInfo);
         default:
             R_LOG(ERROR, "RMSenderFactory makeMsgNoti Error: Unknown DBusCommand");
             return nullptr;
@@ -58,4 +62,20 @@ DBusMessage* RMSenderFactory::makeMsgNoti_FilterWavFile(DBusCommand cmd, bool is
     const char* signalName = "CoreSignal";
 
     return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
-}
\ No newline at end of file
+}
+
+DBusMessage* RMSenderFactory::makeMsgNoti_RecordLevel(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
+    const char* objectPath = "/com/example/coremanager";
+    const char* interfaceName = "com.example.coremanager.interface";
+    const char* signalName = "CoreSignal";
+
+    return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
+}
+
+DBusMessage* RMSenderFactory::makeMsgNoti_FilterProgress(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
+    const char* objectPath = "/com/example/coremanager";
+    const char* interfaceName = "com.example.coremanager.interface";
+    const char* signalName = "CoreSignal";
+
+    return makeMsgNotiInternal(objectPath, interfaceName, signalName, cmd, isSuccess, msgInfo);
+}
@@ -0,0 +1,30 @@
+#include "Biquad.hpp"
+#include <cmath>
+
+namespace {
+    Biquad::Coefficients normalize(double b0, double b1, double b2, double a0, double a1, double a2) {
+        Biquad::Coefficients c;
+        c.b0 = static_cast<float>(b0 / a0);
+        c.b1 = static_cast<float>(b1 / a0);
+        c.b2 = static_cast<float>(b2 / a0);
+        c.a1 = static_cast<float>(a1 / a0);
+        c.a2 = static_cast<float>(a2 / a0);
+        return c;
+    }
+}
+
+Biquad::Coefficients Biquad::highPass(float sampleRate, float cutoffHz, float q) {
+    const double w0 = 2.0 * std::acos(-1.0) * cutoffHz / sampleRate;
+    const double cosW = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+    return normalize((1.0 + cosW) / 2.0, -(1.0 + cosW), (1.0 + cosW) / 2.0,
+                     1.0 + alpha, -2.0 * cosW, 1.0 - alpha);
+}
+
+Biquad::Coefficients Biquad::lowPass(float sampleRate, float cutoffHz, float q) {
+    const double w0 = 2.0 * std::acos(-1.0) * cutoffHz / sampleRate;
+    const double cosW = std::cos(w0);
+    const double alpha = std::sin(w0) / (2.0 * q);
+    return normalize((1.0 - cosW) / 2.0, 1.0 - cosW, (1.0 - cosW) / 2.0,
+                     1.0 + alpha, -2.0 * cosW, 1.0 - alpha);
+}
@@ -0,0 +1,313 @@
+#include "DspKernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if !defined(DSP_FORCE_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define DSP_USE_NEON 1
+#include <arm_neon.h>
+#elif !defined(DSP_FORCE_SCALAR) && defined(__AVX2__)
+#define DSP_USE_AVX2 1
+#define DSP_USE_SSE2 1
+#include <immintrin.h>
+#elif !defined(DSP_FORCE_SCALAR) && defined(__SSE2__)
+#define DSP_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// NOTE: bit-exactness relies on the compiler not fusing a*b+c into FMA in the scalar code,
+// recordmgr builds with -ffp-contract=off for that reason.
+
+namespace {
+    constexpr float INT16_TO_FLOAT = 1.0f / 32768.0f;
+    constexpr float FLOAT_TO_INT16 = 32768.0f;
+    constexpr float INT16_MIN_F = -32768.0f;
+    constexpr float INT16_MAX_F = 32767.0f;
+    constexpr double SILENCE_DBFS = -120.0;
+
+    inline float biquadStep(const BiquadCoefficients &c, float &z1, float &z2, float x) {
+        const float y = c.b0 * x + z1;
+        z1 = c.b1 * x - c.a1 * y + z2;
+        z2 = c.b2 * x - c.a2 * y;
+        return y;
+    }
+}
+
+double PcmLevels::rms() const {
+    return count ? std::sqrt(static_cast<double>(sumSquares) / static_cast<double>(count)) / 32768.0 : 0.0;
+}
+
+double PcmLevels::rmsDbfs() const {
+    const double r = rms();
+    return r > 0.0 ? std::max(20.0 * std::log10(r), SILENCE_DBFS) : SILENCE_DBFS;
+}
+
+double PcmLevels::peakDbfs() const {
+    return peak > 0 ? std::max(20.0 * std::log10(peak / 32768.0), SILENCE_DBFS) : SILENCE_DBFS;
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference
+
+void DspKernels::scalar::int16ToFloat(const int16_t *in, float *out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<float>(in[i]) * INT16_TO_FLOAT;
+    }
+}
+
+void DspKernels::scalar::floatToInt16(const float *in, int16_t *out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float v = std::min(std::max(in[i] * FLOAT_TO_INT16, INT16_MIN_F), INT16_MAX_F);
+        out[i] = static_cast<int16_t>(std::nearbyint(v));
+    }
+}
+
+void DspKernels::scalar::biquad(const BiquadCoefficients &c, BiquadState &s, float *samples, size_t count) {
+    float z1 = s.z1;
+    float z2 = s.z2;
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = biquadStep(c, z1, z2, samples[i]);
+    }
+    s.z1 = z1;
+    s.z2 = z2;
+}
+
+void DspKernels::scalar::biquadPair(const BiquadCoefficients &c0, BiquadState &s0,
+                                    const BiquadCoefficients &c1, BiquadState &s1, float *samples, size_t count) {
+    biquad(c0, s0, samples, count);
+    biquad(c1, s1, samples, count);
+}
+
+PcmLevels DspKernels::scalar::measureLevels(const int16_t *in, size_t count) {
+    PcmLevels levels;
+    int32_t maxV = 0;
+    int32_t minV = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t v = in[i];
+        levels.sumSquares += static_cast<uint64_t>(v * v);
+        maxV = std::max(maxV, v);
+        minV = std::min(minV, v);
+    }
+    levels.peak = std::max(maxV, -minV);
+    levels.count = count;
+    return levels;
+}
+
+// ---------------------------------------------------------------------------
+// Vector versions. Tails shorter than one vector go through the scalar code.
+
+const char *DspKernels::isaName() {
+#if defined(DSP_USE_NEON)
+    return "neon";
+#elif defined(DSP_USE_AVX2)
+    return "avx2";
+#elif defined(DSP_USE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void DspKernels::int16ToFloat(const int16_t *in, float *out, size_t count) {
+    size_t i = 0;
+#if defined(DSP_USE_NEON)
+    const float32x4_t scale = vdupq_n_f32(INT16_TO_FLOAT);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t v = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+#elif defined(DSP_USE_AVX2)
+    const __m256 scale = _mm256_set1_ps(INT16_TO_FLOAT);
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+#elif defined(DSP_USE_SSE2)
+    const __m128 scale = _mm_set1_ps(INT16_TO_FLOAT);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+    scalar::int16ToFloat(in + i, out + i, count - i);
+}
+
+void DspKernels::floatToInt16(const float *in, int16_t *out, size_t count) {
+    size_t i = 0;
+#if defined(DSP_USE_NEON) && defined(__aarch64__)
+    // vcvtnq (round to nearest even) only exists on AArch64, 32-bit NEON uses the scalar loop
+    const float32x4_t scale = vdupq_n_f32(FLOAT_TO_INT16);
+    const float32x4_t lo = vdupq_n_f32(INT16_MIN_F);
+    const float32x4_t hi = vdupq_n_f32(INT16_MAX_F);
+    for (; i + 8 <= count; i += 8) {
+        const float32x4_t a = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i), scale), lo), hi);
+        const float32x4_t b = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i + 4), scale), lo), hi);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+#elif defined(DSP_USE_AVX2)
+    const __m256 scale = _mm256_set1_ps(FLOAT_TO_INT16);
+    const __m256 lo = _mm256_set1_ps(INT16_MIN_F);
+    const __m256 hi = _mm256_set1_ps(INT16_MAX_F);
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), lo), hi);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), lo), hi);
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        // packs works per 128-bit lane, restore sample order
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+#elif defined(DSP_USE_SSE2)
+    const __m128 scale = _mm_set1_ps(FLOAT_TO_INT16);
+    const __m128 lo = _mm_set1_ps(INT16_MIN_F);
+    const __m128 hi = _mm_set1_ps(INT16_MAX_F);
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), lo), hi);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), lo), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#endif
+    scalar::floatToInt16(in + i, out + i, count - i);
+}
+
+void DspKernels::biquad(const BiquadCoefficients &c, BiquadState &s, float *samples, size_t count) {
+    // A single section is one long dependency chain, there is nothing to vectorize
+    scalar::biquad(c, s, samples, count);
+}
+
+void DspKernels::biquadPair(const BiquadCoefficients &c0, BiquadState &s0,
+                            const BiquadCoefficients &c1, BiquadState &s1, float *samples, size_t count) {
+#if defined(DSP_USE_NEON) || defined(DSP_USE_SSE2)
+    if (count == 0) return;
+
+    // Software pipeline: lane 0 runs section 0 on sample i while lane 1 runs section 1
+    // on sample i-1, so the two recursions overlap instead of running back to back.
+    float y0 = biquadStep(c0, s0.z1, s0.z2, samples[0]);
+#if defined(DSP_USE_NEON)
+    const float b0v[2] = {c0.b0, c1.b0}, b1v[2] = {c0.b1, c1.b1}, b2v[2] = {c0.b2, c1.b2};
+    const float a1v[2] = {c0.a1, c1.a1}, a2v[2] = {c0.a2, c1.a2};
+    const float z1v[2] = {s0.z1, s1.z1}, z2v[2] = {s0.z2, s1.z2};
+    const float32x2_t B0 = vld1_f32(b0v), B1 = vld1_f32(b1v), B2 = vld1_f32(b2v);
+    const float32x2_t A1 = vld1_f32(a1v), A2 = vld1_f32(a2v);
+    float32x2_t Z1 = vld1_f32(z1v), Z2 = vld1_f32(z2v);
+    for (size_t i = 1; i < count; ++i) {
+        float32x2_t X = vset_lane_f32(y0, vdup_n_f32(samples[i]), 1);
+        const float32x2_t Y = vadd_f32(vmul_f32(B0, X), Z1);
+        Z1 = vadd_f32(vsub_f32(vmul_f32(B1, X), vmul_f32(A1, Y)), Z2);
+        Z2 = vsub_f32(vmul_f32(B2, X), vmul_f32(A2, Y));
+        y0 = vget_lane_f32(Y, 0);
+        samples[i - 1] = vget_lane_f32(Y, 1);
+    }
+    s0.z1 = vget_lane_f32(Z1, 0); s1.z1 = vget_lane_f32(Z1, 1);
+    s0.z2 = vget_lane_f32(Z2, 0); s1.z2 = vget_lane_f32(Z2, 1);
+#else
+    const __m128 B0 = _mm_setr_ps(c0.b0, c1.b0, 0.0f, 0.0f), B1 = _mm_setr_ps(c0.b1, c1.b1, 0.0f, 0.0f);
+    const __m128 B2 = _mm_setr_ps(c0.b2, c1.b2, 0.0f, 0.0f);
+    const __m128 A1 = _mm_setr_ps(c0.a1, c1.a1, 0.0f, 0.0f), A2 = _mm_setr_ps(c0.a2, c1.a2, 0.0f, 0.0f);
+    __m128 Z1 = _mm_setr_ps(s0.z1, s1.z1, 0.0f, 0.0f);
+    __m128 Z2 = _mm_setr_ps(s0.z2, s1.z2, 0.0f, 0.0f);
+    for (size_t i = 1; i < count; ++i) {
+        const __m128 X = _mm_setr_ps(samples[i], y0, 0.0f, 0.0f);
+        const __m128 Y = _mm_add_ps(_mm_mul_ps(B0, X), Z1);
+        Z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(B1, X), _mm_mul_ps(A1, Y)), Z2);
+        Z2 = _mm_sub_ps(_mm_mul_ps(B2, X), _mm_mul_ps(A2, Y));
+        y0 = _mm_cvtss_f32(Y);
+        samples[i - 1] = _mm_cvtss_f32(_mm_shuffle_ps(Y, Y, 1));
+    }
+    alignas(16) float z1[4];
+    alignas(16) float z2[4];
+    _mm_store_ps(z1, Z1);
+    _mm_store_ps(z2, Z2);
+    s0.z1 = z1[0]; s1.z1 = z1[1];
+    s0.z2 = z2[0]; s1.z2 = z2[1];
+#endif
+    samples[count - 1] = biquadStep(c1, s1.z1, s1.z2, y0);
+#else
+    scalar::biquadPair(c0, s0, c1, s1, samples, count);
+#endif
+}
+
+PcmLevels DspKernels::measureLevels(const int16_t *in, size_t count) {
+    size_t i = 0;
+    uint64_t sumSquares = 0;
+    int32_t maxV = 0;
+    int32_t minV = 0;
+#if defined(DSP_USE_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    int16x8_t vmax = vdupq_n_s16(0);
+    int16x8_t vmin = vdupq_n_s16(0);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t v = vld1q_s16(in + i);
+        // Each square fits in int32 (max 2^30), pairwise-accumulate into int64
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(v), vget_low_s16(v)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(v), vget_high_s16(v)));
+        vmax = vmaxq_s16(vmax, v);
+        vmin = vminq_s16(vmin, v);
+    }
+    sumSquares = static_cast<uint64_t>(vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1));
+    int16_t maxLanes[8];
+    int16_t minLanes[8];
+    vst1q_s16(maxLanes, vmax);
+    vst1q_s16(minLanes, vmin);
+    for (int k = 0; k < 8; ++k) {
+        maxV = std::max<int32_t>(maxV, maxLanes[k]);
+        minV = std::min<int32_t>(minV, minLanes[k]);
+    }
+#elif defined(DSP_USE_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    __m256i vmax = _mm256_setzero_si256();
+    __m256i vmin = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        // madd pair sums are at most 2^31, exact when read as unsigned
+        const __m256i sq = _mm256_madd_epi16(v, v);
+        acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(sq, zero));
+        acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(sq, zero));
+        vmax = _mm256_max_epi16(vmax, v);
+        vmin = _mm256_min_epi16(vmin, v);
+    }
+    alignas(32) uint64_t accLanes[4];
+    alignas(32) int16_t maxLanes[16];
+    alignas(32) int16_t minLanes[16];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(accLanes), acc);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(maxLanes), vmax);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(minLanes), vmin);
+    sumSquares = accLanes[0] + accLanes[1] + accLanes[2] + accLanes[3];
+    for (int k = 0; k < 16; ++k) {
+        maxV = std::max<int32_t>(maxV, maxLanes[k]);
+        minV = std::min<int32_t>(minV, minLanes[k]);
+    }
+#elif defined(DSP_USE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    __m128i vmax = _mm_setzero_si128();
+    __m128i vmin = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const __m128i sq = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+        vmax = _mm_max_epi16(vmax, v);
+        vmin = _mm_min_epi16(vmin, v);
+    }
+    alignas(16) uint64_t accLanes[2];
+    alignas(16) int16_t maxLanes[8];
+    alignas(16) int16_t minLanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(accLanes), acc);
+    _mm_store_si128(reinterpret_cast<__m128i *>(maxLanes), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i *>(minLanes), vmin);
+    sumSquares = accLanes[0] + accLanes[1];
+    for (int k = 0; k < 8; ++k) {
+        maxV = std::max<int32_t>(maxV, maxLanes[k]);
+        minV = std::min<int32_t>(minV, minLanes[k]);
+    }
+#endif
+    const PcmLevels tail = scalar::measureLevels(in + i, count - i);
+    PcmLevels levels;
+    levels.sumSquares = sumSquares + tail.sumSquares;
+    levels.peak = std::max({maxV, -minV, tail.peak});
+    levels.count = count;
+    return levels;
+}
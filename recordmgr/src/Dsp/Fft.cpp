@@ -0,0 +1,50 @@
+#include "Fft.hpp"
+#include <cmath>
+#include <utility>
+
+Fft::Fft(size_t size) : size_(size), twiddles_(size / 2), bitReverse_(size) {
+    const double pi = std::acos(-1.0);
+    for (size_t i = 0; i < size / 2; ++i) {
+        const double angle = -2.0 * pi * static_cast<double>(i) / static_cast<double>(size);
+        twiddles_[i] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < size) ++bits;
+    for (size_t i = 0; i < size; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            if (i & (static_cast<size_t>(1) << b)) r |= static_cast<size_t>(1) << (bits - 1 - b);
+        }
+        bitReverse_[i] = r;
+    }
+}
+
+void Fft::inverse(std::complex<float> *data) const {
+    transform(data, true);
+    const float scale = 1.0f / static_cast<float>(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        data[i] *= scale;
+    }
+}
+
+void Fft::transform(std::complex<float> *data, bool inverse) const {
+    for (size_t i = 0; i < size_; ++i) {
+        const size_t j = bitReverse_[i];
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    for (size_t len = 2; len <= size_; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = size_ / len;
+        for (size_t start = 0; start < size_; start += len) {
+            for (size_t k = 0; k < half; ++k) {
+                std::complex<float> w = twiddles_[k * step];
+                if (inverse) w = std::conj(w);
+                const std::complex<float> t = w * data[start + k + half];
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
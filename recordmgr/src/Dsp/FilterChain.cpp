@@ -0,0 +1,102 @@
+#include "FilterChain.hpp"
+#include "Config.hpp"
+#include "DspKernels.hpp"
+#include <algorithm>
+
+namespace {
+    SpectralGate::Params gateParams(const FilterChain::Params &params) {
+        SpectralGate::Params gate = params.gate;
+        gate.profileSamples = static_cast<size_t>(params.sampleRate) * params.noiseProfileMs / 1000;
+        return gate;
+    }
+}
+
+FilterChain::Params FilterChain::defaultParams(unsigned int sampleRate, unsigned int channels) {
+    const Config *config = CONFIG_INSTANCE();
+    Params params;
+    params.sampleRate = sampleRate;
+    params.channels = channels;
+    params.highPassHz = config->getFilterHighPassHz();
+    params.lowPassHz = config->getFilterLowPassHz();
+    params.noiseProfileMs = config->getNoiseProfileMs();
+    params.gate.frameSize = config->getNoiseGateFrameSize();
+    params.gate.threshold = config->getNoiseGateThreshold();
+    params.gate.floorGain = config->getNoiseGateFloorGain();
+    params.gate.release = config->getNoiseGateRelease();
+    return params;
+}
+
+FilterChain::FilterChain(const Params &params)
+    : channels_(std::max(params.channels, 1u)),
+      highPass_(channels_, Biquad(Biquad::highPass(static_cast<float>(params.sampleRate), params.highPassHz))),
+      lowPass_(channels_, Biquad(Biquad::lowPass(static_cast<float>(params.sampleRate), params.lowPassHz))),
+      gates_(channels_, SpectralGate(gateParams(params))),
+      gated_(channels_) {
+}
+
+void FilterChain::process(const int16_t *in, size_t count, std::vector<int16_t> &out) {
+    const size_t frames = count / channels_;
+    scratch_.resize(frames * channels_);
+    DspKernels::int16ToFloat(in, scratch_.data(), frames * channels_);
+
+    if (channels_ == 1) {
+        Biquad::processPair(highPass_[0], lowPass_[0], scratch_.data(), frames);
+        gated_[0].clear();
+        gates_[0].process(scratch_.data(), frames, gated_[0]);
+        convertOut(out);
+        return;
+    }
+
+    // Planar per channel, the filters and the gate work on contiguous samples
+    interleaved_.swap(scratch_);
+    scratch_.resize(frames);
+    for (unsigned int c = 0; c < channels_; ++c) {
+        for (size_t i = 0; i < frames; ++i) {
+            scratch_[i] = interleaved_[i * channels_ + c];
+        }
+        Biquad::processPair(highPass_[c], lowPass_[c], scratch_.data(), frames);
+        gated_[c].clear();
+        gates_[c].process(scratch_.data(), frames, gated_[c]);
+    }
+    convertOut(out);
+}
+
+void FilterChain::flush(std::vector<int16_t> &out) {
+    for (unsigned int c = 0; c < channels_; ++c) {
+        gated_[c].clear();
+        gates_[c].flush(gated_[c]);
+        highPass_[c].reset();
+        lowPass_[c].reset();
+    }
+    convertOut(out);
+}
+
+void FilterChain::reset() {
+    for (unsigned int c = 0; c < channels_; ++c) {
+        highPass_[c].reset();
+        lowPass_[c].reset();
+        gates_[c].reset();
+    }
+}
+
+void FilterChain::convertOut(std::vector<int16_t> &out) {
+    if (channels_ == 1) {
+        out.resize(gated_[0].size());
+        DspKernels::floatToInt16(gated_[0].data(), out.data(), gated_[0].size());
+        return;
+    }
+
+    // Every gate got the same input length, so they hold the same number of samples
+    size_t frames = gated_[0].size();
+    for (unsigned int c = 1; c < channels_; ++c) {
+        frames = std::min(frames, gated_[c].size());
+    }
+    interleaved_.resize(frames * channels_);
+    for (unsigned int c = 0; c < channels_; ++c) {
+        for (size_t i = 0; i < frames; ++i) {
+            interleaved_[i * channels_ + c] = gated_[c][i];
+        }
+    }
+    out.resize(interleaved_.size());
+    DspKernels::floatToInt16(interleaved_.data(), out.data(), interleaved_.size());
+}
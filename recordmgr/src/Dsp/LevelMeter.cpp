@@ -0,0 +1,62 @@
+#include "LevelMeter.hpp"
+#include <algorithm>
+
+LevelMeter::LevelMeter(size_t waveformBucketSamples, size_t waveformCapacity)
+    : waveform_(waveformCapacity), bucketSamples_(std::max<size_t>(waveformBucketSamples, 1)) {}
+
+void LevelMeter::process(const int16_t *samples, size_t count) {
+    uint64_t sumSquares = 0;
+    int32_t peak = 0;
+
+    // Walk the block in bucket-aligned slices so each waveform point covers exactly bucketSamples_
+    size_t pos = 0;
+    while (pos < count) {
+        const size_t n = std::min(count - pos, bucketSamples_ - bucketFill_);
+        const PcmLevels levels = DspKernels::measureLevels(samples + pos, n);
+        sumSquares += levels.sumSquares;
+        peak = std::max(peak, levels.peak);
+        bucketPeak_ = std::max(bucketPeak_, levels.peak);
+        bucketFill_ += n;
+        pos += n;
+
+        if (bucketFill_ == bucketSamples_) {
+            // 32768 (a -32768 sample) does not fit an int16 point
+            const int16_t point = static_cast<int16_t>(std::min<int32_t>(bucketPeak_, 32767));
+            waveform_.write(&point, 1);     // a full ring drops points, the publisher is behind anyway
+            bucketFill_ = 0;
+            bucketPeak_ = 0;
+        }
+    }
+
+    sumSquares_.fetch_add(sumSquares, std::memory_order_relaxed);
+    count_.fetch_add(count, std::memory_order_relaxed);
+    // Single producer: nobody else raises peak_, the consumer only clears it
+    int32_t current = peak_.load(std::memory_order_relaxed);
+    while (peak > current && !peak_.compare_exchange_weak(current, peak, std::memory_order_relaxed)) {
+    }
+}
+
+PcmLevels LevelMeter::takeLevels() {
+    // The three fields are taken separately; a block landing in between only
+    // shifts a few samples into the next reading
+    PcmLevels levels;
+    levels.sumSquares = sumSquares_.exchange(0, std::memory_order_relaxed);
+    levels.count = static_cast<size_t>(count_.exchange(0, std::memory_order_relaxed));
+    levels.peak = peak_.exchange(0, std::memory_order_relaxed);
+    return levels;
+}
+
+size_t LevelMeter::takeWaveform(int16_t *peaks, size_t maxPoints) {
+    const size_t count = std::min(maxPoints, waveform_.readAvailable());
+    return waveform_.read(peaks, count);
+}
+
+void LevelMeter::reset(size_t waveformBucketSamples) {
+    waveform_.reset();
+    bucketSamples_ = std::max<size_t>(waveformBucketSamples, 1);
+    bucketFill_ = 0;
+    bucketPeak_ = 0;
+    sumSquares_ = 0;
+    count_ = 0;
+    peak_ = 0;
+}
@@ -0,0 +1,162 @@
+#include "PeakPyramid.hpp"
+#include "RLogger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    const char MAGIC[4] = {'P', 'K', 'S', '1'};
+    // Stop adding levels once the top one is this small
+    constexpr size_t MIN_TOP_POINTS = 64;
+
+    void putU16(std::string &out, uint16_t v) { out += static_cast<char>(v & 0xFF); out += static_cast<char>(v >> 8); }
+    void putU32(std::string &out, uint32_t v) { putU16(out, v & 0xFFFF); putU16(out, static_cast<uint16_t>(v >> 16)); }
+
+    bool getU16(std::istream &in, uint16_t &v) {
+        uint8_t b[2];
+        if (!in.read(reinterpret_cast<char *>(b), 2)) return false;
+        v = static_cast<uint16_t>(b[0] | (b[1] << 8));
+        return true;
+    }
+    bool getU32(std::istream &in, uint32_t &v) {
+        uint16_t lo, hi;
+        if (!getU16(in, lo) || !getU16(in, hi)) return false;
+        v = lo | (static_cast<uint32_t>(hi) << 16);
+        return true;
+    }
+}
+
+void PeakPyramid::reset(unsigned int sampleRate, unsigned int channels, unsigned int baseFrames, unsigned int factor) {
+    sampleRate_ = sampleRate;
+    channels_ = std::max(channels, 1u);
+    baseFrames_ = std::max(baseFrames, 1u);
+    factor_ = std::max(factor, 2u);
+    levels_.assign(1, Level());
+    levels_[0].framesPerPoint = baseFrames_;
+    bucketSamples_ = static_cast<size_t>(baseFrames_) * channels_;
+    bucketFill_ = 0;
+}
+
+void PeakPyramid::add(const int16_t *samples, size_t count) {
+    if (levels_.empty()) return;
+
+    for (size_t i = 0; i < count; ++i) {
+        const int16_t s = samples[i];
+        if (bucketFill_ == 0) {
+            bucketMin_ = s;
+            bucketMax_ = s;
+        } else {
+            bucketMin_ = std::min(bucketMin_, s);
+            bucketMax_ = std::max(bucketMax_, s);
+        }
+        if (++bucketFill_ == bucketSamples_) {
+            flushBucket();
+        }
+    }
+}
+
+void PeakPyramid::flushBucket() {
+    // Arithmetic shift keeps the sign: -32768 -> -128, 32767 -> 127
+    levels_[0].minMax.push_back(static_cast<int8_t>(bucketMin_ >> 8));
+    levels_[0].minMax.push_back(static_cast<int8_t>(bucketMax_ >> 8));
+    bucketFill_ = 0;
+}
+
+void PeakPyramid::finish() {
+    if (levels_.empty()) return;
+    if (bucketFill_ > 0) {
+        flushBucket();
+    }
+    levels_.resize(1);
+
+    while (levels_.back().points() > MIN_TOP_POINTS) {
+        const Level &fine = levels_.back();
+        Level coarse;
+        coarse.framesPerPoint = fine.framesPerPoint * factor_;
+        coarse.minMax.reserve((fine.points() / factor_ + 1) * 2);
+        for (size_t p = 0; p < fine.points(); p += factor_) {
+            const size_t end = std::min(p + factor_, fine.points());
+            int8_t lo = fine.minMax[p * 2];
+            int8_t hi = fine.minMax[p * 2 + 1];
+            for (size_t q = p + 1; q < end; ++q) {
+                lo = std::min(lo, fine.minMax[q * 2]);
+                hi = std::max(hi, fine.minMax[q * 2 + 1]);
+            }
+            coarse.minMax.push_back(lo);
+            coarse.minMax.push_back(hi);
+        }
+        levels_.push_back(std::move(coarse));
+    }
+}
+
+bool PeakPyramid::save(const std::string &filePath) const {
+    std::string out(MAGIC, sizeof(MAGIC));
+    putU32(out, sampleRate_);
+    putU32(out, baseFrames_);
+    putU16(out, static_cast<uint16_t>(factor_));
+    putU16(out, static_cast<uint16_t>(levels_.size()));
+    for (const Level &level : levels_) {
+        putU32(out, static_cast<uint32_t>(level.points()));
+        out.append(reinterpret_cast<const char *>(level.minMax.data()), level.minMax.size());
+    }
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        R_LOG(ERROR, "Failed to write peak file %s", filePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PeakPyramid::load(const std::string &filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    char magic[4];
+    uint32_t sampleRate, baseFrames;
+    uint16_t factor, levelCount;
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !getU32(file, sampleRate) || !getU32(file, baseFrames) || !getU16(file, factor) || !getU16(file, levelCount)) {
+        R_LOG(ERROR, "Invalid peak file %s", filePath.c_str());
+        return false;
+    }
+
+    reset(sampleRate, 1, baseFrames, factor);
+    levels_.clear();
+    uint32_t framesPerPoint = baseFrames_;
+    for (uint16_t i = 0; i < levelCount; ++i, framesPerPoint *= factor_) {
+        uint32_t points;
+        if (!getU32(file, points)) return false;
+        Level level;
+        level.framesPerPoint = framesPerPoint;
+        level.minMax.resize(static_cast<size_t>(points) * 2);
+        if (!file.read(reinterpret_cast<char *>(level.minMax.data()), static_cast<std::streamsize>(level.minMax.size()))) {
+            R_LOG(ERROR, "Truncated peak file %s", filePath.c_str());
+            return false;
+        }
+        levels_.push_back(std::move(level));
+    }
+    return !levels_.empty();
+}
+
+std::vector<int8_t> PeakPyramid::thumbnail(size_t points) const {
+    std::vector<int8_t> out;
+    if (levels_.empty() || levels_[0].points() == 0 || points == 0) {
+        return out;
+    }
+
+    const Level &base = levels_[0];
+    const size_t n = base.points();
+    out.reserve(points * 2);
+    for (size_t i = 0; i < points; ++i) {
+        const size_t begin = i * n / points;
+        const size_t end = std::max((i + 1) * n / points, begin + 1);
+        int8_t lo = base.minMax[begin * 2];
+        int8_t hi = base.minMax[begin * 2 + 1];
+        for (size_t q = begin + 1; q < end; ++q) {
+            lo = std::min(lo, base.minMax[q * 2]);
+            hi = std::max(hi, base.minMax[q * 2 + 1]);
+        }
+        out.push_back(lo);
+        out.push_back(hi);
+    }
+    return out;
+}
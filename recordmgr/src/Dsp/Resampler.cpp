@@ -0,0 +1,105 @@
+#include "Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    // Zeroth-order modified Bessel function, power series
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        const double q = x * x / 4.0;
+        for (int k = 1; k < 50 && term > sum * 1e-12; ++k) {
+            term *= q / (static_cast<double>(k) * k);
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+void Resampler::reset(unsigned int inRate, unsigned int outRate, unsigned int channels, const Params &params) {
+    inRate_ = inRate;
+    outRate_ = outRate;
+    channels_ = std::max(channels, 1u);
+    const unsigned int g = std::gcd(inRate, outRate);
+    up_ = g > 0 ? outRate / g : 1;
+    down_ = g > 0 ? inRate / g : 1;
+    history_.clear();
+    base_ = 0;
+    phase_ = 0;
+    if (isPassthrough()) {
+        taps_ = 0;
+        coeffs_.clear();
+        return;
+    }
+
+    // Cutoff in cycles per input sample; downsampling widens the kernel by the same factor
+    const double ratio = static_cast<double>(outRate) / inRate;
+    const double fc = 0.5 * params.cutoff * std::min(1.0, ratio);
+    const double halfWidth = params.zeroCrossings / (2.0 * fc);
+    const size_t centre = static_cast<size_t>(std::ceil(halfWidth));
+    taps_ = 2 * centre + 1;
+    const double i0Beta = besselI0(params.kaiserBeta);
+    const double pi = std::acos(-1.0);
+
+    coeffs_.assign(static_cast<size_t>(up_) * taps_, 0.0f);
+    std::vector<double> h(taps_);
+    for (unsigned int p = 0; p < up_; ++p) {
+        // Output phase p lies p/L input samples after the first tap's centre
+        const double offset = static_cast<double>(centre) + static_cast<double>(p) / up_;
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_; ++k) {
+            h[k] = 0.0;
+            const double x = static_cast<double>(k) - offset;
+            const double r = x / halfWidth;
+            if (std::fabs(r) >= 1.0) continue;
+            const double arg = 2.0 * fc * x;
+            const double sinc = std::fabs(arg) < 1e-12 ? 1.0 : std::sin(pi * arg) / (pi * arg);
+            h[k] = 2.0 * fc * sinc * besselI0(params.kaiserBeta * std::sqrt(1.0 - r * r)) / i0Beta;
+            sum += h[k];
+        }
+        // Unity DC gain for every phase, otherwise the phases ripple against each other
+        for (size_t k = 0; k < taps_; ++k) {
+            coeffs_[p * taps_ + k] = static_cast<float>(sum != 0.0 ? h[k] / sum : 0.0);
+        }
+    }
+
+    // Leading zeros put the kernel centre on the first input frame
+    history_.assign(centre * channels_, 0.0f);
+}
+
+void Resampler::reserve(size_t maxFrames) {
+    // Fewer than taps_ frames are left in history_ between calls
+    history_.reserve((taps_ + maxFrames) * channels_);
+}
+
+void Resampler::process(const float *in, size_t frames, std::vector<float> &out) {
+    if (isPassthrough()) {
+        out.insert(out.end(), in, in + frames * channels_);
+        return;
+    }
+
+    history_.insert(history_.end(), in, in + frames * channels_);
+    const size_t available = history_.size() / channels_;
+    out.reserve(out.size() + (frames * up_ / down_ + 1) * channels_);
+
+    while (base_ + taps_ <= available) {
+        const float *taps = coeffs_.data() + static_cast<size_t>(phase_) * taps_;
+        const float *x = history_.data() + base_ * channels_;
+        for (unsigned int c = 0; c < channels_; ++c) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < taps_; ++k) {
+                acc += taps[k] * x[k * channels_ + c];
+            }
+            out.push_back(acc);
+        }
+        phase_ += down_;
+        base_ += phase_ / up_;
+        phase_ %= up_;
+    }
+
+    // Keep only what the next outputs still need
+    const size_t consumed = std::min(base_, available);
+    history_.erase(history_.begin(), history_.begin() + static_cast<std::ptrdiff_t>(consumed * channels_));
+    base_ -= consumed;
+}
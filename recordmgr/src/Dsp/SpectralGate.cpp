@@ -0,0 +1,146 @@
+#include "SpectralGate.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+SpectralGate::SpectralGate(const Params &params)
+    : params_(params), hop_(params.frameSize / 2), fft_(params.frameSize),
+      window_(params.frameSize), spectrum_(params.frameSize),
+      noise_(params.frameSize / 2 + 1, 0.0f), gains_(params.frameSize / 2 + 1, 1.0f),
+      inFifo_(params.frameSize, 0.0f), outAccum_(params.frameSize, 0.0f) {
+    // Periodic sqrt-Hann: squared windows at 50% overlap sum to exactly 1
+    const double pi = std::acos(-1.0);
+    for (size_t n = 0; n < params_.frameSize; ++n) {
+        window_[n] = static_cast<float>(std::sin(pi * static_cast<double>(n) / static_cast<double>(params_.frameSize)));
+    }
+    learnBuffer_.reserve(params_.profileSamples);
+    reset();
+}
+
+void SpectralGate::reset() {
+    std::fill(noise_.begin(), noise_.end(), 0.0f);
+    std::fill(gains_.begin(), gains_.end(), 1.0f);
+    learnBuffer_.clear();
+    profileReady_ = (params_.profileSamples == 0);
+
+    // Warm-up prefix so the first real sample lands in a fully overlapped region
+    std::fill(inFifo_.begin(), inFifo_.end(), 0.0f);
+    inFill_ = params_.frameSize - hop_;
+    std::fill(outAccum_.begin(), outAccum_.end(), 0.0f);
+    inputCount_ = 0;
+    emitted_ = 0;
+    emitLimit_ = UINT64_MAX;
+}
+
+void SpectralGate::process(const float *in, size_t count, std::vector<float> &out) {
+    if (!profileReady_) {
+        const size_t take = std::min(count, params_.profileSamples - learnBuffer_.size());
+        learnBuffer_.insert(learnBuffer_.end(), in, in + take);
+        in += take;
+        count -= take;
+        if (learnBuffer_.size() < params_.profileSamples) {
+            return;
+        }
+        buildProfile();
+        feed(learnBuffer_.data(), learnBuffer_.size(), out);
+    }
+    feed(in, count, out);
+}
+
+void SpectralGate::flush(std::vector<float> &out) {
+    if (!profileReady_) {
+        // Session shorter than the profile window: profile whatever we have
+        buildProfile();
+        feed(learnBuffer_.data(), learnBuffer_.size(), out);
+    }
+
+    // Push zeros until every real sample has left the overlap-add accumulator
+    emitLimit_ = inputCount_ + (params_.frameSize - hop_);
+    const std::vector<float> zeros(hop_, 0.0f);
+    while (emitted_ < emitLimit_) {
+        const uint64_t realInput = inputCount_;
+        feed(zeros.data(), zeros.size(), out);
+        inputCount_ = realInput;
+    }
+    reset();
+}
+
+void SpectralGate::buildProfile() {
+    const size_t n = params_.frameSize;
+    const size_t bins = n / 2 + 1;
+    size_t frames = 0;
+
+    // At least one (zero padded) frame, then every full frame of the learn buffer
+    size_t start = 0;
+    do {
+        for (size_t i = 0; i < n; ++i) {
+            const float x = (start + i < learnBuffer_.size()) ? learnBuffer_[start + i] : 0.0f;
+            spectrum_[i] = std::complex<float>(x * window_[i], 0.0f);
+        }
+        fft_.forward(spectrum_.data());
+        for (size_t k = 0; k < bins; ++k) {
+            noise_[k] += std::abs(spectrum_[k]);
+        }
+        ++frames;
+        start += hop_;
+    } while (start + n <= learnBuffer_.size());
+
+    for (size_t k = 0; k < bins; ++k) {
+        noise_[k] /= static_cast<float>(frames);
+    }
+    profileReady_ = true;
+}
+
+void SpectralGate::feed(const float *in, size_t count, std::vector<float> &out) {
+    const size_t n = params_.frameSize;
+    while (count > 0) {
+        const size_t take = std::min(count, n - inFill_);
+        memcpy(inFifo_.data() + inFill_, in, take * sizeof(float));
+        inFill_ += take;
+        inputCount_ += take;
+        in += take;
+        count -= take;
+
+        if (inFill_ == n) {
+            processFrame(out);
+            memmove(inFifo_.data(), inFifo_.data() + hop_, (n - hop_) * sizeof(float));
+            inFill_ = n - hop_;
+        }
+    }
+}
+
+void SpectralGate::processFrame(std::vector<float> &out) {
+    const size_t n = params_.frameSize;
+    const size_t bins = n / 2 + 1;
+
+    for (size_t i = 0; i < n; ++i) {
+        spectrum_[i] = std::complex<float>(inFifo_[i] * window_[i], 0.0f);
+    }
+    fft_.forward(spectrum_.data());
+
+    for (size_t k = 0; k < bins; ++k) {
+        const float target = (std::abs(spectrum_[k]) > params_.threshold * noise_[k]) ? 1.0f : params_.floorGain;
+        // Open instantly, close smoothly to limit musical noise
+        const float gain = (target >= gains_[k]) ? target : gains_[k] * params_.release + target * (1.0f - params_.release);
+        gains_[k] = gain;
+        spectrum_[k] *= gain;
+        if (k > 0 && k < n / 2) {
+            spectrum_[n - k] *= gain;
+        }
+    }
+    fft_.inverse(spectrum_.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        outAccum_[i] += spectrum_[i].real() * window_[i];
+    }
+
+    // The first hop is complete, drop the warm-up prefix and anything past the flush limit
+    const uint64_t prefix = n - hop_;
+    for (size_t i = 0; i < hop_; ++i, ++emitted_) {
+        if (emitted_ >= prefix && emitted_ < emitLimit_) {
+            out.push_back(outAccum_[i]);
+        }
+    }
+    memmove(outAccum_.data(), outAccum_.data() + hop_, (n - hop_) * sizeof(float));
+    std::fill(outAccum_.begin() + (n - hop_), outAccum_.end(), 0.0f);
+}
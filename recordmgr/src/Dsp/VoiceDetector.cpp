@@ -0,0 +1,54 @@
+#include "VoiceDetector.hpp"
+#include "DspKernels.hpp"
+#include <algorithm>
+
+namespace {
+    // Noise floor follows quieter frames quickly and louder ones slowly, and creeps up
+    // even through "speech" so a steady loud noise is absorbed after a few seconds
+    // while word gaps keep pulling it back down
+    constexpr float FLOOR_FALL = 0.5f;
+    constexpr float FLOOR_RISE = 0.02f;
+    constexpr float FLOOR_RISE_ACTIVE = 0.005f;
+    constexpr float FLOOR_MIN_DB = -90.0f;
+}
+
+void VoiceDetector::reset(unsigned int sampleRate, unsigned int channels, const Params &params) {
+    params_ = params;
+    channels_ = std::max(channels, 1u);
+    frameSamples_ = std::max<size_t>(static_cast<size_t>(sampleRate) * channels_ * params.frameMs / 1000, channels_);
+    hangoverFrames_ = params.hangoverMs / std::max(params.frameMs, 1u);
+    hangoverLeft_ = 0;
+    noiseFloorDb_ = FLOOR_MIN_DB;
+    floorInitialized_ = false;
+}
+
+bool VoiceDetector::classify(const int16_t *frame, size_t count) {
+    if (count == 0) return hangoverLeft_ > 0;
+
+    const float energyDb = static_cast<float>(DspKernels::measureLevels(frame, count).rmsDbfs());
+
+    // Zero crossings of the first channel
+    size_t crossings = 0;
+    for (size_t i = channels_; i < count; i += channels_) {
+        crossings += (frame[i] < 0) != (frame[i - channels_] < 0);
+    }
+    const float zcr = static_cast<float>(crossings) * channels_ / static_cast<float>(count);
+
+    if (!floorInitialized_) {
+        // A recording may start mid-sentence, never take speech as the floor
+        noiseFloorDb_ = std::clamp(energyDb, FLOOR_MIN_DB, params_.minSpeechDbfs);
+        floorInitialized_ = true;
+    }
+
+    const bool active = energyDb > std::max(noiseFloorDb_ + params_.thresholdDb, params_.minSpeechDbfs) &&
+                        zcr < params_.maxZeroCrossRate;
+    if (active) {
+        hangoverLeft_ = hangoverFrames_ + 1;
+    }
+    const float rate = energyDb < noiseFloorDb_ ? FLOOR_FALL : (active ? FLOOR_RISE_ACTIVE : FLOOR_RISE);
+    noiseFloorDb_ = std::max(noiseFloorDb_ + rate * (energyDb - noiseFloorDb_), FLOOR_MIN_DB);
+
+    if (hangoverLeft_ == 0) return false;
+    --hangoverLeft_;
+    return true;
+}
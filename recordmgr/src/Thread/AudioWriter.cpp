@@ -0,0 +1,431 @@
+#include "AudioWriter.hpp"
+#include "Config.hpp"
+#include "RLogger.hpp"
+#include "RecordingJournal.hpp"
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+namespace {
+    VoiceDetector::Params vadParams() {
+        VoiceDetector::Params params;
+        params.frameMs = CONFIG_INSTANCE()->getVadFrameMs();
+        params.thresholdDb = CONFIG_INSTANCE()->getVadThresholdDb();
+        params.minSpeechDbfs = CONFIG_INSTANCE()->getVadMinSpeechDbfs();
+        params.hangoverMs = CONFIG_INSTANCE()->getVadHangoverMs();
+        return params;
+    }
+
+    void removeWithSidecar(const std::string &filePath) {
+        std::error_code ec;
+        std::filesystem::remove(filePath, ec);
+        std::filesystem::remove(PeakPyramid::sidecarPath(filePath), ec);
+    }
+}
+
+AudioWriter::AudioWriter(const std::string &sessionId, unsigned int channels) : ThreadBase("AudioWriter[" + sessionId + "]"),
+    sessionId_(sessionId), ring_(static_cast<size_t>(CONFIG_INSTANCE()->getSampleRate()) * std::max(channels, 1u) *
+          CONFIG_INSTANCE()->getPcmRingCapacityMs() / 1000) {
+    R_LOG(INFO, "PCM ring capacity: %zu samples", ring_.capacity());
+}
+
+void AudioWriter::stop() {
+    ThreadBase::stop();
+    cv_.notify_all();
+}
+
+bool AudioWriter::beginSession(const std::string &filePath, unsigned int sampleRate, unsigned int channels,
+                               bool filterStreaming, AudioCodec codec) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (sessionActive_) {
+        R_LOG(WARN, "AudioWriter session already active (%s)", sink_->getFilePath().c_str());
+        return false;
+    }
+    if (!sink_ || sink_->getCodec() != codec) {
+        sink_ = AudioSink::create(codec);
+    }
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    filterStreaming_ = filterStreaming;
+    if (!openSink(filePath)) {
+        return false;
+    }
+    // Producer is not running yet, so the ring can be reset safely
+    ring_.reset();
+
+    if (filterStreaming_) {
+        peaks_.reset(sampleRate, channels, CONFIG_INSTANCE()->getPeakBaseFrames(), CONFIG_INSTANCE()->getPeakLevelFactor());
+        if (!filterChain_ || filterSampleRate_ != sampleRate || filterChannels_ != channels) {
+            filterChain_ = std::make_unique<FilterChain>(FilterChain::defaultParams(sampleRate, channels));
+            filterSampleRate_ = sampleRate;
+            filterChannels_ = channels;
+        } else {
+            filterChain_->reset();
+        }
+    }
+
+    vadEnabled_ = CONFIG_INSTANCE()->isVadEnabled();
+    if (vadEnabled_) {
+        // Whole frames, so trimming never cuts between the channels of one frame
+        auto msToSamples = [sampleRate, channels](unsigned int ms) {
+            return static_cast<size_t>(static_cast<uint64_t>(sampleRate) * ms / 1000) * channels;
+        };
+        splitSamples_ = msToSamples(CONFIG_INSTANCE()->getVadSplitSilenceMs());
+        holdSilence_ = CONFIG_INSTANCE()->isVadTrimEnabled() || splitSamples_ > 0;
+        marginSamples_ = msToSamples(CONFIG_INSTANCE()->getVadMarginMs());
+        holdCapSamples_ = std::max<size_t>(msToSamples(CONFIG_INSTANCE()->getVadMaxHoldMs()),
+                                           static_cast<size_t>(splitSamples_) + marginSamples_);
+        vad_.reset(sampleRate, channels, vadParams());
+        vadFrame_.clear();
+        vadFrame_.reserve(vad_.frameSamples());
+        held_.clear();
+        held_.reserve(holdCapSamples_ + vad_.frameSamples());
+    }
+    untrimmedLead_ = vadEnabled_ && holdSilence_;
+    silenceSamples_ = 0;
+    silenceMs_ = 0;
+    heardSpeech_ = false;
+    segmentOpen_ = true;
+    basePath_ = filePath;
+    segmentIndex_ = 1;
+    segments_.clear();
+
+    writeError_ = false;
+    sessionActive_ = true;
+    return true;
+}
+
+void AudioWriter::pushBlock(const int16_t *samples, size_t sampleCount) {
+    if (sampleCount == 0 || !sessionActive_) return;
+
+    // Only the first overrun is logged here, the session summary has the totals
+    if (ring_.write(samples, sampleCount, channels_) < sampleCount && ring_.getStats().overruns == 1) {
+        R_LOG(WARN, "PCM ring overrun, writer is %zu samples behind", ring_.readAvailable());
+    }
+    cv_.notify_one();
+}
+
+bool AudioWriter::endSession(std::vector<AudioFileInfo> &files) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    files.clear();
+    if (!sessionActive_) return false;
+
+    // Capture has stopped; write whatever the writer thread has not reached yet
+    drainRing();
+    if (filterStreaming_ && !writeError_) {
+        // Tail still inside the STFT overlap
+        filterChain_->flush(filtered_);
+        if (!(vadEnabled_ ? gateSamples(filtered_.data(), filtered_.size()) : writeOut(filtered_.data(), filtered_.size()))) {
+            writeError_ = true;
+        }
+    }
+    if (vadEnabled_ && !writeError_ && !finishGate()) {
+        writeError_ = true;
+    }
+    sessionActive_ = false;
+
+    const PcmRingStats stats = ring_.getStats();
+    const unsigned int samplesPerMs = sampleRate_ * channels_ / 1000;
+    R_LOG(INFO, "PCM ring stats: capacity=%zu high-water=%zu (%zu ms) overruns=%llu dropped=%llu underruns=%llu",
+          stats.capacity, stats.highWater, samplesPerMs ? stats.highWater / samplesPerMs : 0,
+          static_cast<unsigned long long>(stats.overruns), static_cast<unsigned long long>(stats.droppedSamples),
+          static_cast<unsigned long long>(stats.underruns));
+
+    if (writeError_) {
+        if (segmentOpen_) {
+            abortSink();
+        }
+        for (const AudioFileInfo &segment : segments_) {
+            removeWithSidecar(segment.filePath);
+        }
+        segments_.clear();
+        return false;
+    }
+    if (segmentOpen_) {
+        if (untrimmedLead_) {
+            R_LOG(INFO, "No speech detected, keeping %s untrimmed", sinkPath_.c_str());
+            if (!closeSegment()) {
+                return false;
+            }
+        } else if (holdSilence_ && !heardSpeech_) {
+            abortSink();        // nothing but silence since the split
+            segmentOpen_ = false;
+        } else if (!closeSegment()) {
+            return false;
+        }
+    }
+    files = std::move(segments_);
+    segments_.clear();
+    return true;
+}
+
+void AudioWriter::finishPeaks(const std::string &filePath) {
+    if (filterStreaming_) {
+        // Final audio, so the waveform summary can be stored now; the raw path gets one from the filter pass
+        peaks_.finish();
+        peaks_.save(PeakPyramid::sidecarPath(filePath));
+    }
+}
+
+bool AudioWriter::openSink(const std::string &filePath) {
+    // Write to a part file next to a journal until the file is complete, see RecordingJournal
+    RecordingJournal::Entry entry;
+    entry.codec = sink_->getCodec();
+    entry.sampleRate = sampleRate_;
+    entry.channels = channels_;
+    entry.filtered = filterStreaming_;
+    entry.sessionId = sessionId_;
+    if (!RecordingJournal::write(filePath, entry)) {
+        return false;
+    }
+    if (!sink_->open(RecordingJournal::partPath(filePath), sampleRate_, channels_)) {
+        RecordingJournal::remove(filePath);
+        return false;
+    }
+    sinkPath_ = filePath;
+    lastSync_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+void AudioWriter::abortSink() {
+    sink_->abort();
+    RecordingJournal::remove(sinkPath_);
+}
+
+void AudioWriter::syncSink() {
+    // Encoders may buffer internally, so the journal can be slightly ahead of the data;
+    // recovery only uses it for FLAC/Opus, whose streams end cleanly at the last full frame
+    RecordingJournal::Entry entry;
+    entry.codec = sink_->getCodec();
+    entry.sampleRate = sampleRate_;
+    entry.channels = channels_;
+    entry.filtered = filterStreaming_;
+    entry.sessionId = sessionId_;
+    entry.frames = sink_->getFramesWritten();
+    if (!sink_->sync() || !RecordingJournal::write(sinkPath_, entry)) {
+        R_LOG(WARN, "Could not sync %s, a crash now would lose more audio", sinkPath_.c_str());
+    }
+    lastSync_ = std::chrono::steady_clock::now();
+}
+
+bool AudioWriter::closeSegment() {
+    segmentOpen_ = false;
+    if (!sink_->close() || !RecordingJournal::commit(sinkPath_)) {
+        return false;
+    }
+    AudioFileInfo info = sink_->getInfo();
+    info.filePath = sinkPath_;
+    finishPeaks(info.filePath);
+    segments_.push_back(info);
+    return true;
+}
+
+bool AudioWriter::restartSegment() {
+    // First speech of the session: start the file over from the kept margin
+    untrimmedLead_ = false;
+    const std::string path = sinkPath_;
+    abortSink();
+    if (!openSink(path)) {
+        segmentOpen_ = false;
+        return false;
+    }
+    if (filterStreaming_) {
+        peaks_.reset(sampleRate_, channels_, CONFIG_INSTANCE()->getPeakBaseFrames(), CONFIG_INSTANCE()->getPeakLevelFactor());
+    }
+    return true;
+}
+
+bool AudioWriter::openNextSegment() {
+    // record_20250101_120000.flac -> record_20250101_120000_2.flac, ...
+    const std::filesystem::path base(basePath_);
+    const std::string path = (base.parent_path() / (base.stem().string() + "_" + std::to_string(++segmentIndex_))).string() +
+                             base.extension().string();
+    if (!openSink(path)) {
+        return false;
+    }
+    if (filterStreaming_) {
+        peaks_.reset(sampleRate_, channels_, CONFIG_INSTANCE()->getPeakBaseFrames(), CONFIG_INSTANCE()->getPeakLevelFactor());
+    }
+    R_LOG(INFO, "Speech resumed after a long pause, continuing in %s", path.c_str());
+    segmentOpen_ = true;
+    return true;
+}
+
+void AudioWriter::abortSession() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!sessionActive_) return;
+
+    sessionActive_ = false;
+    ring_.consume(ring_.readAvailable());
+    if (filterStreaming_) {
+        filterChain_->reset();
+    }
+    if (segmentOpen_) {
+        abortSink();
+        segmentOpen_ = false;
+    }
+    for (const AudioFileInfo &segment : segments_) {
+        removeWithSidecar(segment.filePath);
+    }
+    segments_.clear();
+}
+
+bool AudioWriter::drainRing() {
+    const int16_t *first = nullptr;
+    const int16_t *second = nullptr;
+    size_t firstCount = 0;
+    size_t secondCount = 0;
+
+    // Write straight from the ring storage, no intermediate copy
+    while (ring_.peek(first, firstCount, second, secondCount) > 0) {
+        if (!writeError_) {
+            if (!writeRegions(first, firstCount, second, secondCount)) {
+                R_LOG(ERROR, "AudioWriter failed to write %s, dropping the rest of the session", sink_->getFilePath().c_str());
+                writeError_ = true;
+            }
+        }
+        ring_.consume(firstCount + secondCount);
+    }
+    return !writeError_;
+}
+
+bool AudioWriter::writeRegions(const int16_t *first, size_t firstCount, const int16_t *second, size_t secondCount) {
+    const size_t split = firstCount % channels_;
+    if (split == 0 || secondCount == 0) {
+        return writeSamples(first, firstCount) && writeSamples(second, secondCount);
+    }
+    // A frame straddles the end of the ring storage (3, 5, ... channels), stitch it together
+    const size_t rest = channels_ - split;
+    stitched_.assign(first + firstCount - split, first + firstCount);
+    stitched_.insert(stitched_.end(), second, second + rest);
+    return writeSamples(first, firstCount - split) && writeSamples(stitched_.data(), stitched_.size()) &&
+           writeSamples(second + rest, secondCount - rest);
+}
+
+bool AudioWriter::writeSamples(const int16_t *samples, size_t count) {
+    if (filterStreaming_) {
+        filterChain_->process(samples, count, filtered_);
+        samples = filtered_.data();
+        count = filtered_.size();
+    }
+    return vadEnabled_ ? gateSamples(samples, count) : writeOut(samples, count);
+}
+
+bool AudioWriter::writeOut(const int16_t *samples, size_t count) {
+    if (count == 0) return true;
+    if (filterStreaming_) {
+        peaks_.add(samples, count);
+    }
+    return sink_->write(samples, count);
+}
+
+bool AudioWriter::gateSamples(const int16_t *samples, size_t count) {
+    const size_t frameSamples = vad_.frameSamples();
+    size_t pos = 0;
+    while (pos < count) {
+        const size_t take = std::min(count - pos, frameSamples - vadFrame_.size());
+        vadFrame_.insert(vadFrame_.end(), samples + pos, samples + pos + take);
+        pos += take;
+        if (vadFrame_.size() == frameSamples) {
+            const bool ok = onVadFrame(vad_.classify(vadFrame_.data(), vadFrame_.size()));
+            vadFrame_.clear();
+            if (!ok) return false;
+        }
+    }
+    return true;
+}
+
+bool AudioWriter::onVadFrame(bool speech) {
+    const size_t samplesPerMs = std::max<size_t>(static_cast<size_t>(sampleRate_) * channels_ / 1000, 1);
+    if (speech) {
+        silenceSamples_ = 0;
+        silenceMs_ = 0;
+        if (!holdSilence_) {
+            return writeOut(vadFrame_.data(), vadFrame_.size());
+        }
+        if (!segmentOpen_ && !openNextSegment()) {
+            return false;
+        }
+        if (untrimmedLead_ && !restartSegment()) {
+            return false;
+        }
+        // Silence before the first words of a file is cut to the margin, a pause between words is kept
+        const size_t skip = (!heardSpeech_ && held_.size() > marginSamples_) ? held_.size() - marginSamples_ : 0;
+        const bool ok = writeOut(held_.data() + skip, held_.size() - skip) && writeOut(vadFrame_.data(), vadFrame_.size());
+        held_.clear();
+        heardSpeech_ = true;
+        return ok;
+    }
+
+    silenceSamples_ += vadFrame_.size();
+    silenceMs_ = static_cast<unsigned int>(std::min<uint64_t>(silenceSamples_ / samplesPerMs, UINT32_MAX));
+    if (!holdSilence_) {
+        return writeOut(vadFrame_.data(), vadFrame_.size());
+    }
+
+    held_.insert(held_.end(), vadFrame_.begin(), vadFrame_.end());
+    if (!heardSpeech_) {
+        // Only the last margin of leading silence can ever be written
+        if (held_.size() > 2 * marginSamples_ + vadFrame_.size()) {
+            held_.erase(held_.begin(), held_.end() - static_cast<std::ptrdiff_t>(marginSamples_));
+        }
+        return !untrimmedLead_ || writeOut(vadFrame_.data(), vadFrame_.size());
+    }
+    if (splitSamples_ > 0 && silenceSamples_ >= splitSamples_) {
+        // Long pause: end this file after a short tail, the next speech opens a new one
+        const bool ok = writeOut(held_.data(), std::min(marginSamples_, held_.size())) && closeSegment();
+        held_.erase(held_.begin(), held_.end() - static_cast<std::ptrdiff_t>(std::min(marginSamples_, held_.size())));
+        heardSpeech_ = false;
+        return ok;
+    }
+    if (held_.size() >= holdCapSamples_) {
+        // Pause longer than we are willing to hold, it stays in the file
+        const bool ok = writeOut(held_.data(), held_.size());
+        held_.clear();
+        return ok;
+    }
+    return true;
+}
+
+bool AudioWriter::finishGate() {
+    // The partial last frame counts as silence, it is shorter than one VAD frame
+    bool ok = true;
+    if (untrimmedLead_) {
+        ok = writeOut(vadFrame_.data(), vadFrame_.size());
+    } else if (holdSilence_) {
+        held_.insert(held_.end(), vadFrame_.begin(), vadFrame_.end());
+        if (heardSpeech_ && segmentOpen_) {
+            ok = writeOut(held_.data(), std::min(marginSamples_, held_.size()));
+        }
+    } else {
+        ok = writeOut(vadFrame_.data(), vadFrame_.size());
+    }
+    vadFrame_.clear();
+    held_.clear();
+    return ok;
+}
+
+void AudioWriter::threadFunction() {
+    R_LOG(INFO, "AudioWriter thread started");
+
+    const auto wakeInterval = std::chrono::milliseconds(CONFIG_INSTANCE()->getWriterWakeIntervalMs());
+    const auto syncInterval = std::chrono::milliseconds(CONFIG_INSTANCE()->getRecoverySyncIntervalMs());
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (runningFlag_) {
+        // Producer notifies without the lock, the timeout covers a missed wakeup
+        const bool hasData = cv_.wait_for(lock, wakeInterval, [this] { return ring_.readAvailable() > 0 || !runningFlag_; });
+        if (!runningFlag_) break;
+
+        if (sessionActive_) {
+            if (!hasData) {
+                ring_.noteUnderrun();
+            }
+            drainRing();
+            if (segmentOpen_ && !writeError_ && std::chrono::steady_clock::now() - lastSync_ >= syncInterval) {
+                syncSink();
+            }
+        }
+    }
+
+    R_LOG(INFO, "AudioWriter thread finished");
+}
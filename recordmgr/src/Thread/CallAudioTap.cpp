@@ -0,0 +1,103 @@
+#include "CallAudioTap.hpp"
+#include "Config.hpp"
+#include "RLogger.hpp"
+#include <chrono>
+
+CallAudioTap::CallAudioTap(const std::string &sessionId, const std::string &device)
+    : ThreadBase("CallAudioTap[" + sessionId + "]"), sessionId_(sessionId), device_(device),
+      alsaHelper_(std::make_unique<AlsaHelper>(device, 1)),
+      ring_(static_cast<size_t>(CONFIG_INSTANCE()->getSampleRate()) * CONFIG_INSTANCE()->getCallAudioJitterMs() * 8 / 1000) {
+}
+
+void CallAudioTap::stop() {
+    ThreadBase::stop();
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        active_ = false;
+    }
+    cv_.notify_all();
+    alsaHelper_->wakeup();
+}
+
+void CallAudioTap::beginSession() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    // The tap thread is idle (see endSession), so nothing writes the ring
+    ring_.reset();
+    active_ = true;
+    cv_.notify_all();
+}
+
+void CallAudioTap::endSession() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    active_ = false;
+    cv_.notify_all();
+    alsaHelper_->wakeup();
+    cv_.wait(lock, [this]{ return !capturing_; });
+}
+
+void CallAudioTap::onPcm(const int16_t *samples, size_t frames) {
+    // Overflows only when the microphone side stops draining; the mixer catches up anyway
+    ring_.write(samples, frames);
+}
+
+void CallAudioTap::captureSession() {
+    bool pcmOpen = false;
+    bool reportedMissing = false;
+    while (runningFlag_) {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (!active_) {
+                break;
+            }
+        }
+
+        if (!pcmOpen) {
+            if (!alsaHelper_->initAlsa()) {
+                alsaHelper_->cleanupAlsa();
+                if (!reportedMissing) {
+                    R_LOG(WARN, "Call audio %s not available yet for session %s, retrying every %u ms", device_.c_str(),
+                          sessionId_.c_str(), CONFIG_INSTANCE()->getCallAudioRetryMs());
+                    reportedMissing = true;
+                }
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait_for(lock, std::chrono::milliseconds(CONFIG_INSTANCE()->getCallAudioRetryMs()),
+                             [this]{ return !active_ || !runningFlag_; });
+                continue;
+            }
+            pcmOpen = true;
+            R_LOG(INFO, "Recording call audio from %s for session %s", device_.c_str(), sessionId_.c_str());
+        }
+
+        snd_pcm_uframes_t framesRead = 0;
+        if (!alsaHelper_->captureOnce(*this, framesRead)) {
+            // SCO link dropped, e.g. the call moved to the handset
+            R_LOG(WARN, "Call audio %s lost for session %s", device_.c_str(), sessionId_.c_str());
+            alsaHelper_->cleanupAlsa();
+            pcmOpen = false;
+        }
+    }
+
+    if (pcmOpen) {
+        alsaHelper_->cleanupAlsa();
+    }
+}
+
+void CallAudioTap::threadFunction() {
+    while (runningFlag_) {
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            capturing_ = false;
+            cv_.notify_all();
+            cv_.wait(lock, [this]{ return active_ || !runningFlag_; });
+            if (!runningFlag_) {
+                break;
+            }
+            capturing_ = true;
+        }
+        captureSession();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    capturing_ = false;
+    cv_.notify_all();
+}
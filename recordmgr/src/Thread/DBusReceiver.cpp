@@ -33,5 +33,39 @@ void DBusReceiver::handleMessage(DBusCommand cmd) {
 }
 
 void DBusReceiver::handleMessageNoti(DBusCommand cmd, bool isSuccess, const DBusDataInfo &msgInfo) {
-    // TODO
+    switch (cmd) {
+        // Same commands as above, addressed to one capture session
+        case DBusCommand::START_RECORD:
+        case DBusCommand::STOP_RECORD:
+        case DBusCommand::CANCEL_RECORD: {
+            const std::string &sessionId = msgInfo.data[DBUS_DATA_RECORD_SESSION_ID];
+            R_LOG(INFO, "DBusReceiver: Received record command %d for session %s. Pushing event.", static_cast<int>(cmd), sessionId.c_str());
+            const EventTypeID type = cmd == DBusCommand::START_RECORD ? EventTypeID::START_RECORD
+                                   : cmd == DBusCommand::STOP_RECORD ? EventTypeID::STOP_RECORD : EventTypeID::CANCEL_RECORD;
+            std::shared_ptr<Payload> payload;
+            if (cmd == DBusCommand::START_RECORD) {
+                payload = std::make_shared<RecordStartPayload>(sessionId, msgInfo.data[DBUS_DATA_RECORD_CALL_AUDIO] == "1");
+            } else {
+                payload = std::make_shared<RecordSessionPayload>(sessionId);
+            }
+            eventQueue_->pushEvent(std::make_shared<Event>(type, payload));
+            break;
+        }
+        case DBusCommand::CANCEL_FILTER: {
+            R_LOG(INFO, "DBusReceiver: Received CANCEL_FILTER command. Pushing event.");
+            int jobId = 0;
+            try {
+                jobId = std::stoi(msgInfo.data[DBUS_DATA_FILTER_JOB_ID]);
+            } catch (const std::exception &e) {
+                R_LOG(ERROR, "DBusReceiver: Invalid filter job id '%s'", msgInfo.data[DBUS_DATA_FILTER_JOB_ID].c_str());
+                break;
+            }
+            std::shared_ptr<Payload> payload = std::make_shared<FilterJobPayload>(jobId);
+            eventQueue_->pushEvent(std::make_shared<Event>(EventTypeID::CANCEL_FILTER, payload));
+            break;
+        }
+        default:
+            R_LOG(WARN, "DBusReceiver received unknown DBusCommand notification");
+            break;
+    }
 }
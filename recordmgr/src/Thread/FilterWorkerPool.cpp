@@ -0,0 +1,217 @@
+#include "FilterWorkerPool.hpp"
+#include "Config.hpp"
+#include "RLogger.hpp"
+#include "Event.hpp"
+#include "DBusSender.hpp"
+#include "DBusData.hpp"
+#include "DBusHex.hpp"
+#include "AudioFilter.hpp"
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+    int workerCount() {
+        const unsigned int configured = CONFIG_INSTANCE()->getFilterWorkerCount();
+        if (configured > 0) {
+            return static_cast<int>(configured);
+        }
+        // Leave one core to capture and D-Bus
+        const unsigned int cores = std::thread::hardware_concurrency();
+        return static_cast<int>(std::max(cores, 2u) - 1);
+    }
+}
+
+FilterWorkerPool::FilterWorkerPool() : ThreadBase("FilterWorkerPool"),
+    numWorkers_(workerCount()), capacity_(std::max<size_t>(CONFIG_INSTANCE()->getFilterQueueCapacity(), 1)) {
+}
+
+void FilterWorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        runningFlag_ = false;
+        // Queued recordings are still stored, just without the filter pass, so
+        // nothing is left behind in the spool directory
+        for (auto &job : pending_) {
+            job->canceled = true;
+        }
+        for (auto &job : running_) {
+            job->canceled = true;
+        }
+    }
+    cv_.notify_all();
+}
+
+uint32_t FilterWorkerPool::submit(const WavPayload &wav) {
+    auto job = std::make_shared<FilterJob>();
+    job->filePath = wav.getFilePath();
+    job->durationSec = wav.getDurationSec();
+    job->isFiltered = wav.isFiltered();
+    job->codec = wav.getCodec();
+    job->bitrate = wav.getBitrate();
+    job->sessionId = wav.getSessionId();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!runningFlag_) {
+            R_LOG(WARN, "FilterWorkerPool: Attempted to submit %s after stop was called", job->filePath.c_str());
+            return 0;
+        }
+        job->id = nextJobId_++;
+
+        if (job->needsFilter()) {
+            const size_t waiting = std::count_if(pending_.begin(), pending_.end(),
+                                                 [](const std::shared_ptr<FilterJob> &j) { return j->needsFilter(); });
+            if (waiting >= capacity_) {
+                auto oldest = std::find_if(pending_.begin(), pending_.end(),
+                                           [](const std::shared_ptr<FilterJob> &j) { return j->needsFilter(); });
+                (*oldest)->canceled = true;
+                R_LOG(WARN, "FilterWorkerPool: Queue full, storing job %u (%s) without filtering",
+                      (*oldest)->id, (*oldest)->filePath.c_str());
+            }
+        }
+        pending_.push_back(job);
+    }
+    cv_.notify_one();
+
+    R_LOG(INFO, "FilterWorkerPool: Queued job %u for %s", job->id, job->filePath.c_str());
+    sendProgress(*job, -1);
+    return job->id;
+}
+
+void FilterWorkerPool::cancel(uint32_t jobId) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    bool found = false;
+    auto mark = [jobId, &found](const std::shared_ptr<FilterJob> &job) {
+        if (jobId == 0 || job->id == jobId) {
+            job->canceled = true;
+            found = true;
+        }
+    };
+    std::for_each(pending_.begin(), pending_.end(), mark);
+    std::for_each(running_.begin(), running_.end(), mark);
+
+    if (found) {
+        R_LOG(INFO, "FilterWorkerPool: Canceled filtering of job %u", jobId);
+    } else {
+        R_LOG(WARN, "FilterWorkerPool: No filter job %u to cancel", jobId);
+    }
+}
+
+std::shared_ptr<FilterJob> FilterWorkerPool::takeJob() {
+    // Store-only jobs first (oldest first), then the newest job that needs filtering
+    auto it = std::find_if(pending_.begin(), pending_.end(),
+                           [](const std::shared_ptr<FilterJob> &j) { return !j->needsFilter(); });
+    if (it == pending_.end()) {
+        it = std::prev(pending_.end());
+    }
+    std::shared_ptr<FilterJob> job = *it;
+    pending_.erase(it);
+    return job;
+}
+
+void FilterWorkerPool::threadFunction() {
+    // Partial filter output left by a crash; the sources are still in the spool directory
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(CONFIG_INSTANCE()->getStagingDir(), ec)) {
+        R_LOG(WARN, "FilterWorkerPool: Removing stale staging file %s", entry.path().c_str());
+        std::filesystem::remove(entry.path(), ec);
+    }
+
+    for (int i = 0; i < numWorkers_; i++) {
+        workers_.emplace_back(&FilterWorkerPool::workerLoop, this);
+    }
+    R_LOG(INFO, "FilterWorkerPool: Started %d worker threads", numWorkers_);
+
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    R_LOG(INFO, "FilterWorkerPool: All workers finished");
+}
+
+void FilterWorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        cv_.wait(lock, [this] { return !pending_.empty() || !runningFlag_; });
+        // Drain what is left before exiting, see stop()
+        if (pending_.empty()) {
+            break;
+        }
+
+        std::shared_ptr<FilterJob> job = takeJob();
+        running_.push_back(job);
+        lock.unlock();
+
+        runJob(*job);
+
+        lock.lock();
+        running_.erase(std::find(running_.begin(), running_.end(), job));
+    }
+}
+
+void FilterWorkerPool::runJob(FilterJob &job) {
+    R_LOG(INFO, "Starting filtering process for WAV file: %s (job %u)", job.filePath.c_str(), job.id);
+    sendProgress(job, 0);
+
+    const int step = static_cast<int>(std::max(CONFIG_INSTANCE()->getFilterProgressStepPercent(), 1u));
+    int lastSent = 0;
+    AudioFilter filter;
+    filter.setCancelFlag(&job.canceled);
+    filter.setProgressCallback([this, &job, step, &lastSent](int percent) {
+        if (percent - lastSent >= step && percent < 100) {
+            lastSent = percent;
+            sendProgress(job, percent);
+        }
+    });
+
+    bool ret = filter.applyFilter(job.filePath, job.isFiltered);
+    DBusDataInfo dataInfo;
+    dataInfo.data[DBUS_DATA_FILTER_JOB_ID] = std::to_string(job.id);
+    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID] = job.sessionId;
+    if (!ret) {
+        // Failed to apply filter
+        R_LOG(ERROR, "Failed to applying filter on WAV file: %s", job.filePath.c_str());
+        dataInfo.data[DBUS_DATA_MESSAGE] = "FAILED to save WAV file.";
+        DBUS_SENDER()->sendMessageNoti(DBusCommand::FILTER_WAV_FILE_NOTI, false, dataInfo);
+    } else {
+        R_LOG(INFO, "Successfully applied to applying filter on WAV file: %s", job.filePath.c_str());
+        dataInfo.data[DBUS_DATA_WAV_FILE_PATH] = filter.getFilteredFilePath();
+        dataInfo.data[DBUS_DATA_WAV_FILE_DURATION_SEC] = std::to_string(job.durationSec);
+        // Pre-filtered files were encoded during capture, otherwise the filter pass encoded them
+        if (job.isFiltered) {
+            dataInfo.data[DBUS_DATA_AUDIO_CODEC] = job.codec;
+            dataInfo.data[DBUS_DATA_AUDIO_BITRATE] = std::to_string(job.bitrate);
+        } else {
+            dataInfo.data[DBUS_DATA_AUDIO_CODEC] = AudioSink::codecName(filter.getFileInfo().codec);
+            dataInfo.data[DBUS_DATA_AUDIO_BITRATE] = std::to_string(filter.getFileInfo().bitrate);
+        }
+        // Waveform thumbnail as hex, (min, max) int8 pairs
+        for (int8_t v : filter.getThumbnail()) {
+            DBusHex::appendByte(dataInfo.data[DBUS_DATA_PEAKS_THUMBNAIL], static_cast<uint8_t>(v));
+        }
+        DBUS_SENDER()->sendMessageNoti(DBusCommand::FILTER_WAV_FILE_NOTI, true, dataInfo);
+        sendProgress(job, 100);
+    }
+
+    // Xóa file wav nguồn (spool/record_...) sau khi đã xử lý xong
+    try {
+        if (std::filesystem::exists(job.filePath)) {
+            std::filesystem::remove(job.filePath);
+            R_LOG(INFO, "Removed source WAV file: %s", job.filePath.c_str());
+        }
+    } catch (const std::filesystem::filesystem_error& e) {
+        R_LOG(ERROR, "Failed to remove source WAV file %s: %s", job.filePath.c_str(), e.what());
+    }
+
+    R_LOG(INFO, "Completed filtering process for WAV file: %s (job %u)", job.filePath.c_str(), job.id);
+}
+
+void FilterWorkerPool::sendProgress(const FilterJob &job, int percent) {
+    DBusDataInfo dataInfo;
+    dataInfo.data[DBUS_DATA_FILTER_JOB_ID] = std::to_string(job.id);
+    dataInfo.data[DBUS_DATA_WAV_FILE_PATH] = job.filePath;
+    dataInfo.data[DBUS_DATA_FILTER_PROGRESS] = std::to_string(percent);
+    dataInfo.data[DBUS_DATA_RECORD_SESSION_ID] = job.sessionId;
+    DBUS_SENDER()->sendMessageNoti(DBusCommand::FILTER_PROGRESS_NOTI, true, dataInfo);
+}
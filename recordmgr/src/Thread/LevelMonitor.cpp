@@ -0,0 +1,98 @@
+#include "LevelMonitor.hpp"
+#include "Config.hpp"
+#include "RLogger.hpp"
+#include "DBusSender.hpp"
+#include "DBusData.hpp"
+#include "DBusHex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+    // Enough for a few missed publish intervals
+    constexpr size_t WAVEFORM_CAPACITY = 1024;
+
+    size_t bucketSamples(unsigned int sampleRate, unsigned int channels) {
+        const unsigned int pointsPerSec = std::max(CONFIG_INSTANCE()->getWaveformPointsPerSec(), 1u);
+        return static_cast<size_t>(sampleRate) * channels / pointsPerSec;
+    }
+}
+
+LevelMonitor::LevelMonitor(const std::string &sessionId) : ThreadBase("LevelMonitor[" + sessionId + "]"), sessionId_(sessionId),
+    meter_(bucketSamples(CONFIG_INSTANCE()->getSampleRate(), 1), WAVEFORM_CAPACITY) {
+    waveform_.resize(WAVEFORM_CAPACITY);
+}
+
+void LevelMonitor::stop() {
+    ThreadBase::stop();
+    cv_.notify_all();
+}
+
+void LevelMonitor::beginSession(unsigned int sampleRate, unsigned int channels) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    // Capture has not started yet, the meter can be reset safely
+    meter_.reset(bucketSamples(sampleRate, channels));
+    channels_ = channels;
+    sessionActive_ = true;
+    cv_.notify_one();
+}
+
+void LevelMonitor::endSession() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    sessionActive_ = false;
+}
+
+void LevelMonitor::onPcm(const int16_t *samples, size_t frames) {
+    if (!sessionActive_) return;
+    meter_.process(samples, frames * channels_);
+}
+
+bool LevelMonitor::collect(DBusDataInfo &info) {
+    const PcmLevels levels = meter_.takeLevels();
+    if (levels.count == 0) {
+        return false;   // nothing captured since the last tick
+    }
+    const size_t points = meter_.takeWaveform(waveform_.data(), waveform_.size());
+
+    // Waveform as hex, one byte per point: 0..255 = peak / 128
+    std::string waveform;
+    waveform.reserve(points * 2);
+    for (size_t i = 0; i < points; ++i) {
+        DBusHex::appendByte(waveform, static_cast<uint8_t>(static_cast<unsigned int>(waveform_[i]) >> 7));
+    }
+
+    char rms[16];
+    char peak[16];
+    snprintf(rms, sizeof(rms), "%.1f", levels.rmsDbfs());
+    snprintf(peak, sizeof(peak), "%.1f", levels.peakDbfs());
+
+    info[DBUS_DATA_LEVEL_RMS_DBFS] = rms;
+    info[DBUS_DATA_LEVEL_PEAK_DBFS] = peak;
+    info[DBUS_DATA_LEVEL_WAVEFORM] = waveform;
+    info[DBUS_DATA_RECORD_SESSION_ID] = sessionId_;
+    return true;
+}
+
+void LevelMonitor::threadFunction() {
+    R_LOG(INFO, "LevelMonitor thread started");
+
+    const auto interval = std::chrono::milliseconds(CONFIG_INSTANCE()->getLevelNotiIntervalMs());
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (runningFlag_) {
+        // Idle until a session starts
+        cv_.wait(lock, [this] { return sessionActive_ || !runningFlag_; });
+        if (!runningFlag_) break;
+
+        cv_.wait_for(lock, interval, [this] { return !runningFlag_; });
+        if (!runningFlag_) break;
+
+        DBusDataInfo info;
+        if (sessionActive_ && collect(info)) {
+            lock.unlock();      // D-Bus send may block, keep begin/endSession responsive
+            DBUS_SENDER()->sendMessageNoti(DBusCommand::RECORD_LEVEL_NOTI, true, info);
+            lock.lock();
+        }
+    }
+
+    R_LOG(INFO, "LevelMonitor thread finished");
+}
@@ -3,15 +3,16 @@
 #include "Event.hpp"
 #include "EventTypeId.hpp"
 #include "RecordWorker.hpp"
+#include "RecordSessionManager.hpp"
 #include "DBusSender.hpp"
 #include "DBusData.hpp"
+#include "FilterWorkerPool.hpp"
 #include "RLogger.hpp"
-#include "AudioFilter.hpp"
-#include <thread>
-#include <filesystem>
+#include <algorithm>
 
-MainWorker::MainWorker(std::shared_ptr<EventQueue> eventQueue, std::shared_ptr<RecordWorker> recordWorker) 
-    : ThreadBase("MainWorker"), eventQueue_(eventQueue), recordWorker_(recordWorker) {
+MainWorker::MainWorker(std::shared_ptr<EventQueue> eventQueue, std::shared_ptr<RecordSessionManager> recordSessions,
+                       std::shared_ptr<FilterWorkerPool> filterWorkerPool)
+    : ThreadBase("MainWorker"), eventQueue_(eventQueue), recordSessions_(recordSessions), filterWorkerPool_(filterWorkerPool) {
 }
 
 void MainWorker::threadFunction() {
@@ -29,6 +30,14 @@ void MainWorker::threadFunction() {
         }
     }
 
+    // Recordings finalized by the shutdown are already in the spool directory, hand them to
+    // the filter pool (it stores whatever is queued when it stops). Nothing else runs now
+    while (std::shared_ptr<Event> event = eventQueue_->popEvent()) {
+        if (event->getEventTypeId() == EventTypeID::FILTER_WAV_FILE) {
+            processEvent(event);
+        }
+    }
+
     R_LOG(INFO, "MainWorker Thread function exiting");
 }
 
@@ -41,20 +50,24 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
     switch (event->getEventTypeId()) {
         case EventTypeID::START_RECORD:
             R_LOG(INFO, "Processing START_RECORD event");
-            processStartRecordEvent();
+            processStartRecordEvent(event->getPayload());
             break;
         case EventTypeID::STOP_RECORD:
             R_LOG(INFO, "Processing STOP_RECORD event");
-            processStopRecordEvent();
+            processStopRecordEvent(event->getPayload());
             break;
         case EventTypeID::CANCEL_RECORD:
             R_LOG(INFO, "Processing CANCEL_RECORD event");
-            processCancelRecordEvent();
+            processCancelRecordEvent(event->getPayload());
             break;
         case EventTypeID::FILTER_WAV_FILE:
             R_LOG(INFO, "Processing FILTER_WAV_FILE event");
             processFilterWavFileEvent(event->getPayload());
             break;
+        case EventTypeID::CANCEL_FILTER:
+            R_LOG(INFO, "Processing CANCEL_FILTER event");
+            processCancelFilterEvent(event->getPayload());
+            break;
         
         default:
             R_LOG(WARN, "MainWorker received unknown EventTypeID");
@@ -62,11 +75,38 @@ void MainWorker::processEvent(const std::shared_ptr<Event> event) {
     }
 }
 
-void MainWorker::processStartRecordEvent() { recordWorker_->startRecording();}
+std::shared_ptr<RecordWorker> MainWorker::findSession(std::shared_ptr<Payload> payload, DBusCommand notiCmd) {
+    std::shared_ptr<RecordSessionPayload> sessionPayload = std::dynamic_pointer_cast<RecordSessionPayload>(payload);
+    const std::string sessionId = sessionPayload ? sessionPayload->getSessionId() : DEFAULT_RECORD_SESSION_ID;
+    std::shared_ptr<RecordWorker> recordWorker = recordSessions_->find(sessionId);
+    if (!recordWorker) {
+        R_LOG(WARN, "Unknown record session '%s'", sessionId.c_str());
+        DBusDataInfo info;
+        info[DBUS_DATA_MESSAGE] = "Unknown recording session: " + sessionId;
+        info[DBUS_DATA_RECORD_SESSION_ID] = sessionId;
+        DBUS_SENDER()->sendMessageNoti(notiCmd, false, info);
+    }
+    return recordWorker;
+}
 
-void MainWorker::processStopRecordEvent() { recordWorker_->stopRecording(); }
+void MainWorker::processStartRecordEvent(std::shared_ptr<Payload> payload) {
+    if (auto recordWorker = findSession(payload, DBusCommand::START_RECORD_NOTI)) {
+        std::shared_ptr<RecordStartPayload> startPayload = std::dynamic_pointer_cast<RecordStartPayload>(payload);
+        recordWorker->startRecording(startPayload != nullptr && startPayload->isWithCallAudio());
+    }
+}
+
+void MainWorker::processStopRecordEvent(std::shared_ptr<Payload> payload) {
+    if (auto recordWorker = findSession(payload, DBusCommand::STOP_RECORD_NOTI)) {
+        recordWorker->stopRecording();
+    }
+}
 
-void MainWorker::processCancelRecordEvent() { recordWorker_->cancelRecording(); }
+void MainWorker::processCancelRecordEvent(std::shared_ptr<Payload> payload) {
+    if (auto recordWorker = findSession(payload, DBusCommand::CANCEL_RECORD_NOTI)) {
+        recordWorker->cancelRecording();
+    }
+}
 
 void MainWorker::processFilterWavFileEvent(std::shared_ptr<Payload> payload) {
     std::shared_ptr<WavPayload> wavPayload = std::dynamic_pointer_cast<WavPayload>(payload);
@@ -75,7 +115,6 @@ void MainWorker::processFilterWavFileEvent(std::shared_ptr<Payload> payload) {
         return;
     }
     std::string wavFilePath = wavPayload->getFilePath();
-    int durationSec = wavPayload->getDurationSec();
     R_LOG(INFO, "Received WAV file for filtering: %s", wavFilePath.c_str());
 
     if(wavFilePath == "") {
@@ -83,34 +122,14 @@ void MainWorker::processFilterWavFileEvent(std::shared_ptr<Payload> payload) {
         return;
     }
 
-    std::thread([wavFilePath, durationSec]() {
-        R_LOG(INFO, "Starting filtering process for WAV file: %s", wavFilePath.c_str());
-
-        AudioFilter filter;
-        bool ret = filter.applyFilter(wavFilePath);
-        DBusDataInfo dataInfo;
-        if (!ret) {
-            // Failed to apply filter
-            R_LOG(ERROR, "Failed to applying filter on WAV file: %s", wavFilePath.c_str());
-            dataInfo.data[DBUS_DATA_MESSAGE] = "FAILED to save WAV file.";
-            DBUS_SENDER()->sendMessageNoti(DBusCommand::FILTER_WAV_FILE_NOTI, false, dataInfo);
-        } else {
-            R_LOG(INFO, "Successfully applied to applying filter on WAV file: %s", wavFilePath.c_str());
-            dataInfo.data[DBUS_DATA_WAV_FILE_PATH] = filter.getFilteredFilePath();
-            dataInfo.data[DBUS_DATA_WAV_FILE_DURATION_SEC] = std::to_string(durationSec);
-            DBUS_SENDER()->sendMessageNoti(DBusCommand::FILTER_WAV_FILE_NOTI, true, dataInfo);
-        }
-
-        // Xóa file wav nguồn (/tmp/record_...) sau khi đã xử lý xong
-        try {
-            if (std::filesystem::exists(wavFilePath)) {
-                std::filesystem::remove(wavFilePath);
-                R_LOG(INFO, "Removed source WAV file: %s", wavFilePath.c_str());
-            }
-        } catch (const std::filesystem::filesystem_error& e) {
-            R_LOG(ERROR, "Failed to remove source WAV file %s: %s", wavFilePath.c_str(), e.what());
-        }
+    filterWorkerPool_->submit(*wavPayload);
+}
 
-        R_LOG(INFO, "Completed filtering process for WAV file: %s", wavFilePath.c_str());
-    }).detach();
+void MainWorker::processCancelFilterEvent(std::shared_ptr<Payload> payload) {
+    std::shared_ptr<FilterJobPayload> jobPayload = std::dynamic_pointer_cast<FilterJobPayload>(payload);
+    if (!jobPayload) {
+        R_LOG(ERROR, "Invalid payload for CANCEL_FILTER event");
+        return;
+    }
+    filterWorkerPool_->cancel(static_cast<uint32_t>(std::max(jobPayload->getJobId(), 0)));
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "RecordSessionManager.hpp"
+#include "RecordWorker.hpp"
+#include "AudioWriter.hpp"
+#include "LevelMonitor.hpp"
+#include "CallAudioTap.hpp"
+#include "RecordingJournal.hpp"
+#include "EventQueue.hpp"
+#include "Event.hpp"
+#include "EventTypeId.hpp"
+#include "Config.hpp"
+#include "RLogger.hpp"
+
+namespace {
+    ThreadSchedParams captureSchedParams() {
+        ThreadSchedParams params;
+        if (CONFIG_INSTANCE()->isCaptureRealtimeEnabled()) {
+            params.policy = SCHED_FIFO;
+            params.priority = CONFIG_INSTANCE()->getCaptureRtPriority();
+        }
+        params.cpu = CONFIG_INSTANCE()->getCaptureCpu();
+        params.lockMemory = CONFIG_INSTANCE()->isLockMemoryEnabled();
+        params.prefaultStackBytes = CONFIG_INSTANCE()->getCapturePrefaultStackBytes();
+        return params;
+    }
+}
+
+RecordSessionManager::RecordSessionManager(std::shared_ptr<EventQueue> eventQueue) : eventQueue_(eventQueue) {
+    for (const RecordSessionConfig &config : CONFIG_INSTANCE()->getRecordSessions()) {
+        if (config.id.empty() || sessions_.count(config.id) > 0) {
+            R_LOG(ERROR, "Skipping record session with empty or duplicate id '%s'", config.id.c_str());
+            continue;
+        }
+        Session session;
+        const unsigned int maxChannels = config.callDevice.empty() ? config.micChannels() : config.callChannels();
+        session.audioWriter = std::make_shared<AudioWriter>(config.id, maxChannels);
+        session.levelMonitor = std::make_shared<LevelMonitor>(config.id);
+        if (!config.callDevice.empty()) {
+            session.callAudioTap = std::make_shared<CallAudioTap>(config.id, config.callDevice);
+            session.callAudioTap->setSchedParams(captureSchedParams());
+        }
+        session.recordWorker = std::make_shared<RecordWorker>(config, eventQueue_, session.audioWriter, session.levelMonitor,
+                                                              session.callAudioTap);
+        session.recordWorker->setSchedParams(captureSchedParams());
+        sessions_.emplace(config.id, session);
+        R_LOG(INFO, "Record session %s on %s%s%s", config.id.c_str(), config.device.empty() ? "first capture card" : config.device.c_str(),
+              config.callDevice.empty() ? "" : ", call audio from ", config.callDevice.c_str());
+    }
+}
+
+void RecordSessionManager::run() {
+    // Before any session starts, so every part file belongs to a previous run
+    recoverInterruptedRecordings();
+
+    for (auto &entry : sessions_) {
+        entry.second.audioWriter->run();
+        entry.second.levelMonitor->run();
+        if (entry.second.callAudioTap) {
+            entry.second.callAudioTap->run();
+        }
+        entry.second.recordWorker->run();
+    }
+}
+
+void RecordSessionManager::stop() {
+    // Capture first, so the writers still drain what it pushed
+    for (auto &entry : sessions_) {
+        entry.second.recordWorker->stop();
+    }
+    for (auto &entry : sessions_) {
+        entry.second.audioWriter->stop();
+        entry.second.levelMonitor->stop();
+        if (entry.second.callAudioTap) {
+            entry.second.callAudioTap->stop();
+        }
+    }
+}
+
+void RecordSessionManager::join() {
+    for (auto &entry : sessions_) {
+        entry.second.recordWorker->join();
+        entry.second.audioWriter->join();
+        entry.second.levelMonitor->join();
+        if (entry.second.callAudioTap) {
+            entry.second.callAudioTap->join();
+        }
+    }
+}
+
+std::shared_ptr<RecordWorker> RecordSessionManager::find(const std::string &sessionId) const {
+    auto it = sessions_.find(sessionId);
+    return it != sessions_.end() ? it->second.recordWorker : nullptr;
+}
+
+void RecordSessionManager::recoverInterruptedRecordings() {
+    for (const RecordingJournal::Recovered &item : RecordingJournal::recoverAll(CONFIG_INSTANCE()->getWavOutputDir())) {
+        const int durationSec = static_cast<int>(item.info.frames / item.sampleRate);
+        // Same path as a normal stop: filter if needed, then FILTER_WAV_FILE_NOTI lets coremgr store it
+        std::shared_ptr<Payload> payload = std::make_shared<WavPayload>(item.info.filePath, durationSec, item.filtered,
+                                                                        AudioSink::codecName(item.info.codec),
+                                                                        static_cast<int>(item.info.bitrate),
+                                                                        std::vector<uint8_t>(), item.sessionId);
+        eventQueue_->pushEvent(std::make_shared<Event>(EventTypeID::FILTER_WAV_FILE, payload));
+    }
+}
@@ -7,9 +7,24 @@
 #include "Event.hpp"
 #include "EventTypeId.hpp"
 #include "DBusData.hpp"
+#include "AudioWriter.hpp"
+#include "LevelMonitor.hpp"
+#include "CallAudioTap.hpp"
+#include "CallAudioMixer.hpp"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
 
-RecordWorker::RecordWorker(std::shared_ptr<EventQueue> eventQueue) : ThreadBase("RecordWorker"),
-	 eventQueue_(eventQueue), alsaHelper_(std::make_unique<AlsaHelper>()), state_(State::IDLE), cancelRequested_(false) {}
+RecordWorker::RecordWorker(const RecordSessionConfig &config, std::shared_ptr<EventQueue> eventQueue,
+                           std::shared_ptr<AudioWriter> audioWriter, std::shared_ptr<LevelMonitor> levelMonitor,
+                           std::shared_ptr<CallAudioTap> callAudioTap)
+    : ThreadBase("RecordWorker[" + config.id + "]"), config_(config), sessionId_(config.id),
+	 eventQueue_(eventQueue), audioWriter_(audioWriter), levelMonitor_(levelMonitor), callAudioTap_(callAudioTap),
+     alsaHelper_(std::make_unique<AlsaHelper>(config.device, config.micChannels())),
+     preRoll_(static_cast<size_t>(CONFIG_INSTANCE()->getSampleRate()) * CONFIG_INSTANCE()->getPreRollMs() / 1000,
+              config.micChannels()),
+     state_(State::IDLE), cancelRequested_(false), withCallAudio_(false) {}
 
 RecordWorker::~RecordWorker() {}
 
@@ -17,32 +32,41 @@ void RecordWorker::stop() {
     ThreadBase::stop();
     state_.store(State::IDLE); // Change state to allow thread to exit if in capture loop
     cv_.notify_one(); // Wake up thread if it's waiting
+    alsaHelper_->wakeup(); // Or if it's waiting on the PCM
 }
 
-void RecordWorker::startRecording() {
+void RecordWorker::startRecording(bool withCallAudio) {
     std::unique_lock<std::mutex> lock(mtx_);
     if (state_ == State::IDLE) {
         cancelRequested_ = false; // Reset cancel flag for new session
+        if (withCallAudio && callAudioTap_ == nullptr) {
+            R_LOG(INFO, "Session %s has no call audio device, recording the microphone only", sessionId_.c_str());
+        }
+        withCallAudio_ = withCallAudio && callAudioTap_ != nullptr;
         state_ = State::RECORDING;
         cv_.notify_one();
+        if (CONFIG_INSTANCE()->isPreRollEnabled()) {
+            alsaHelper_->wakeup();  // end the idle capture wait now, not after a period
+        }
     } else {
         R_LOG(WARN, "Record worker is already recording. Ignoring start request.");
         DBusDataInfo info;
         info[DBUS_DATA_MESSAGE] = "Recording is already in progress.";
-        DBUS_SENDER()->sendMessageNoti(DBusCommand::START_RECORD_NOTI, false, info);
+        sendNoti(DBusCommand::START_RECORD_NOTI, false, info);
     }
 }
 
 void RecordWorker::stopRecording() {
     if (state_ == State::RECORDING) {
         state_ = State::IDLE;
+        alsaHelper_->wakeup();
         // The capture loop in threadFunction will see the state change and stop.
         R_LOG(INFO, "Recording stop requested.");
     } else {
         R_LOG(WARN, "No active recording to stop. Ignoring stop request.");
         DBusDataInfo info;
         info[DBUS_DATA_MESSAGE] = "No recording is in progress.";
-        DBUS_SENDER()->sendMessageNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
+        sendNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
     }
 }
 
@@ -50,23 +74,76 @@ void RecordWorker::cancelRecording() {
     if (state_ == State::RECORDING) {
         cancelRequested_ = true;
         state_ = State::IDLE;
+        alsaHelper_->wakeup();
         // The capture loop in threadFunction will see the state change and stop.
         R_LOG(INFO, "Recording cancel requested.");
     } else {
         R_LOG(WARN, "No active recording to cancel. Ignoring cancel request.");
         DBusDataInfo info;
         info[DBUS_DATA_MESSAGE] = "No recording is in progress.";
-        DBUS_SENDER()->sendMessageNoti(DBusCommand::CANCEL_RECORD_NOTI, false, info);
+        sendNoti(DBusCommand::CANCEL_RECORD_NOTI, false, info);
+    }
+}
+
+std::string RecordWorker::makeOutputFilePath(AudioCodec codec) const {
+    // Build timestamped filename
+    auto now = std::chrono::system_clock::now();
+    std::time_t t = std::chrono::system_clock::to_time_t(now);
+    std::tm tm = *std::localtime(&t);
+    std::ostringstream ss;
+    ss << CONFIG_INSTANCE()->getWavOutputDir() << "/record_" << std::put_time(&tm, "%Y%m%d_%H%M%S");
+    // Sessions started in the same second must not share a file
+    if (sessionId_ != DEFAULT_RECORD_SESSION_ID) {
+        ss << "_" << sessionId_;
+    }
+    ss << AudioSink::fileExtension(codec);
+    return ss.str();
+}
+
+void RecordWorker::sendNoti(DBusCommand cmd, bool isSuccess, DBusDataInfo &info) const {
+    info[DBUS_DATA_RECORD_SESSION_ID] = sessionId_;
+    DBUS_SENDER()->sendMessageNoti(cmd, isSuccess, info);
+}
+
+void RecordWorker::captureIdle() {
+    preRoll_.clear();   // never prepend audio from before the previous session ended
+    if (!pcmRunning_) {
+        if (!alsaHelper_->initAlsa()) {
+            R_LOG(WARN, "Pre-roll capture could not start, retrying in %u ms", CONFIG_INSTANCE()->getPreRollRetryMs());
+            alsaHelper_->cleanupAlsa();
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait_for(lock, std::chrono::milliseconds(CONFIG_INSTANCE()->getPreRollRetryMs()),
+                         [this]{ return state_ == State::RECORDING || !runningFlag_; });
+            return;
+        }
+        pcmRunning_ = true;
+    }
+
+    while (runningFlag_ && state_ == State::IDLE) {
+        snd_pcm_uframes_t framesRead = 0;
+        if (!alsaHelper_->captureOnce(preRoll_, framesRead)) {
+            R_LOG(ERROR, "Pre-roll capture failed, reopening the PCM");
+            alsaHelper_->cleanupAlsa();
+            pcmRunning_ = false;
+            return;
+        }
     }
 }
 
 void RecordWorker::threadFunction() {
-	R_LOG(INFO, "RecordWorker thread started, waiting for recording tasks.");
+	R_LOG(INFO, "RecordWorker thread started for session %s, waiting for recording tasks.", sessionId_.c_str());
+    if (!alsaHelper_->warmUp()) {
+        R_LOG(WARN, "Could not prepare the capture PCM ahead of time, it will be opened on START_RECORD");
+        alsaHelper_->cleanupAlsa();
+    }
 
     while (runningFlag_) {
-        // Wait until startRecording() is called
-		// Wait until state is RECORDING or runningFlag_ is false, so we can exit wait
-        {
+        const bool preRollEnabled = CONFIG_INSTANCE()->isPreRollEnabled();
+        if (preRollEnabled) {
+            captureIdle();
+        } else {
+            // Wait until startRecording() is called
+            // Wait until state is RECORDING or runningFlag_ is false, so we can exit wait
             std::unique_lock<std::mutex> lock(mtx_);
             cv_.wait(lock, [this]{ return state_ == State::RECORDING || !runningFlag_; });
         }
@@ -75,93 +152,202 @@ void RecordWorker::threadFunction() {
         if (!runningFlag_) {
             break; // Exit if shutdown was requested
         }
+        if (state_ != State::RECORDING) {
+            continue; // Idle capture stopped on an error, restart it
+        }
 
         // -- Start Recording Session --
-        R_LOG(INFO, "RecordWorker woken up, starting recording session.");
-		alsaHelper_->clearAudioBuffer();
+        R_LOG(INFO, "RecordWorker woken up, starting recording session %s.", sessionId_.c_str());
+        const unsigned int sampleRate = CONFIG_INSTANCE()->getSampleRate();
+        const bool withCallAudio = withCallAudio_;
+        const unsigned int channels = withCallAudio ? config_.callChannels() : config_.micChannels();
+        const bool filterStreaming = CONFIG_INSTANCE()->isStreamingFilterEnabled();
+        // Encode while recording when the file is final at stop; otherwise keep raw PCM
+        // for the post-stop filter pass, which encodes its output
+        const AudioCodec codec = filterStreaming ? AudioSink::configuredCodec() : AudioCodec::WAV;
+        const std::string outputFilePath = makeOutputFilePath(codec);
 
-        if (!alsaHelper_->initAlsa()) {
+        if (!pcmRunning_ && !alsaHelper_->initAlsa()) {
             R_LOG(ERROR, "Failed to initialize ALSA, aborting recording session.");
             alsaHelper_->cleanupAlsa();
             DBusDataInfo info;
             info[DBUS_DATA_MESSAGE] = "ALSA initialization failed";
-            DBUS_SENDER()->sendMessageNoti(DBusCommand::START_RECORD_NOTI, false, info);
+            sendNoti(DBusCommand::START_RECORD_NOTI, false, info);
             state_ = State::IDLE; // Reset state
             continue; // Go back to waiting
         }
+        pcmRunning_ = true;
+
+        if (!audioWriter_->beginSession(outputFilePath, sampleRate, channels, filterStreaming, codec)) {
+            R_LOG(ERROR, "Failed to create %s, aborting recording session.", outputFilePath.c_str());
+            alsaHelper_->cleanupAlsa();
+            pcmRunning_ = false;
+            DBusDataInfo info;
+            info[DBUS_DATA_MESSAGE] = "Failed to create output file";
+            sendNoti(DBusCommand::START_RECORD_NOTI, false, info);
+            state_ = State::IDLE;
+            continue;
+        }
 
 		// Notify that recording has started
         DBusDataInfo startInfo;
         startInfo[DBUS_DATA_MESSAGE] = "Recording started";
-        DBUS_SENDER()->sendMessageNoti(DBusCommand::START_RECORD_NOTI, true, startInfo);
-		const auto startTime = std::chrono::steady_clock::now();
-        const auto maxDuration = std::chrono::seconds(CONFIG_INSTANCE()->getMaxRecordDurationSec());
+        sendNoti(DBusCommand::START_RECORD_NOTI, true, startInfo);
+        const uint64_t maxFrames = static_cast<uint64_t>(CONFIG_INSTANCE()->getMaxRecordDurationSec()) * sampleRate;
+
+        // Frames go straight from the PCM to the writer ring, and to the level meter when enabled
+        const uint64_t xrunsAtStart = alsaHelper_->getXrunCount();
+        const bool levelNoti = CONFIG_INSTANCE()->isLevelNotiEnabled();
+        PcmTee meteredSink(*audioWriter_, *levelMonitor_);
+        PcmSink &recordSink = levelNoti ? static_cast<PcmSink &>(meteredSink) : *audioWriter_;
+        if (levelNoti) {
+            levelMonitor_->beginSession(sampleRate, channels);
+        }
+        // During a call the far end is mixed in before anything else sees the frames
+        std::unique_ptr<CallAudioMixer> callMixer;
+        if (withCallAudio) {
+            callMixer = std::make_unique<CallAudioMixer>(recordSink, callAudioTap_->getRing(), config_.micChannels(), config_.callStereo,
+                                                         static_cast<size_t>(sampleRate) * CONFIG_INSTANCE()->getCallAudioJitterMs() / 1000,
+                                                         CONFIG_INSTANCE()->getFramesPerPeriod());
+            callAudioTap_->beginSession();
+        }
+        PcmSink &captureSink = callMixer ? static_cast<PcmSink &>(*callMixer) : recordSink;
+        // Audio from before START_RECORD goes first; the PCM kept running, so capture continues seamlessly
+        uint64_t capturedFrames = 0;
+        if (preRollEnabled) {
+            capturedFrames = preRoll_.drainTo(captureSink);
+            R_LOG(INFO, "Prepended %llu ms of pre-roll", static_cast<unsigned long long>(capturedFrames * 1000 / sampleRate));
+        }
         bool durationExceeded = false;
+        bool silenceTimeout = false;
         bool isCaptureError = false;
-		
+        const unsigned int autoStopMs = CONFIG_INSTANCE()->isVadEnabled() ? CONFIG_INSTANCE()->getVadAutoStopSilenceMs() : 0;
+
         while (runningFlag_ && state_ == State::RECORDING) {
-			if (std::chrono::steady_clock::now() - startTime > maxDuration) {
+            if (capturedFrames >= maxFrames) {
                 R_LOG(WARN, "Maximum recording duration reached. Stopping automatically.");
                 durationExceeded = true;
                 break;
             }
+            // The writer runs the VAD, so this lags capture by at most one writer wakeup
+            if (autoStopMs > 0 && audioWriter_->getSilenceMs() >= autoStopMs) {
+                R_LOG(INFO, "No speech for %u ms. Stopping automatically.", autoStopMs);
+                silenceTimeout = true;
+                break;
+            }
 
-            if (!alsaHelper_->captureOnce()) {
+            snd_pcm_uframes_t framesRead = 0;
+            if (!alsaHelper_->captureOnce(captureSink, framesRead)) {
                 R_LOG(ERROR, "captureOnce failed, breaking capture loop");
                 isCaptureError = true;
                 break;
             }
+            capturedFrames += framesRead;
         }
 
         // -- End Recording Session --
+        // Writer ring overruns are in the AudioWriter session summary
+        R_LOG(INFO, "Session %s: %llu ALSA overruns (%llu since start)", sessionId_.c_str(),
+              static_cast<unsigned long long>(alsaHelper_->getXrunCount() - xrunsAtStart),
+              static_cast<unsigned long long>(alsaHelper_->getXrunCount()));
+        if (callMixer) {
+            callAudioTap_->endSession();
+            R_LOG(INFO, "Session %s call audio: %llu frames silenced, %llu dropped", sessionId_.c_str(),
+                  static_cast<unsigned long long>(callMixer->getSilencedFrames()),
+                  static_cast<unsigned long long>(callMixer->getDroppedFrames()));
+        }
+        if (levelNoti) {
+            levelMonitor_->endSession();
+        }
         if (isCaptureError) {
             R_LOG(WARN, "Recording stopped due to capture error. No WAV file will be saved.");
+            audioWriter_->abortSession();
             DBusDataInfo info;
             info[DBUS_DATA_MESSAGE] = "Recording stopped due to capture error.";
-            DBUS_SENDER()->sendMessageNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
+            sendNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
         } else if (cancelRequested_) {
             R_LOG(INFO, "Recording canceled. No WAV file will be saved.");
+            audioWriter_->abortSession();
             DBusDataInfo info;
             info[DBUS_DATA_MESSAGE] = "Recording canceled by user.";
-            DBUS_SENDER()->sendMessageNoti(DBusCommand::CANCEL_RECORD_NOTI, true, info);
+            sendNoti(DBusCommand::CANCEL_RECORD_NOTI, true, info);
         } else {
 			if(durationExceeded) {
-				R_LOG(INFO, "Recording stopped after reaching maximum duration. Saving WAV file...");
+				R_LOG(INFO, "Recording stopped after reaching maximum duration. Finalizing WAV file...");
+			} else if (silenceTimeout) {
+				R_LOG(INFO, "Recording stopped after a long silence. Finalizing WAV file...");
 			} else {
-				R_LOG(INFO, "Recording stopped by client. Saving WAV file...");
+				R_LOG(INFO, "Recording stopped by client. Finalizing WAV file...");
 			}
+            const char *stopReason = durationExceeded ? "max_duration" : (silenceTimeout ? "silence" : "user");
 
-			if (alsaHelper_->isAudioBufferEmpty()) {
+            // Samples are already on disk, only the queue tail and the encoder flush remain
+            std::vector<AudioFileInfo> files;
+            if (capturedFrames == 0) {
 				R_LOG(WARN, "Recording stopped but no audio was captured. No file saved.");
+                audioWriter_->abortSession();
                 DBusDataInfo info;
                 info[DBUS_DATA_MESSAGE] = "No audio data captured.";
-				DBUS_SENDER()->sendMessageNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
-			} else if (!alsaHelper_->saveWavFile()) {
+                info[DBUS_DATA_STOP_REASON] = stopReason;
+				sendNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
+			} else if (!audioWriter_->endSession(files)) {
                 DBusDataInfo info;
-                info[DBUS_DATA_MESSAGE] = "Failed to save WAV file.";
-                DBUS_SENDER()->sendMessageNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
-                R_LOG(ERROR, "Failed to save WAV file");
+                info[DBUS_DATA_MESSAGE] = "Failed to save audio file.";
+                info[DBUS_DATA_STOP_REASON] = stopReason;
+                sendNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
+                R_LOG(ERROR, "Failed to save audio file");
+            } else if (files.empty()) {
+                R_LOG(WARN, "Recording ended without an audio file");
+                DBusDataInfo info;
+                info[DBUS_DATA_MESSAGE] = "No audio file saved.";
+                info[DBUS_DATA_STOP_REASON] = stopReason;
+                sendNoti(DBusCommand::STOP_RECORD_NOTI, false, info);
             } else {
+                // Duration after silence trimming, over all files when the recording was split
+                uint64_t totalFrames = 0;
+                for (const AudioFileInfo &file : files) {
+                    totalFrames += file.frames;
+                }
+                const int durationSec = static_cast<int>(totalFrames / sampleRate);
+                const char *codecName = AudioSink::codecName(files.front().codec);
+
                 DBusDataInfo info;
-                info[DBUS_DATA_MESSAGE] = "WAV file saved: " + alsaHelper_->getOutputFilePath();
-                DBUS_SENDER()->sendMessageNoti(DBusCommand::STOP_RECORD_NOTI, true, info);
-                R_LOG(INFO, "WAV file saved successfully: %s", alsaHelper_->getOutputFilePath().c_str());
-
-			    // Push event for further processing
-                const auto endTime = std::chrono::steady_clock::now();
-                const auto duration = std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime);
-                const int durationSec = duration.count();
-
-				std::shared_ptr<Payload> payload = std::make_shared<WavPayload>(alsaHelper_->getOutputFilePath(), durationSec);
-				std::shared_ptr<Event> event = std::make_shared<Event>(EventTypeID::FILTER_WAV_FILE, payload);
-				eventQueue_->pushEvent(event);
+                info[DBUS_DATA_MESSAGE] = "Audio file saved: " + files.front().filePath;
+                info[DBUS_DATA_WAV_FILE_PATH] = files.front().filePath;
+                info[DBUS_DATA_WAV_FILE_DURATION_SEC] = std::to_string(durationSec);
+                info[DBUS_DATA_AUDIO_CODEC] = codecName;
+                info[DBUS_DATA_AUDIO_BITRATE] = std::to_string(files.front().bitrate);
+                info[DBUS_DATA_STOP_REASON] = stopReason;
+                info[DBUS_DATA_RECORD_FILE_COUNT] = std::to_string(files.size());
+                sendNoti(DBusCommand::STOP_RECORD_NOTI, true, info);
+
+                for (const AudioFileInfo &file : files) {
+                    const int fileDurationSec = static_cast<int>(file.frames / sampleRate);
+                    R_LOG(INFO, "Audio file saved successfully: %s (%s, %u bps, %llu bytes, %d s)", file.filePath.c_str(),
+                          codecName, file.bitrate, static_cast<unsigned long long>(file.bytes), fileDurationSec);
+
+                    // Push event for further processing
+                    std::shared_ptr<Payload> payload = std::make_shared<WavPayload>(file.filePath, fileDurationSec, filterStreaming,
+                                                                                    codecName, static_cast<int>(file.bitrate),
+                                                                                    std::vector<uint8_t>(), sessionId_);
+                    std::shared_ptr<Event> event = std::make_shared<Event>(EventTypeID::FILTER_WAV_FILE, payload);
+                    eventQueue_->pushEvent(event);
+                }
             }
         }
 
-        alsaHelper_->cleanupAlsa();
+        // After a capture error the device may be gone, do not keep it warm.
+        // With pre-roll the PCM keeps running for the idle capture
+        if (isCaptureError) {
+            alsaHelper_->cleanupAlsa();
+            pcmRunning_ = false;
+        } else if (!preRollEnabled) {
+            alsaHelper_->releaseAlsa();
+            pcmRunning_ = false;
+        }
         state_ = State::IDLE; // Ensure state is IDLE before waiting again
-        R_LOG(INFO, "Recording session finished. Returning to idle state.");
+        R_LOG(INFO, "Recording session %s finished. Returning to idle state.", sessionId_.c_str());
     }
 
-	R_LOG(INFO, "RecordWorker thread finished");
+	R_LOG(INFO, "RecordWorker thread for session %s finished", sessionId_.c_str());
 }
\ No newline at end of file
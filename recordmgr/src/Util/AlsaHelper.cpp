@@ -1,19 +1,80 @@
 #include "Util/AlsaHelper.hpp"
 #include "Config.hpp"
 #include "RLogger.hpp"
-#include <fstream>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
 #include <chrono>
-#include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <cerrno>
+#include <cstring>
 
-AlsaHelper::AlsaHelper() : pcmHandle_(nullptr) {}
+namespace {
+    const char SOUND_DEV_DIR[] = "/dev/snd";
+
+    snd_pcm_format_t formatFromName(const std::string &name) {
+        if (name == "s24") return SND_PCM_FORMAT_S24_LE;    // 24 bits in a 32-bit container
+        if (name == "s32") return SND_PCM_FORMAT_S32_LE;
+        if (name == "float") return SND_PCM_FORMAT_FLOAT_LE;
+        return SND_PCM_FORMAT_S16_LE;
+    }
+}
+
+AlsaHelper::AlsaHelper(const std::string& device, unsigned int channels) : pcmHandle_(nullptr), useMmap_(false), inotifyFd_(-1),
+    device_(device), format_(SND_PCM_FORMAT_S16_LE), deviceRate_(0), deviceChannels_(0),
+    converter_(CONFIG_INSTANCE()->getSampleRate(), channels > 0 ? channels : std::max(CONFIG_INSTANCE()->getCaptureChannels(), 1u)) {
+    wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd_ < 0) {
+        R_LOG(WARN, "eventfd failed, stop requests will wait for the capture timeout");
+    }
+    watchDevices();
+}
 
 AlsaHelper::~AlsaHelper() {
     cleanupAlsa();
+    if (wakeupFd_ >= 0) {
+        close(wakeupFd_);
+    }
+    if (inotifyFd_ >= 0) {
+        close(inotifyFd_);
+    }
+}
+
+void AlsaHelper::watchDevices() {
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) {
+        R_LOG(WARN, "inotify_init1 failed (%s), capture device is looked up for every session", strerror(errno));
+        return;
+    }
+    // Cards come and go as /dev/snd/pcmC*D*c nodes, e.g. when a USB mic is plugged in
+    if (inotify_add_watch(inotifyFd_, SOUND_DEV_DIR, IN_CREATE | IN_DELETE | IN_ATTRIB) < 0) {
+        R_LOG(WARN, "Cannot watch %s (%s), capture device is looked up for every session", SOUND_DEV_DIR, strerror(errno));
+        close(inotifyFd_);
+        inotifyFd_ = -1;
+    }
+}
+
+bool AlsaHelper::devicesChanged() {
+    if (inotifyFd_ < 0) {
+        return true;
+    }
+    // Only whether something happened matters, not what
+    bool changed = false;
+    char buf[1024];
+    while (read(inotifyFd_, buf, sizeof(buf)) > 0) {
+        changed = true;
+    }
+    return changed;
 }
 
 std::string AlsaHelper::findCaptureDevice() {
+    if (!device_.empty()) {
+        return device_;
+    }
+    if (!cachedDevice_.empty()) {
+        return cachedDevice_;
+    }
+
     int card = -1;
     int err;
 
@@ -41,8 +102,10 @@ std::string AlsaHelper::findCaptureDevice() {
                 // std::string device_name = "hw:" + std::to_string(card) + "," + std::to_string(dev);
                 R_LOG(INFO, "Found capture device: %s on card %d", snd_pcm_info_get_name(pcm_info), card);
                 snd_ctl_close(ctl_handle);
-                // Use plughw for better compatibility
-                return "plughw:" + std::to_string(card) + "," + std::to_string(dev);
+                // hw: when we convert ourselves, otherwise plughw for better compatibility
+                const char *prefix = CONFIG_INSTANCE()->isInProcessResampleEnabled() ? "hw:" : "plughw:";
+                cachedDevice_ = prefix + std::to_string(card) + "," + std::to_string(dev);
+                return cachedDevice_;
             }
         }
         snd_ctl_close(ctl_handle);
@@ -53,6 +116,60 @@ std::string AlsaHelper::findCaptureDevice() {
 }
 
 bool AlsaHelper::initAlsa() {
+	const auto begin = std::chrono::steady_clock::now();
+
+	if (devicesChanged()) {
+		// A warm PCM may belong to a card that is gone
+		cachedDevice_.clear();
+		cleanupAlsa();
+	}
+	const bool reused = (pcmHandle_ != nullptr);
+	if (!reused && !openPcm()) {
+		return false;
+	}
+
+	// New stream, no history from the previous session
+	converter_.reset();
+
+	// mmap capture does not auto-start on the first read
+	int err;
+	if (useMmap_ && (err = snd_pcm_start(pcmHandle_)) < 0) {
+		R_LOG(ERROR, "snd_pcm_start failed: %s", snd_strerror(err));
+		return false;
+	}
+
+	const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+	R_LOG(INFO, "ALSA capture started in %lld us (%s PCM)", static_cast<long long>(elapsedUs), reused ? "warm" : "new");
+	return true;
+}
+
+bool AlsaHelper::warmUp() {
+	if (!CONFIG_INSTANCE()->isPcmWarmModeEnabled() || pcmHandle_) {
+		return true;
+	}
+	devicesChanged();	// discard events from before the first scan
+	return openPcm();
+}
+
+void AlsaHelper::releaseAlsa() {
+	if (!pcmHandle_) {
+		return;
+	}
+	if (!CONFIG_INSTANCE()->isPcmWarmModeEnabled()) {
+		cleanupAlsa();
+		return;
+	}
+
+	// Keep the negotiated hw params, only drop the frames and re-arm the stream
+	snd_pcm_drop(pcmHandle_);
+	int err = snd_pcm_prepare(pcmHandle_);
+	if (err < 0) {
+		R_LOG(WARN, "snd_pcm_prepare for warm mode failed (%s), closing the PCM", snd_strerror(err));
+		cleanupAlsa();
+	}
+}
+
+bool AlsaHelper::openPcm() {
 	int err;
 	snd_pcm_hw_params_t* hwParams = nullptr;
 	const std::string device = findCaptureDevice();
@@ -61,6 +178,7 @@ bool AlsaHelper::initAlsa() {
 	if (err < 0) {
 		R_LOG(ERROR, "snd_pcm_open(%s) failed: %s", device.c_str(), snd_strerror(err));
 		pcmHandle_ = nullptr;
+		cachedDevice_.clear();
 		return false;
 	}
 
@@ -71,27 +189,31 @@ bool AlsaHelper::initAlsa() {
 		return false;
 	}
 
-	if ((err = snd_pcm_hw_params_set_access(pcmHandle_, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
-		R_LOG(ERROR, "snd_pcm_hw_params_set_access failed: %s", snd_strerror(err));
+	if (!setAccess(hwParams)) {
 		snd_pcm_hw_params_free(hwParams);
 		return false;
 	}
 
-	if ((err = snd_pcm_hw_params_set_format(pcmHandle_, hwParams, SND_PCM_FORMAT_S16_LE)) < 0) {
-		R_LOG(ERROR, "snd_pcm_hw_params_set_format failed: %s", snd_strerror(err));
+	if (!setFormat(hwParams)) {
 		snd_pcm_hw_params_free(hwParams);
 		return false;
 	}
 
-	unsigned int rate = CONFIG_INSTANCE()->getSampleRate();
+	// Rates the card cannot do natively are converted by our resampler, not by alsa-lib
+	if (CONFIG_INSTANCE()->isInProcessResampleEnabled()) {
+		snd_pcm_hw_params_set_rate_resample(pcmHandle_, hwParams, 0);
+	}
+	unsigned int rate = converter_.getOutRate();
 	if ((err = snd_pcm_hw_params_set_rate_near(pcmHandle_, hwParams, &rate, nullptr)) < 0) {
 		R_LOG(ERROR, "snd_pcm_hw_params_set_rate_near failed: %s", snd_strerror(err));
 		snd_pcm_hw_params_free(hwParams);
 		return false;
 	}
 
-	if ((err = snd_pcm_hw_params_set_channels(pcmHandle_, hwParams, 1)) < 0) {
-		R_LOG(ERROR, "snd_pcm_hw_params_set_channels failed: %s", snd_strerror(err));
+	// Some cards are stereo-only (or have no mono mode): mixed or duplicated by the converter
+	unsigned int channels = converter_.getOutChannels();
+	if ((err = snd_pcm_hw_params_set_channels_near(pcmHandle_, hwParams, &channels)) < 0) {
+		R_LOG(ERROR, "snd_pcm_hw_params_set_channels_near failed: %s", snd_strerror(err));
 		snd_pcm_hw_params_free(hwParams);
 		return false;
 	}
@@ -104,115 +226,191 @@ bool AlsaHelper::initAlsa() {
 
 	snd_pcm_hw_params_free(hwParams);
 
+	deviceRate_ = rate;
+	deviceChannels_ = channels;
+	converter_.configure(format_, deviceRate_, deviceChannels_, CONFIG_INSTANCE()->getFramesPerPeriod());
+
 	if ((err = snd_pcm_prepare(pcmHandle_)) < 0) {
 		R_LOG(ERROR, "snd_pcm_prepare failed: %s", snd_strerror(err));
 		return false;
 	}
 
-	R_LOG(INFO, "ALSA init OK (device=%s, rate=%u)", device.c_str(), rate);
+	int count = snd_pcm_poll_descriptors_count(pcmHandle_);
+	if (count <= 0) {
+		R_LOG(ERROR, "snd_pcm_poll_descriptors_count failed: %s", snd_strerror(count));
+		return false;
+	}
+	pollFds_.assign(count + 1, pollfd{});
+	snd_pcm_poll_descriptors(pcmHandle_, pollFds_.data(), count);
+	pollFds_[count].fd = wakeupFd_;
+	pollFds_[count].events = POLLIN;
+
+	if (!useMmap_) {
+		periodBuffer_.assign(CONFIG_INSTANCE()->getFramesPerPeriod() * converter_.getFrameBytes(), 0);
+	}
+
+	R_LOG(INFO, "ALSA open OK (device=%s, %s %u Hz %u ch, access=%s)", device.c_str(), snd_pcm_format_name(format_),
+		  deviceRate_, deviceChannels_, useMmap_ ? "mmap" : "readi");
+	if (!converter_.isPassthrough()) {
+		R_LOG(INFO, "Converting capture to S16_LE %u Hz %u ch in-process%s", converter_.getOutRate(), converter_.getOutChannels(),
+			  converter_.isResampling() ? " (resampling)" : "");
+	}
 	return true;
 }
 
+bool AlsaHelper::setAccess(snd_pcm_hw_params_t* hwParams) {
+	int err = snd_pcm_hw_params_set_access(pcmHandle_, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+	if (err == 0) {
+		useMmap_ = true;
+		return true;
+	}
+	R_LOG(INFO, "mmap access not supported (%s), falling back to readi", snd_strerror(err));
+
+	useMmap_ = false;
+	if ((err = snd_pcm_hw_params_set_access(pcmHandle_, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
+		R_LOG(ERROR, "snd_pcm_hw_params_set_access failed: %s", snd_strerror(err));
+		return false;
+	}
+	return true;
+}
+
+bool AlsaHelper::setFormat(snd_pcm_hw_params_t* hwParams) {
+	// The configured format first, then whatever else the card offers
+	const snd_pcm_format_t wanted = formatFromName(CONFIG_INSTANCE()->getCaptureSampleFormat());
+	for (snd_pcm_format_t format : {wanted, SND_PCM_FORMAT_S16_LE, SND_PCM_FORMAT_S32_LE, SND_PCM_FORMAT_S24_LE,
+									SND_PCM_FORMAT_FLOAT_LE}) {
+		if (snd_pcm_hw_params_test_format(pcmHandle_, hwParams, format) < 0) {
+			continue;
+		}
+		int err = snd_pcm_hw_params_set_format(pcmHandle_, hwParams, format);
+		if (err < 0) {
+			R_LOG(ERROR, "snd_pcm_hw_params_set_format failed: %s", snd_strerror(err));
+			return false;
+		}
+		if (format != wanted) {
+			R_LOG(WARN, "%s capture not supported, using %s", snd_pcm_format_name(wanted), snd_pcm_format_name(format));
+		}
+		format_ = format;
+		return true;
+	}
+	R_LOG(ERROR, "Capture device supports none of S16_LE, S32_LE, S24_LE, FLOAT_LE");
+	return false;
+}
+
 void AlsaHelper::cleanupAlsa() {
 	if (pcmHandle_) {
-		snd_pcm_drain(pcmHandle_);
+		// Capture stream: drop pending frames instead of draining
+		snd_pcm_drop(pcmHandle_);
 		snd_pcm_close(pcmHandle_);
 		pcmHandle_ = nullptr;
 	}
+	pollFds_.clear();
 }
 
-bool AlsaHelper::captureOnce() {
-	if (!pcmHandle_) return false;
-
-	const snd_pcm_uframes_t frames = CONFIG_INSTANCE()->getFramesPerPeriod();
-	std::vector<int16_t> buffer(frames);
-
-	snd_pcm_sframes_t r = snd_pcm_readi(pcmHandle_, buffer.data(), frames);
-	if (r == -EPIPE) {
-		R_LOG(WARN, "ALSA overrun occurred");
-		snd_pcm_prepare(pcmHandle_);
-		return true; // continue capturing
-	} else if (r < 0) {
-		R_LOG(ERROR, "snd_pcm_readi error: %s", snd_strerror(static_cast<int>(r)));
-		int rc = snd_pcm_recover(pcmHandle_, r, 0);
-		if (rc < 0) {
-			R_LOG(ERROR, "snd_pcm_recover failed: %s", snd_strerror(rc));
-			return false;
-		}
-		return true;
+void AlsaHelper::wakeup() {
+	if (wakeupFd_ >= 0) {
+		uint64_t one = 1;
+		ssize_t ret = write(wakeupFd_, &one, sizeof(one));
+		(void)ret;
 	}
+}
 
-	// append read frames
-	audioBuffer_.insert(audioBuffer_.end(), buffer.begin(), buffer.begin() + r);
+bool AlsaHelper::recover(int err) {
+	if (err == -EPIPE) {
+		++xruns_;
+		R_LOG(WARN, "ALSA overrun occurred (%llu so far)", static_cast<unsigned long long>(xruns_));
+	} else {
+		R_LOG(ERROR, "ALSA capture error: %s", snd_strerror(err));
+	}
+	int rc = snd_pcm_recover(pcmHandle_, err, 1);
+	if (rc < 0) {
+		R_LOG(ERROR, "snd_pcm_recover failed: %s", snd_strerror(rc));
+		return false;
+	}
+	if (useMmap_ && (rc = snd_pcm_start(pcmHandle_)) < 0) {
+		R_LOG(ERROR, "snd_pcm_start after recover failed: %s", snd_strerror(rc));
+		return false;
+	}
 	return true;
 }
 
-bool AlsaHelper::saveWavFile() {
-	if (audioBuffer_.empty()) {
-		R_LOG(WARN, "No audio captured, skipping WAV save");
+bool AlsaHelper::captureOnce(PcmSink& sink, snd_pcm_uframes_t& framesRead) {
+	framesRead = 0;
+	if (!pcmHandle_) return false;
+
+	// Sleep until the device has a period or someone calls wakeup()
+	const nfds_t pcmCount = pollFds_.size() - 1;
+	int ret = poll(pollFds_.data(), pollFds_.size(), CONFIG_INSTANCE()->getCaptureWaitTimeoutMs());
+	if (ret < 0) {
+		if (errno == EINTR) return true;
+		R_LOG(ERROR, "poll failed: %s", strerror(errno));
 		return false;
 	}
+	if (ret == 0) {
+		return true;
+	}
+	if (pollFds_[pcmCount].revents & POLLIN) {
+		uint64_t value;
+		ssize_t n = read(wakeupFd_, &value, sizeof(value));
+		(void)n;
+		return true;
+	}
+
+	unsigned short revents = 0;
+	snd_pcm_poll_descriptors_revents(pcmHandle_, pollFds_.data(), pcmCount, &revents);
+	if (revents & POLLERR) {
+		return recover(-EPIPE);
+	}
+	if (!(revents & POLLIN)) {
+		return true;
+	}
 
-	// Build timestamped filename
-	auto now = std::chrono::system_clock::now();
-	std::time_t t = std::chrono::system_clock::to_time_t(now);
-	std::tm tm = *std::localtime(&t);
-	std::ostringstream ss;
-	std::string wavDir = CONFIG_INSTANCE()->getWavOutputDir();
-	ss << wavDir << "/record_" << std::put_time(&tm, "%Y%m%d_%H%M%S") << ".wav";
-	outputFilePath_ = ss.str();
+	return useMmap_ ? captureMmap(sink, framesRead) : captureReadi(sink, framesRead);
+}
 
-	std::ofstream out(outputFilePath_, std::ios::binary);
-	if (!out.is_open()) {
-		R_LOG(ERROR, "Failed to open output file %s", outputFilePath_.c_str());
-		return false;
+bool AlsaHelper::captureMmap(PcmSink& sink, snd_pcm_uframes_t& framesRead) {
+	snd_pcm_sframes_t avail = snd_pcm_avail_update(pcmHandle_);
+	if (avail < 0) {
+		return recover(static_cast<int>(avail));
 	}
 
-	uint32_t subchunk2Size = static_cast<uint32_t>(audioBuffer_.size() * sizeof(int16_t));
-	uint32_t chunkSize = 36 + subchunk2Size;
-	uint32_t byteRate = CONFIG_INSTANCE()->getSampleRate() * 1 * 2;
-	uint16_t blockAlign = 1 * 2;
-
-	// RIFF header
-	out.write("RIFF", 4);
-	out.write(reinterpret_cast<const char*>(&chunkSize), 4);
-	out.write("WAVE", 4);
-
-	// fmt subchunk
-	out.write("fmt ", 4);
-	uint32_t subchunk1Size = 16;
-	out.write(reinterpret_cast<const char*>(&subchunk1Size), 4);
-	uint16_t audioFormat = 1; // PCM
-	out.write(reinterpret_cast<const char*>(&audioFormat), 2);
-	uint16_t numChannels = 1;
-	out.write(reinterpret_cast<const char*>(&numChannels), 2);
-	uint32_t sampleRate = CONFIG_INSTANCE()->getSampleRate();;
-	out.write(reinterpret_cast<const char*>(&sampleRate), 4);
-	out.write(reinterpret_cast<const char*>(&byteRate), 4);
-	out.write(reinterpret_cast<const char*>(&blockAlign), 2);
-	uint16_t bitsPerSample = 16;
-	out.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
-
-	// data subchunk
-	out.write("data", 4);
-	out.write(reinterpret_cast<const char*>(&subchunk2Size), 4);
-
-	// write samples
-	out.write(reinterpret_cast<const char*>(audioBuffer_.data()), subchunk2Size);
-	out.close();
-
-	R_LOG(INFO, "Saved WAV: %s (frames=%zu, bytes=%u)", outputFilePath_.c_str(), audioBuffer_.size(), subchunk2Size);
+	// Hand the DMA area straight to the sink, no intermediate buffer
+	snd_pcm_uframes_t remaining = static_cast<snd_pcm_uframes_t>(avail);
+	while (remaining > 0) {
+		const snd_pcm_channel_area_t* areas = nullptr;
+		snd_pcm_uframes_t offset = 0;
+		snd_pcm_uframes_t frames = remaining;
+		int err = snd_pcm_mmap_begin(pcmHandle_, &areas, &offset, &frames);
+		if (err < 0) {
+			return recover(err);
+		}
+
+		const uint8_t* base = static_cast<const uint8_t*>(areas[0].addr) + areas[0].first / 8 + offset * (areas[0].step / 8);
+		const size_t delivered = converter_.deliver(sink, base, frames);
+
+		snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcmHandle_, offset, frames);
+		if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames) {
+			return recover(committed < 0 ? static_cast<int>(committed) : -EPIPE);
+		}
+		framesRead += delivered;
+		remaining -= frames;
+	}
 	return true;
 }
 
-void AlsaHelper::clearAudioBuffer() {
-    audioBuffer_.clear();
-}
+bool AlsaHelper::captureReadi(PcmSink& sink, snd_pcm_uframes_t& framesRead) {
+	snd_pcm_sframes_t avail = snd_pcm_avail_update(pcmHandle_);
+	if (avail < 0) {
+		return recover(static_cast<int>(avail));
+	}
 
-bool AlsaHelper::isAudioBufferEmpty() const {
-    return audioBuffer_.empty();
-}
+	// Data is already there, so this read does not block
+	const snd_pcm_uframes_t frames = std::min<snd_pcm_uframes_t>(std::max<snd_pcm_sframes_t>(avail, 1), periodBuffer_.size() / converter_.getFrameBytes());
+	snd_pcm_sframes_t r = snd_pcm_readi(pcmHandle_, periodBuffer_.data(), frames);
+	if (r < 0) {
+		return recover(static_cast<int>(r));
+	}
 
-const std::string& AlsaHelper::getOutputFilePath() const {
-    return outputFilePath_;
+	framesRead = converter_.deliver(sink, periodBuffer_.data(), static_cast<size_t>(r));
+	return true;
 }
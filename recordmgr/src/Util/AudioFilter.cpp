@@ -1,14 +1,20 @@
 #include "AudioFilter.hpp"
 #include "RLogger.hpp"
 #include "Config.hpp"
+#include "FilterChain.hpp"
+#include "WavReader.hpp"
+#include "PeakPyramid.hpp"
+#include "FileMover.hpp"
+#include <algorithm>
 #include <filesystem>
-#include <cstdlib> // For system()
+#include <vector>
 
 namespace fs = std::filesystem;
 
-bool AudioFilter::applyFilter(const std::string& wavFilePath){
+bool AudioFilter::applyFilter(const std::string& wavFilePath, bool isPreFiltered){
     R_LOG(INFO, "Applying audio filter to file: %s", wavFilePath.c_str());
-    // Source: /tmp/record_...
+    // Source:       /var/local/recordmanager/spool/record_...
+    // Staging:      /var/local/recordmanager/audio/.staging/filtered_record_...
     // Success dest: /var/local/recordmanager/audio/filtered_record_...
     // Fail dest:    /var/local/recordmanager/audio/record_...
 
@@ -19,69 +25,152 @@ bool AudioFilter::applyFilter(const std::string& wavFilePath){
             return false;
         }
         std::string fileName = sourcePath.filename().string();
+        // Ghi âm đã ghi file nguồn một lần
+        uint64_t bytesWritten = fs::file_size(sourcePath);
+        uint64_t bytesCopied = 0;
 
-        // Tạo đường dẫn cho file tạm đã được lọc
-        fs::path tempFilteredPath = fs::temp_directory_path() / ("filtered_" + fileName);
-
-        // 1. Thực hiện lọc âm thanh bằng sox, lưu vào file tạm
-        // Cải tiến lệnh sox để giảm nhiễu tốt hơn bằng cách sử dụng noise profile.
-        // Bước 1: Tạo một "noise profile" từ 0.4 giây đầu của file audio.
-        std::string noiseProfilePath = tempFilteredPath.string() + ".prof";
-        std::string noiseprof_command = "sox \"" + wavFilePath + "\" -n trim 0 0.4 noiseprof \"" + noiseProfilePath + "\"";
-        
-        R_LOG(INFO, "Creating noise profile: %s", noiseprof_command.c_str());
-        int noiseprof_result = std::system(noiseprof_command.c_str());
-
-        std::string command;
-        if (noiseprof_result == 0) {
-            // Bước 2: Áp dụng bộ lọc highpass, lowpass và noisered sử dụng profile đã tạo.
-            // Mức giảm nhiễu 0.21 là một giá trị khởi đầu tốt, có thể điều chỉnh.
-            command = "sox \"" + wavFilePath + "\" \"" + tempFilteredPath.string() + "\" highpass 100 lowpass 3000 noisered \"" + noiseProfilePath + "\" 0.21";
-        } else {
-            R_LOG(WARN, "Failed to create noise profile, falling back to simpler filter.");
-            // Nếu không tạo được profile, dùng lại lệnh cũ.
-            command = "sox \"" + wavFilePath + "\" \"" + tempFilteredPath.string() + "\" highpass 100 lowpass 3000";
-        }
+        std::string outputDir = CONFIG_INSTANCE()->getFilteredAudioDir();
+        fs::create_directories(outputDir); // Đảm bảo thư mục đích tồn tại
+        // Thư mục staging nằm cùng filesystem với đích, hoàn tất chỉ cần rename
+        const fs::path stagingDir(CONFIG_INSTANCE()->getStagingDir());
+        fs::create_directories(stagingDir);
 
-        R_LOG(INFO, "Executing audio filter command: %s", command.c_str());
-        int result = std::system(command.c_str());
+        // Tạo đường dẫn cho file tạm đã được lọc (đuôi file theo codec đầu ra)
+        const AudioCodec codec = AudioSink::configuredCodec();
+        fs::path tempFilteredPath = stagingDir /
+            ("filtered_" + sourcePath.stem().string() + AudioSink::fileExtension(codec));
 
-        // Dọn dẹp file noise profile
-        if (fs::exists(noiseProfilePath)) {
-            fs::remove(noiseProfilePath);
+        // 1. Lọc trong tiến trình: highpass 100 -> lowpass 3000 -> noise gate (profile từ 0.4 giây đầu)
+        bool isFilterSuccess = true;
+        if (isPreFiltered) {
+            // Đã lọc trong lúc ghi âm, file nguồn chính là file đã lọc
+            tempFilteredPath = sourcePath;
+        } else if (isCanceled()) {
+            // Job bị hủy trước khi chạy: lưu file gốc
+            isFilterSuccess = false;
+        } else {
+            isFilterSuccess = runFilterChain(wavFilePath, tempFilteredPath.string(), codec);
+            if (isFilterSuccess) {
+                bytesWritten += fs::file_size(tempFilteredPath);
+            }
         }
 
-        bool isFilterSuccess = (result == 0);
-
-        // 2. Tạo đường dẫn đích cuối cùng
-        std::string outputDir = CONFIG_INSTANCE()->getFilteredAudioDir();
-        fs::create_directories(outputDir); // Đảm bảo thư mục đích tồn tại
-
+        // 2. Chuyển file vào thư mục đích: rename, chỉ sao chép khi khác filesystem
         if (isFilterSuccess) {
             R_LOG(INFO, "Audio filtering successful.");
             // Đích là file đã lọc
-            filteredFilePath_ = (fs::path(outputDir) / ("filtered_" + fileName)).string();
-            // Dùng copy + remove thay vì rename (vì /tmp và /var/local có thể trên khác filesystem)
-            fs::copy_file(tempFilteredPath, filteredFilePath_, fs::copy_options::overwrite_existing);
-            fs::remove(tempFilteredPath);
+            filteredFilePath_ = (fs::path(outputDir) /
+                ("filtered_" + sourcePath.stem().string() + tempFilteredPath.extension().string())).string();
+            if (!FileMover::move(tempFilteredPath.string(), filteredFilePath_, bytesCopied)) {
+                return false;
+            }
+            bytesWritten += bytesCopied;
             R_LOG(INFO, "Moved filtered file to: %s", filteredFilePath_.c_str());
+
+            // File peaks đi kèm file âm thanh, thumbnail gửi cho coremgr lưu vào DB
+            const std::string tempPeaksPath = PeakPyramid::sidecarPath(tempFilteredPath.string());
+            if (fs::exists(tempPeaksPath)) {
+                const std::string peaksPath = PeakPyramid::sidecarPath(filteredFilePath_);
+                uint64_t peaksCopied = 0;
+                PeakPyramid pyramid;
+                if (FileMover::move(tempPeaksPath, peaksPath, peaksCopied) && pyramid.load(peaksPath)) {
+                    thumbnail_ = pyramid.thumbnail(CONFIG_INSTANCE()->getPeakThumbnailPoints());
+                }
+            }
         } else {
-            R_LOG(WARN, "Audio filtering failed with exit code: %d. Using original file.", result);
+            if (isCanceled()) {
+                R_LOG(INFO, "Audio filtering canceled. Using original file.");
+            } else {
+                R_LOG(WARN, "Audio filtering failed. Using original file.");
+            }
             // Đích là file gốc
             filteredFilePath_ = (fs::path(outputDir) / fileName).string();
-            // Sao chép file gốc vào vị trí cuối cùng
-            fs::copy_file(sourcePath, filteredFilePath_, fs::copy_options::overwrite_existing);
-            R_LOG(INFO, "Copied original file to: %s", filteredFilePath_.c_str());
-            
-            // Dọn dẹp file tạm nếu nó được tạo ra nhưng sox thất bại
-            if (fs::exists(tempFilteredPath)) {
-                fs::remove(tempFilteredPath);
+            fileInfo_ = AudioFileInfo();    // file gốc là WAV chưa nén
+            if (!FileMover::move(wavFilePath, filteredFilePath_, bytesCopied)) {
+                return false;
             }
+            bytesWritten += bytesCopied;
+            R_LOG(INFO, "Moved original file to: %s", filteredFilePath_.c_str());
+
+            // Dọn dẹp file tạm nếu nó được tạo ra nhưng lọc thất bại
+            std::error_code ec;
+            fs::remove(tempFilteredPath, ec);
+            fs::remove(PeakPyramid::sidecarPath(tempFilteredPath.string()), ec);
         }
+
+        // Số byte ghi xuống đĩa cho mỗi byte được lưu (1.00 = mỗi byte chỉ ghi một lần)
+        const uint64_t storedBytes = fs::file_size(filteredFilePath_);
+        R_LOG(INFO, "Write amplification for %s: %.2f (%llu bytes written, %llu stored, %llu copied)",
+              fileName.c_str(), storedBytes > 0 ? static_cast<double>(bytesWritten) / storedBytes : 0.0,
+              static_cast<unsigned long long>(bytesWritten), static_cast<unsigned long long>(storedBytes),
+              static_cast<unsigned long long>(bytesCopied));
         return true;
 
     } catch (const fs::filesystem_error& e) {
         R_LOG(ERROR, "Filesystem error during filtering: %s", e.what());
         return false;
     }
-}
\ No newline at end of file
+}
+
+bool AudioFilter::runFilterChain(const std::string& inputPath, const std::string& outputPath, AudioCodec codec) {
+    WavReader reader;
+    if (!reader.open(inputPath)) {
+        return false;
+    }
+    const unsigned int channels = std::max(reader.getChannels(), 1u);
+
+    std::unique_ptr<AudioSink> writer = AudioSink::create(codec);
+    if (!writer->open(outputPath, reader.getSampleRate(), channels)) {
+        return false;
+    }
+
+    FilterChain chain(FilterChain::defaultParams(reader.getSampleRate(), channels));
+    PeakPyramid peaks;
+    peaks.reset(reader.getSampleRate(), channels, CONFIG_INSTANCE()->getPeakBaseFrames(), CONFIG_INSTANCE()->getPeakLevelFactor());
+    // Whole frames per block so the chain can deinterleave them
+    const size_t blockSamples = std::max<size_t>(CONFIG_INSTANCE()->getFilterBlockSamples() / channels, 1) * channels;
+    std::vector<int16_t> in(blockSamples);
+    std::vector<int16_t> out;
+    out.reserve(in.size() * 2);
+
+    const uint64_t totalSamples = std::max<uint64_t>(reader.getTotalSamples(), 1);
+    uint64_t samplesRead = 0;
+    int lastPercent = -1;
+
+    // Single streaming pass, memory use does not depend on the file length
+    size_t count;
+    while ((count = reader.read(in.data(), in.size())) > 0) {
+        if (isCanceled()) {
+            writer->abort();
+            return false;
+        }
+        samplesRead += count;
+        const int percent = static_cast<int>(std::min<uint64_t>(samplesRead * 100 / totalSamples, 100));
+        if (progressCallback_ && percent != lastPercent) {
+            progressCallback_(percent);
+            lastPercent = percent;
+        }
+
+        chain.process(in.data(), count, out);
+        peaks.add(out.data(), out.size());
+        if (!writer->write(out.data(), out.size())) {
+            writer->abort();
+            return false;
+        }
+    }
+    chain.flush(out);
+    peaks.add(out.data(), out.size());
+    if (!writer->write(out.data(), out.size())) {
+        writer->abort();
+        return false;
+    }
+
+    R_LOG(INFO, "Filtered %llu samples into %s", static_cast<unsigned long long>(writer->getFramesWritten()), outputPath.c_str());
+    if (!writer->close()) {
+        return false;
+    }
+    fileInfo_ = writer->getInfo();
+    peaks.finish();
+    peaks.save(PeakPyramid::sidecarPath(outputPath));
+    return true;
+}
@@ -0,0 +1,78 @@
+#include "AudioSink.hpp"
+#include "WavWriter.hpp"
+#include "FlacWriter.hpp"
+#include "OpusWriter.hpp"
+#include "Config.hpp"
+#include "RLogger.hpp"
+
+AudioFileInfo AudioSink::getInfo() const {
+    AudioFileInfo info;
+    info.filePath = getFilePath();
+    info.codec = getCodec();
+    info.bitrate = getBitrate();
+    info.frames = getFramesWritten();
+    info.bytes = getBytesWritten();
+    return info;
+}
+
+const char *AudioSink::codecName(AudioCodec codec) {
+    switch (codec) {
+        case AudioCodec::FLAC: return "flac";
+        case AudioCodec::OPUS: return "opus";
+        default: return "wav";
+    }
+}
+
+const char *AudioSink::fileExtension(AudioCodec codec) {
+    switch (codec) {
+        case AudioCodec::FLAC: return ".flac";
+        case AudioCodec::OPUS: return ".opus";
+        default: return ".wav";
+    }
+}
+
+bool AudioSink::isSupported(AudioCodec codec) {
+    switch (codec) {
+#ifdef HAVE_FLAC
+        case AudioCodec::FLAC: return true;
+#endif
+#ifdef HAVE_OPUS
+        case AudioCodec::OPUS: return true;
+#endif
+        case AudioCodec::WAV: return true;
+        default: return false;
+    }
+}
+
+AudioCodec AudioSink::configuredCodec() {
+    const std::string &name = CONFIG_INSTANCE()->getRecordCodec();
+    AudioCodec codec = AudioCodec::WAV;
+    if (name == "flac") {
+        codec = AudioCodec::FLAC;
+    } else if (name == "opus") {
+        codec = AudioCodec::OPUS;
+    } else if (name != "wav") {
+        R_LOG(WARN, "Unknown record codec '%s', using wav", name.c_str());
+    }
+
+    if (!isSupported(codec)) {
+        R_LOG(WARN, "Record codec %s is not compiled in, using wav", codecName(codec));
+        codec = AudioCodec::WAV;
+    }
+    return codec;
+}
+
+std::unique_ptr<AudioSink> AudioSink::create(AudioCodec codec) {
+    switch (codec) {
+#ifdef HAVE_FLAC
+        case AudioCodec::FLAC:
+            return std::make_unique<FlacWriter>(CONFIG_INSTANCE()->getFlacCompressionLevel());
+#endif
+#ifdef HAVE_OPUS
+        case AudioCodec::OPUS:
+            return std::make_unique<OpusWriter>(CONFIG_INSTANCE()->getOpusBitrate());
+#endif
+        default:
+            return std::make_unique<WavWriter>();
+    }
+}
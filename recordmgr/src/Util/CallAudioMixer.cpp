@@ -0,0 +1,71 @@
+#include "CallAudioMixer.hpp"
+#include <algorithm>
+
+CallAudioMixer::CallAudioMixer(PcmSink &out, PcmRingBuffer &farEnd, unsigned int micChannels, bool stereo, size_t jitterFrames,
+                               size_t blockFrames)
+    : out_(out), ring_(farEnd), micChannels_(std::max(micChannels, 1u)),
+      outChannels_(stereo ? micChannels_ + 1 : micChannels_), stereo_(stereo), jitterFrames_(std::max<size_t>(jitterFrames, 1)),
+      blockFrames_(std::max<size_t>(blockFrames, 1)), farEnd_(blockFrames_), mixed_(blockFrames_ * outChannels_) {
+}
+
+size_t CallAudioMixer::pullFarEnd(size_t frames) {
+    size_t available = ring_.readAvailable();
+    if (!primed_ && available < jitterFrames_) {
+        std::fill(farEnd_.begin(), farEnd_.begin() + frames, 0);
+        return 0;
+    }
+    primed_ = true;
+
+    // Far end clock running fast, or the microphone stalled: catch up
+    if (available > 2 * jitterFrames_ + frames) {
+        const size_t excess = available - jitterFrames_;
+        ring_.consume(excess);
+        droppedFrames_ += excess;
+        available = jitterFrames_;
+    }
+
+    const size_t got = ring_.read(farEnd_.data(), std::min(frames, available));
+    if (got < frames) {
+        // Call ended or the far end fell behind, wait for a full buffer again
+        std::fill(farEnd_.begin() + got, farEnd_.begin() + frames, 0);
+        silencedFrames_ += frames - got;
+        ring_.noteUnderrun();
+        primed_ = false;
+    }
+    return got;
+}
+
+void CallAudioMixer::onPcm(const int16_t *samples, size_t frames) {
+    while (frames > 0) {
+        const size_t block = std::min(frames, blockFrames_);
+        mixBlock(samples, block);
+        samples += block * micChannels_;
+        frames -= block;
+    }
+}
+
+void CallAudioMixer::mixBlock(const int16_t *samples, size_t frames) {
+    const size_t got = pullFarEnd(frames);
+    if (got == 0 && !stereo_) {
+        out_.onPcm(samples, frames);
+        return;
+    }
+
+    int16_t *dst = mixed_.data();
+    const int16_t *far = farEnd_.data();
+    for (size_t f = 0; f < frames; ++f) {
+        const int16_t *mic = samples + f * micChannels_;
+        for (unsigned int c = 0; c < micChannels_; ++c) {
+            if (stereo_) {
+                *dst++ = mic[c];
+            } else {
+                const int sum = mic[c] + far[f];
+                *dst++ = static_cast<int16_t>(std::clamp(sum, -32768, 32767));
+            }
+        }
+        if (stereo_) {
+            *dst++ = far[f];
+        }
+    }
+    out_.onPcm(mixed_.data(), frames);
+}
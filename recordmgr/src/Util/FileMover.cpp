@@ -0,0 +1,90 @@
+#include "FileMover.hpp"
+#include "RLogger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+
+bool FileMover::move(const std::string &srcPath, const std::string &dstPath, uint64_t &bytesCopied) {
+    bytesCopied = 0;
+    if (::rename(srcPath.c_str(), dstPath.c_str()) == 0) {
+        return true;
+    }
+    if (errno != EXDEV) {
+        R_LOG(ERROR, "Failed to rename %s to %s: %s", srcPath.c_str(), dstPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    int inFd = ::open(srcPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (inFd < 0) {
+        R_LOG(ERROR, "Failed to open %s: %s", srcPath.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(inFd, &st) < 0) {
+        R_LOG(ERROR, "Failed to stat %s: %s", srcPath.c_str(), strerror(errno));
+        ::close(inFd);
+        return false;
+    }
+
+    const std::string tmpPath = dstPath + ".tmp";
+    int outFd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (outFd < 0) {
+        R_LOG(ERROR, "Failed to open %s: %s", tmpPath.c_str(), strerror(errno));
+        ::close(inFd);
+        return false;
+    }
+
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    // fdatasync before rename, otherwise a power loss can leave an empty file under the final name
+    bool ok = copyData(inFd, outFd, size) && fdatasync(outFd) == 0;
+    ::close(inFd);
+    ok = ::close(outFd) == 0 && ok;
+    if (!ok || ::rename(tmpPath.c_str(), dstPath.c_str()) < 0) {
+        R_LOG(ERROR, "Failed to copy %s to %s: %s", srcPath.c_str(), dstPath.c_str(), strerror(errno));
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    ::unlink(srcPath.c_str());
+
+    bytesCopied = size;
+    R_LOG(INFO, "Copied %s to %s across filesystems (%llu bytes)", srcPath.c_str(), dstPath.c_str(),
+          static_cast<unsigned long long>(size));
+    return true;
+}
+
+bool FileMover::copyData(int inFd, int outFd, uint64_t size) {
+    off_t offset = 0;
+    bool useCopyRange = true;
+    while (static_cast<uint64_t>(offset) < size) {
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - offset, 1u << 30));
+        ssize_t n;
+        if (useCopyRange) {
+            off_t outOffset = offset;
+            n = copy_file_range(inFd, &offset, outFd, &outOffset, chunk, 0);
+            if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+                // Older kernels and some filesystem pairs refuse, sendfile works everywhere.
+                // It writes at the file position, which copy_file_range left untouched
+                useCopyRange = false;
+                if (lseek(outFd, offset, SEEK_SET) < 0) {
+                    return false;
+                }
+                continue;
+            }
+        } else {
+            n = sendfile(outFd, inFd, &offset, chunk);
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            errno = EIO;    // source shrank under us
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifdef HAVE_FLAC
+
+#include "FlacWriter.hpp"
+#include "RLogger.hpp"
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+
+FlacWriter::FlacWriter(unsigned int compressionLevel) : compressionLevel_(compressionLevel) {}
+
+FlacWriter::~FlacWriter() {
+    close();
+}
+
+bool FlacWriter::open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) {
+    if (isOpen()) {
+        R_LOG(WARN, "FlacWriter already open (%s), closing it first", filePath_.c_str());
+        close();
+    }
+
+    encoder_ = FLAC__stream_encoder_new();
+    if (!encoder_) {
+        R_LOG(ERROR, "FLAC__stream_encoder_new failed");
+        return false;
+    }
+    filePath_ = filePath;
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    framesWritten_ = 0;
+    bytesWritten_ = 0;
+
+    bool ok = FLAC__stream_encoder_set_channels(encoder_, channels) &&
+              FLAC__stream_encoder_set_bits_per_sample(encoder_, 16) &&
+              FLAC__stream_encoder_set_sample_rate(encoder_, sampleRate) &&
+              FLAC__stream_encoder_set_compression_level(encoder_, compressionLevel_) &&
+              FLAC__stream_encoder_set_verify(encoder_, false);
+    if (!ok) {
+        R_LOG(ERROR, "Failed to configure FLAC encoder for %s", filePath.c_str());
+        destroyEncoder();
+        return false;
+    }
+
+    // STREAMINFO (total samples, MD5) is rewritten by FLAC__stream_encoder_finish()
+    FLAC__StreamEncoderInitStatus status = FLAC__stream_encoder_init_file(encoder_, filePath.c_str(), nullptr, nullptr);
+    if (status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+        R_LOG(ERROR, "Failed to open FLAC output %s: %s", filePath.c_str(), FLAC__StreamEncoderInitStatusString[status]);
+        destroyEncoder();
+        ::unlink(filePath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool FlacWriter::write(const int16_t *samples, size_t sampleCount) {
+    if (!isOpen()) return false;
+    if (sampleCount == 0) return true;
+
+    scratch_.resize(sampleCount);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        scratch_[i] = samples[i];
+    }
+    const size_t frames = sampleCount / channels_;
+    if (!FLAC__stream_encoder_process_interleaved(encoder_, scratch_.data(), static_cast<uint32_t>(frames))) {
+        R_LOG(ERROR, "FLAC encode failed on %s: %s", filePath_.c_str(),
+              FLAC__stream_encoder_get_resolved_state_string(encoder_));
+        return false;
+    }
+    framesWritten_ += frames;
+    return true;
+}
+
+bool FlacWriter::close() {
+    if (!isOpen()) return false;
+
+    bool ret = FLAC__stream_encoder_finish(encoder_);
+    if (!ret) {
+        R_LOG(ERROR, "Failed to finish FLAC stream %s: %s", filePath_.c_str(),
+              FLAC__stream_encoder_get_resolved_state_string(encoder_));
+    }
+    destroyEncoder();
+
+    struct stat st;
+    if (::stat(filePath_.c_str(), &st) == 0) {
+        bytesWritten_ = static_cast<uint64_t>(st.st_size);
+    }
+    if (ret) {
+        R_LOG(INFO, "Saved FLAC: %s (frames=%llu, bytes=%llu, %u bps)", filePath_.c_str(),
+              static_cast<unsigned long long>(framesWritten_), static_cast<unsigned long long>(bytesWritten_), getBitrate());
+    }
+    return ret;
+}
+
+void FlacWriter::abort() {
+    if (isOpen()) {
+        FLAC__stream_encoder_finish(encoder_);
+        destroyEncoder();
+    }
+    if (!filePath_.empty() && ::unlink(filePath_.c_str()) < 0 && errno != ENOENT) {
+        R_LOG(WARN, "Failed to remove %s: %s", filePath_.c_str(), strerror(errno));
+    }
+}
+
+unsigned int FlacWriter::getBitrate() const {
+    if (framesWritten_ == 0) return 0;
+    return static_cast<unsigned int>(bytesWritten_ * 8 * sampleRate_ / framesWritten_);
+}
+
+void FlacWriter::destroyEncoder() {
+    FLAC__stream_encoder_delete(encoder_);
+    encoder_ = nullptr;
+}
+
+#endif // HAVE_FLAC
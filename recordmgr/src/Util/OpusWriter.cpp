@@ -0,0 +1,94 @@
+#ifdef HAVE_OPUS
+
+#include "OpusWriter.hpp"
+#include "RLogger.hpp"
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+
+OpusWriter::OpusWriter(unsigned int bitrate) : bitrate_(bitrate) {}
+
+OpusWriter::~OpusWriter() {
+    close();
+}
+
+bool OpusWriter::open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) {
+    if (isOpen()) {
+        R_LOG(WARN, "OpusWriter already open (%s), closing it first", filePath_.c_str());
+        close();
+    }
+
+    OggOpusComments *comments = ope_comments_create();
+    if (!comments) {
+        R_LOG(ERROR, "ope_comments_create failed");
+        return false;
+    }
+    ope_comments_add(comments, "ENCODER", "recordmanager");
+
+    int err = OPE_OK;
+    encoder_ = ope_encoder_create_file(filePath.c_str(), comments, static_cast<opus_int32>(sampleRate),
+                                       static_cast<int>(channels), 0, &err);
+    ope_comments_destroy(comments);
+    if (!encoder_) {
+        R_LOG(ERROR, "Failed to open Opus output %s: %s", filePath.c_str(), ope_strerror(err));
+        return false;
+    }
+    filePath_ = filePath;
+    channels_ = channels;
+    framesWritten_ = 0;
+    bytesWritten_ = 0;
+
+    if (ope_encoder_ctl(encoder_, OPUS_SET_BITRATE(static_cast<opus_int32>(bitrate_))) != OPE_OK ||
+        ope_encoder_ctl(encoder_, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE)) != OPE_OK) {
+        R_LOG(WARN, "Failed to set Opus bitrate/signal on %s, using encoder defaults", filePath.c_str());
+    }
+    return true;
+}
+
+bool OpusWriter::write(const int16_t *samples, size_t sampleCount) {
+    if (!isOpen()) return false;
+    if (sampleCount == 0) return true;
+
+    const size_t frames = sampleCount / channels_;
+    int err = ope_encoder_write(encoder_, samples, static_cast<int>(frames));
+    if (err != OPE_OK) {
+        R_LOG(ERROR, "Opus encode failed on %s: %s", filePath_.c_str(), ope_strerror(err));
+        return false;
+    }
+    framesWritten_ += frames;
+    return true;
+}
+
+bool OpusWriter::close() {
+    if (!isOpen()) return false;
+
+    // Drain flushes the encoder delay and writes the last Ogg page
+    int err = ope_encoder_drain(encoder_);
+    ope_encoder_destroy(encoder_);
+    encoder_ = nullptr;
+    if (err != OPE_OK) {
+        R_LOG(ERROR, "Failed to finish Opus stream %s: %s", filePath_.c_str(), ope_strerror(err));
+        return false;
+    }
+
+    struct stat st;
+    if (::stat(filePath_.c_str(), &st) == 0) {
+        bytesWritten_ = static_cast<uint64_t>(st.st_size);
+    }
+    R_LOG(INFO, "Saved Opus: %s (frames=%llu, bytes=%llu, %u bps)", filePath_.c_str(),
+          static_cast<unsigned long long>(framesWritten_), static_cast<unsigned long long>(bytesWritten_), bitrate_);
+    return true;
+}
+
+void OpusWriter::abort() {
+    if (isOpen()) {
+        ope_encoder_destroy(encoder_);
+        encoder_ = nullptr;
+    }
+    if (!filePath_.empty() && ::unlink(filePath_.c_str()) < 0 && errno != ENOENT) {
+        R_LOG(WARN, "Failed to remove %s: %s", filePath_.c_str(), strerror(errno));
+    }
+}
+
+#endif // HAVE_OPUS
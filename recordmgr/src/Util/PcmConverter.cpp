@@ -0,0 +1,114 @@
+#include "PcmConverter.hpp"
+#include "DspKernels.hpp"
+#include <algorithm>
+#include <cstring>
+
+PcmConverter::PcmConverter(unsigned int outRate, unsigned int outChannels)
+    : outRate_(outRate), outChannels_(std::max(outChannels, 1u)), format_(SND_PCM_FORMAT_S16_LE),
+      deviceRate_(outRate), deviceChannels_(outChannels_), frameBytes_(sampleBytes(format_) * outChannels_), passthrough_(true),
+      blockFrames_(1) {
+}
+
+void PcmConverter::configure(snd_pcm_format_t format, unsigned int deviceRate, unsigned int deviceChannels, size_t blockFrames) {
+    format_ = format;
+    deviceRate_ = deviceRate;
+    deviceChannels_ = std::max(deviceChannels, 1u);
+    frameBytes_ = sampleBytes(format_) * deviceChannels_;
+    passthrough_ = format_ == SND_PCM_FORMAT_S16_LE && deviceRate_ == outRate_ && deviceChannels_ == outChannels_;
+    resampler_.reset(deviceRate_, outRate_, outChannels_);
+
+    blockFrames_ = std::max<size_t>(blockFrames, 1);
+    resampler_.reserve(blockFrames_);
+    converted_.reserve(blockFrames_ * outChannels_);
+    // The resampler gives at most one frame more than the rate ratio per call
+    const size_t outSamples = (blockFrames_ * outRate_ / std::max(deviceRate_, 1u) + 2) * outChannels_;
+    resampled_.reserve(outSamples);
+    output_.reserve(std::max(outSamples, converted_.capacity()));
+}
+
+void PcmConverter::reset() {
+    resampler_.reset(deviceRate_, outRate_, outChannels_);
+}
+
+void PcmConverter::toFloat(const uint8_t* data, size_t frames) {
+    converted_.resize(frames * outChannels_);
+    float frame[32];
+    const unsigned int devChannels = std::min(deviceChannels_, 32u);
+    const size_t bytesPerSample = sampleBytes(format_);
+
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t* p = data + i * frameBytes_;
+        for (unsigned int c = 0; c < devChannels; ++c, p += bytesPerSample) {
+            switch (format_) {
+                case SND_PCM_FORMAT_S16_LE: {
+                    int16_t v;
+                    memcpy(&v, p, sizeof(v));
+                    frame[c] = v * (1.0f / 32768.0f);
+                    break;
+                }
+                case SND_PCM_FORMAT_S24_LE: {
+                    int32_t v;
+                    memcpy(&v, p, sizeof(v));
+                    v = static_cast<int32_t>(static_cast<uint32_t>(v) << 8) >> 8;    // sign-extend bit 23
+                    frame[c] = v * (1.0f / 8388608.0f);
+                    break;
+                }
+                case SND_PCM_FORMAT_S32_LE: {
+                    int32_t v;
+                    memcpy(&v, p, sizeof(v));
+                    frame[c] = static_cast<float>(v * (1.0 / 2147483648.0));
+                    break;
+                }
+                default:
+                    memcpy(&frame[c], p, sizeof(float));
+                    break;
+            }
+        }
+
+        float* out = converted_.data() + i * outChannels_;
+        if (outChannels_ == devChannels) {
+            std::copy(frame, frame + devChannels, out);
+        } else if (outChannels_ == 1) {
+            // Downmix to mono
+            float sum = 0.0f;
+            for (unsigned int c = 0; c < devChannels; ++c) sum += frame[c];
+            out[0] = sum / devChannels;
+        } else {
+            // Drop extra channels, or repeat the last one (mono card, stereo file)
+            for (unsigned int c = 0; c < outChannels_; ++c) out[c] = frame[std::min(c, devChannels - 1)];
+        }
+    }
+}
+
+size_t PcmConverter::deliver(PcmSink& sink, const uint8_t* data, size_t frames) {
+    if (passthrough_) {
+        sink.onPcm(reinterpret_cast<const int16_t*>(data), frames);
+        return frames;
+    }
+
+    size_t outFrames = 0;
+    while (frames > 0) {
+        const size_t block = std::min(frames, blockFrames_);
+        outFrames += deliverBlock(sink, data, block);
+        data += block * frameBytes_;
+        frames -= block;
+    }
+    return outFrames;
+}
+
+size_t PcmConverter::deliverBlock(PcmSink& sink, const uint8_t* data, size_t frames) {
+    toFloat(data, frames);
+    const std::vector<float>* samples = &converted_;
+    if (!resampler_.isPassthrough()) {
+        resampled_.clear();
+        resampler_.process(converted_.data(), frames, resampled_);
+        samples = &resampled_;
+    }
+    output_.resize(samples->size());
+    DspKernels::floatToInt16(samples->data(), output_.data(), samples->size());
+    const size_t outFrames = output_.size() / outChannels_;
+    if (outFrames > 0) {
+        sink.onPcm(output_.data(), outFrames);
+    }
+    return outFrames;
+}
@@ -0,0 +1,108 @@
+#include "PcmRingBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+}
+
+PcmRingBuffer::PcmRingBuffer(size_t minCapacity)
+    : capacity_(roundUpPow2(std::max<size_t>(minCapacity, 2))), mask_(capacity_ - 1) {
+    buffer_.resize(capacity_);
+}
+
+size_t PcmRingBuffer::write(const int16_t *samples, size_t count, size_t frameSamples) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    const size_t space = capacity_ - (head - tail);
+
+    size_t n = count;
+    if (n > space) {
+        n = space / frameSamples * frameSamples;
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedSamples_.fetch_add(count - n, std::memory_order_relaxed);
+    }
+    if (n == 0) return 0;
+
+    const size_t pos = head & mask_;
+    const size_t firstPart = std::min(n, capacity_ - pos);
+    memcpy(buffer_.data() + pos, samples, firstPart * sizeof(int16_t));
+    if (n > firstPart) {
+        memcpy(buffer_.data(), samples + firstPart, (n - firstPart) * sizeof(int16_t));
+    }
+    head_.store(head + n, std::memory_order_release);
+
+    const size_t fill = head + n - tail;
+    if (fill > highWater_.load(std::memory_order_relaxed)) {
+        highWater_.store(fill, std::memory_order_relaxed);
+    }
+    samplesWritten_.fetch_add(n, std::memory_order_relaxed);
+    return n;
+}
+
+size_t PcmRingBuffer::read(int16_t *out, size_t count) {
+    const int16_t *first = nullptr;
+    const int16_t *second = nullptr;
+    size_t firstCount = 0;
+    size_t secondCount = 0;
+    const size_t available = peek(first, firstCount, second, secondCount);
+
+    const size_t n = std::min(count, available);
+    if (n < count) {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+    const size_t a = std::min(n, firstCount);
+    if (a) memcpy(out, first, a * sizeof(int16_t));
+    if (n > a) memcpy(out + a, second, (n - a) * sizeof(int16_t));
+    consume(n);
+    return n;
+}
+
+size_t PcmRingBuffer::peek(const int16_t *&first, size_t &firstCount, const int16_t *&second, size_t &secondCount) const {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t available = head - tail;
+
+    const size_t pos = tail & mask_;
+    first = buffer_.data() + pos;
+    firstCount = std::min(available, capacity_ - pos);
+    second = buffer_.data();
+    secondCount = available - firstCount;
+    return available;
+}
+
+void PcmRingBuffer::consume(size_t count) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    tail_.store(tail + std::min(count, head - tail), std::memory_order_release);
+}
+
+size_t PcmRingBuffer::readAvailable() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+}
+
+void PcmRingBuffer::reset() {
+    head_.store(0);
+    tail_.store(0);
+    highWater_.store(0);
+    overruns_.store(0);
+    droppedSamples_.store(0);
+    underruns_.store(0);
+    samplesWritten_.store(0);
+}
+
+PcmRingStats PcmRingBuffer::getStats() const {
+    PcmRingStats stats;
+    stats.capacity = capacity_;
+    stats.highWater = highWater_.load(std::memory_order_relaxed);
+    stats.overruns = overruns_.load(std::memory_order_relaxed);
+    stats.droppedSamples = droppedSamples_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.samplesWritten = samplesWritten_.load(std::memory_order_relaxed);
+    stats.fill = readAvailable();
+    return stats;
+}
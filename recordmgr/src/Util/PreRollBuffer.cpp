@@ -0,0 +1,52 @@
+#include "PreRollBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+PreRollBuffer::PreRollBuffer(size_t capacityFrames, unsigned int channels)
+    : channels_(std::max(channels, 1u)) {
+    buffer_.resize(std::max<size_t>(capacityFrames, 1) * channels_);
+}
+
+void PreRollBuffer::onPcm(const int16_t *samples, size_t frames) {
+    const size_t capacity = buffer_.size();
+    size_t count = frames * channels_;
+
+    // Block longer than the buffer: only its tail survives
+    if (count >= capacity) {
+        memcpy(buffer_.data(), samples + (count - capacity), capacity * sizeof(int16_t));
+        start_ = 0;
+        fill_ = capacity;
+        return;
+    }
+
+    size_t pos = (start_ + fill_) % capacity;
+    const size_t first = std::min(count, capacity - pos);
+    memcpy(buffer_.data() + pos, samples, first * sizeof(int16_t));
+    memcpy(buffer_.data(), samples + first, (count - first) * sizeof(int16_t));
+
+    if (fill_ + count > capacity) {
+        start_ = (start_ + fill_ + count - capacity) % capacity;
+        fill_ = capacity;
+    } else {
+        fill_ += count;
+    }
+}
+
+size_t PreRollBuffer::drainTo(PcmSink &sink) {
+    const size_t capacity = buffer_.size();
+    const size_t frames = fill_ / channels_;
+    const size_t first = std::min(fill_, capacity - start_);
+    if (first > 0) {
+        sink.onPcm(buffer_.data() + start_, first / channels_);
+    }
+    if (fill_ > first) {
+        sink.onPcm(buffer_.data(), (fill_ - first) / channels_);
+    }
+    clear();
+    return frames;
+}
+
+void PreRollBuffer::clear() {
+    start_ = 0;
+    fill_ = 0;
+}
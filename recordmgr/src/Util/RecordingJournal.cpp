@@ -0,0 +1,146 @@
+#include "RecordingJournal.hpp"
+#include "WavWriter.hpp"
+#include "RLogger.hpp"
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const std::string PART_SUFFIX = ".part";
+
+    bool codecFromName(const std::string &name, AudioCodec &codec) {
+        for (AudioCodec c : {AudioCodec::WAV, AudioCodec::FLAC, AudioCodec::OPUS}) {
+            if (name == AudioSink::codecName(c)) {
+                codec = c;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool RecordingJournal::write(const std::string &filePath, const Entry &entry) {
+    char text[256];
+    const int len = snprintf(text, sizeof(text), "codec=%s\nsample_rate=%u\nchannels=%u\nfiltered=%d\nframes=%llu\nsession=%.64s\n",
+                             AudioSink::codecName(entry.codec), entry.sampleRate, entry.channels, entry.filtered ? 1 : 0,
+                             static_cast<unsigned long long>(entry.frames), entry.sessionId.c_str());
+
+    const std::string path = journalPath(filePath);
+    const std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        R_LOG(ERROR, "Failed to open journal %s: %s", tmpPath.c_str(), strerror(errno));
+        return false;
+    }
+    // fdatasync before rename, otherwise a power loss can leave an empty journal behind
+    const bool ok = ::write(fd, text, static_cast<size_t>(len)) == len && fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) < 0) {
+        R_LOG(ERROR, "Failed to write journal %s: %s", path.c_str(), strerror(errno));
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RecordingJournal::read(const std::string &filePath, Entry &entry) {
+    std::ifstream file(journalPath(filePath));
+    if (!file) return false;
+
+    entry = Entry();
+    bool hasCodec = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        const std::string key = line.substr(0, eq);
+        const std::string value = line.substr(eq + 1);
+        try {
+            if (key == "codec") hasCodec = codecFromName(value, entry.codec);
+            else if (key == "sample_rate") entry.sampleRate = static_cast<unsigned int>(std::stoul(value));
+            else if (key == "channels") entry.channels = static_cast<unsigned int>(std::stoul(value));
+            else if (key == "filtered") entry.filtered = (value == "1");
+            else if (key == "frames") entry.frames = std::stoull(value);
+            else if (key == "session") entry.sessionId = value;
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+    return hasCodec && entry.sampleRate > 0 && entry.channels > 0;
+}
+
+void RecordingJournal::remove(const std::string &filePath) {
+    std::error_code ec;
+    fs::remove(journalPath(filePath), ec);
+}
+
+bool RecordingJournal::commit(const std::string &filePath) {
+    if (::rename(partPath(filePath).c_str(), filePath.c_str()) < 0) {
+        R_LOG(ERROR, "Failed to rename %s: %s", partPath(filePath).c_str(), strerror(errno));
+        return false;
+    }
+    remove(filePath);
+    return true;
+}
+
+std::vector<RecordingJournal::Recovered> RecordingJournal::recoverAll(const std::string &dir) {
+    std::vector<Recovered> recovered;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    std::vector<std::string> parts;
+    for (const auto &dirEntry : fs::directory_iterator(dir, ec)) {
+        const std::string path = dirEntry.path().string();
+        if (path.size() > PART_SUFFIX.size() && path.compare(path.size() - PART_SUFFIX.size(), PART_SUFFIX.size(), PART_SUFFIX) == 0) {
+            parts.push_back(path.substr(0, path.size() - PART_SUFFIX.size()));
+        }
+    }
+
+    for (const std::string &filePath : parts) {
+        Entry entry;
+        const bool hasJournal = read(filePath, entry);
+        if (!hasJournal) {
+            // Crash before the first journal write, nothing worth keeping
+            R_LOG(WARN, "No journal for %s, discarding it", partPath(filePath).c_str());
+        }
+
+        uint64_t frames = entry.frames;
+        if (hasJournal && entry.codec == AudioCodec::WAV) {
+            // The data on disk may be ahead of the last sync, trust the file size
+            WavWriter wav;
+            frames = wav.recover(partPath(filePath)) ? wav.getFramesWritten() : 0;
+        }
+        // FLAC and Ogg Opus streams decode up to their last complete frame/page
+        // without a proper trailer; the journal has the length up to the last sync
+
+        if (!hasJournal || frames == 0) {
+            fs::remove(partPath(filePath), ec);
+            remove(filePath);
+            continue;
+        }
+        if (!commit(filePath)) {
+            continue;
+        }
+
+        Recovered item;
+        item.info.filePath = filePath;
+        item.info.codec = entry.codec;
+        item.info.frames = frames;
+        item.info.bytes = fs::file_size(filePath, ec);
+        const double seconds = static_cast<double>(frames) / entry.sampleRate;
+        item.info.bitrate = entry.codec == AudioCodec::WAV ? entry.sampleRate * entry.channels * 16
+                                                            : static_cast<unsigned int>(item.info.bytes * 8 / seconds);
+        item.sampleRate = entry.sampleRate;
+        item.filtered = entry.filtered;
+        item.sessionId = entry.sessionId;
+        R_LOG(WARN, "Recovered interrupted recording %s (%s, %.1f s)", filePath.c_str(), AudioSink::codecName(entry.codec), seconds);
+        recovered.push_back(item);
+    }
+    return recovered;
+}
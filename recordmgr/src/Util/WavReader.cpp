@@ -0,0 +1,67 @@
+#include "WavReader.hpp"
+#include "RLogger.hpp"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+    uint16_t getU16(const uint8_t *p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    uint32_t getU32(const uint8_t *p) { return getU16(p) | (static_cast<uint32_t>(getU16(p + 2)) << 16); }
+}
+
+bool WavReader::open(const std::string &filePath) {
+    in_.open(filePath, std::ios::binary);
+    if (!in_.is_open()) {
+        R_LOG(ERROR, "Failed to open WAV file %s", filePath.c_str());
+        return false;
+    }
+
+    uint8_t riff[12];
+    if (!in_.read(reinterpret_cast<char *>(riff), sizeof(riff)) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        R_LOG(ERROR, "%s is not a RIFF/WAVE file", filePath.c_str());
+        return false;
+    }
+
+    bool hasFormat = false;
+    uint8_t chunk[8];
+    while (in_.read(reinterpret_cast<char *>(chunk), sizeof(chunk))) {
+        const uint32_t chunkSize = getU32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (chunkSize < sizeof(fmt) || !in_.read(reinterpret_cast<char *>(fmt), sizeof(fmt))) break;
+            const uint16_t audioFormat = getU16(fmt);
+            channels_ = getU16(fmt + 2);
+            sampleRate_ = getU32(fmt + 4);
+            const uint16_t bitsPerSample = getU16(fmt + 14);
+            if (audioFormat != 1 || bitsPerSample != 16 || channels_ == 0) {
+                R_LOG(ERROR, "Unsupported WAV format in %s (format=%u, bits=%u, channels=%u)",
+                      filePath.c_str(), audioFormat, bitsPerSample, channels_);
+                return false;
+            }
+            in_.seekg(chunkSize - sizeof(fmt) + (chunkSize & 1), std::ios::cur);
+            hasFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!hasFormat) break;
+            dataBytes_ = chunkSize;
+            remainingBytes_ = chunkSize;
+            return true;
+        } else {
+            in_.seekg(chunkSize + (chunkSize & 1), std::ios::cur);
+        }
+    }
+
+    R_LOG(ERROR, "No fmt/data chunk found in %s", filePath.c_str());
+    return false;
+}
+
+size_t WavReader::read(int16_t *samples, size_t maxSamples) {
+    const size_t bytes = static_cast<size_t>(std::min<uint64_t>(remainingBytes_, maxSamples * sizeof(int16_t)));
+    if (bytes == 0) return 0;
+    if (!in_.read(reinterpret_cast<char *>(samples), bytes)) {
+        // A short read means the file was truncated, hand out what arrived
+        const size_t got = static_cast<size_t>(in_.gcount());
+        remainingBytes_ = 0;
+        return got / sizeof(int16_t);
+    }
+    remainingBytes_ -= bytes;
+    return bytes / sizeof(int16_t);
+}
@@ -0,0 +1,177 @@
+#include "WavWriter.hpp"
+#include "RLogger.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+namespace {
+    void putU16(uint8_t *p, uint16_t v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+    void putU32(uint8_t *p, uint32_t v) { putU16(p, v & 0xFFFF); putU16(p + 2, (v >> 16) & 0xFFFF); }
+}
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::open(const std::string &filePath, unsigned int sampleRate, unsigned int channels) {
+    if (isOpen()) {
+        R_LOG(WARN, "WavWriter already open (%s), closing it first", filePath_.c_str());
+        close();
+    }
+
+    fd_ = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        R_LOG(ERROR, "Failed to open output file %s: %s", filePath.c_str(), strerror(errno));
+        return false;
+    }
+    filePath_ = filePath;
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    dataBytes_ = 0;
+
+    // Placeholder header, sizes are patched on close()
+    if (!writeHeader()) {
+        abort();
+        return false;
+    }
+    if (lseek(fd_, HEADER_SIZE, SEEK_SET) < 0) {
+        R_LOG(ERROR, "lseek failed on %s: %s", filePath_.c_str(), strerror(errno));
+        abort();
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::write(const int16_t *samples, size_t sampleCount) {
+    if (!isOpen()) return false;
+    if (sampleCount == 0) return true;
+
+    const size_t bytes = sampleCount * sizeof(int16_t);
+    if (!writeAll(samples, bytes)) {
+        return false;
+    }
+    dataBytes_ += bytes;
+    return true;
+}
+
+bool WavWriter::close() {
+    if (!isOpen()) return false;
+
+    bool ret = writeHeader();
+    if (::close(fd_) < 0) {
+        R_LOG(ERROR, "close failed on %s: %s", filePath_.c_str(), strerror(errno));
+        ret = false;
+    }
+    fd_ = -1;
+
+    if (ret) {
+        R_LOG(INFO, "Saved WAV: %s (frames=%llu, bytes=%llu)", filePath_.c_str(),
+              static_cast<unsigned long long>(getFramesWritten()), static_cast<unsigned long long>(dataBytes_));
+    }
+    return ret;
+}
+
+void WavWriter::abort() {
+    if (isOpen()) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (!filePath_.empty() && ::unlink(filePath_.c_str()) < 0 && errno != ENOENT) {
+        R_LOG(WARN, "Failed to remove %s: %s", filePath_.c_str(), strerror(errno));
+    }
+}
+
+bool WavWriter::sync() {
+    if (!isOpen()) return false;
+    // Header first, so the synced data is covered by the sizes
+    if (!writeHeader() || fdatasync(fd_) < 0) {
+        R_LOG(ERROR, "Failed to sync %s: %s", filePath_.c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::recover(const std::string &filePath) {
+    if (isOpen()) close();
+
+    fd_ = ::open(filePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) {
+        R_LOG(ERROR, "Failed to open %s: %s", filePath.c_str(), strerror(errno));
+        return false;
+    }
+    filePath_ = filePath;
+
+    uint8_t header[HEADER_SIZE];
+    struct stat st;
+    bool ok = pread(fd_, header, HEADER_SIZE, 0) == static_cast<ssize_t>(HEADER_SIZE) && fstat(fd_, &st) == 0 &&
+              memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0 && memcmp(header + 36, "data", 4) == 0;
+    if (ok) {
+        channels_ = header[22] | (header[23] << 8);
+        sampleRate_ = header[24] | (header[25] << 8) | (header[26] << 16) | (static_cast<uint32_t>(header[27]) << 24);
+        ok = channels_ > 0 && sampleRate_ > 0;
+    }
+    if (!ok) {
+        R_LOG(ERROR, "%s is not a WAV written by recordmanager", filePath.c_str());
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    const uint64_t blockAlign = channels_ * sizeof(int16_t);
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    dataBytes_ = size > HEADER_SIZE ? (size - HEADER_SIZE) / blockAlign * blockAlign : 0;
+    ok = ftruncate(fd_, static_cast<off_t>(HEADER_SIZE + dataBytes_)) == 0 && writeHeader() && fdatasync(fd_) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    return ok;
+}
+
+bool WavWriter::writeHeader() {
+    // RIFF sizes are 32-bit, clamp instead of wrapping for oversized sessions
+    const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(dataBytes_, std::numeric_limits<uint32_t>::max() - 36));
+    const uint16_t blockAlign = static_cast<uint16_t>(channels_ * sizeof(int16_t));
+
+    uint8_t header[HEADER_SIZE];
+    memcpy(header, "RIFF", 4);
+    putU32(header + 4, 36 + dataSize);
+    memcpy(header + 8, "WAVE", 4);
+
+    // fmt subchunk
+    memcpy(header + 12, "fmt ", 4);
+    putU32(header + 16, 16);                // subchunk1 size
+    putU16(header + 20, 1);                 // PCM
+    putU16(header + 22, static_cast<uint16_t>(channels_));
+    putU32(header + 24, sampleRate_);
+    putU32(header + 28, sampleRate_ * blockAlign);
+    putU16(header + 32, blockAlign);
+    putU16(header + 34, 16);                // bits per sample
+
+    // data subchunk
+    memcpy(header + 36, "data", 4);
+    putU32(header + 40, dataSize);
+
+    if (pwrite(fd_, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE)) {
+        R_LOG(ERROR, "Failed to write WAV header to %s: %s", filePath_.c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::writeAll(const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd_, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            R_LOG(ERROR, "write failed on %s: %s", filePath_.c_str(), strerror(errno));
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
@@ -1,7 +1,8 @@
 #include "DBusReceiver.hpp"
 #include "RLogger.hpp"
 #include "MainWorker.hpp"
-#include "RecordWorker.hpp"
+#include "RecordSessionManager.hpp"
+#include "FilterWorkerPool.hpp"
 #include "EventQueue.hpp"
 #include <csignal>
 #include <atomic>
@@ -31,11 +32,13 @@ int main(){
 
     std::shared_ptr<EventQueue> eventQueue = std::make_shared<EventQueue>();
 
-    auto recordWorker = std::make_shared<RecordWorker>(eventQueue);
-    auto mainWorker = std::make_shared<MainWorker>(eventQueue, recordWorker);
+    auto recordSessions = std::make_shared<RecordSessionManager>(eventQueue);
+    auto filterWorkerPool = std::make_shared<FilterWorkerPool>();
+    auto mainWorker = std::make_shared<MainWorker>(eventQueue, recordSessions, filterWorkerPool);
     auto dbusReceiver = std::make_shared<DBusReceiver>(eventQueue);
 
-    recordWorker->run();
+    recordSessions->run();
+    filterWorkerPool->run();
     mainWorker->run();
     dbusReceiver->run();
 
@@ -53,13 +56,16 @@ int main(){
     }
 
     R_LOG(WARN, "Shutdown signal received, stopping threads...");
-    mainWorker->stop();
+    // Front to back, so a take finished by the shutdown still reaches the filter pool and
+    // gets stored: no new commands, finish the recordings, hand them over, store them
     dbusReceiver->stop();
-    recordWorker->stop();
-
-    mainWorker->join();
     dbusReceiver->join();
-    recordWorker->join();
+    recordSessions->stop();
+    recordSessions->join();
+    mainWorker->stop();
+    mainWorker->join();
+    filterWorkerPool->stop();
+    filterWorkerPool->join();
     R_LOG(WARN, "Record Manager exited.");
 
     return 0;